@@ -0,0 +1,189 @@
+#include "AssetBundle.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+uint64_t hashAssetBytes(const void *data, size_t size)
+{
+    // FNV-1a.
+    auto bytes = reinterpret_cast<const uint8_t*> (data);
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static int compareAssetKeys(uint32_t leftKind, const char *leftName, size_t leftNameLength, uint32_t rightKind, const char *rightName, size_t rightNameLength)
+{
+    if(leftKind != rightKind)
+        return leftKind < rightKind ? -1 : 1;
+
+    auto result = memcmp(leftName, rightName, std::min(leftNameLength, rightNameLength));
+    if(result != 0)
+        return result;
+    if(leftNameLength != rightNameLength)
+        return leftNameLength < rightNameLength ? -1 : 1;
+    return 0;
+}
+
+bool AssetBundle::open(const std::string &fileName)
+{
+    close();
+    if(!file.open(fileName))
+        return false;
+
+    AssetBundleHeader header;
+    bool isValid = file.size() >= sizeof(header);
+    if(isValid)
+    {
+        memcpy(&header, file.data(), sizeof(header));
+        isValid = header.magic == AssetBundleHeader::Magic && header.version == AssetBundleHeader::CurrentVersion &&
+            header.indexOffset % alignof(AssetBundleEntry) == 0 &&
+            header.indexOffset + uint64_t(header.entryCount)*sizeof(AssetBundleEntry) <= file.size() &&
+            header.namesOffset + header.namesSize <= file.size();
+    }
+
+    if(isValid)
+    {
+        entries = reinterpret_cast<const AssetBundleEntry*> (file.data() + header.indexOffset);
+        names = file.chars() + header.namesOffset;
+        entryCount = header.entryCount;
+        for(size_t i = 0; i < entryCount && isValid; ++i)
+        {
+            auto &entry = entries[i];
+            isValid = uint64_t(entry.nameOffset) + entry.nameLength <= header.namesSize &&
+                entry.offset + entry.size <= file.size() && entry.offset + entry.size >= entry.offset;
+        }
+    }
+
+    if(!isValid)
+    {
+        fprintf(stderr, "Invalid asset bundle %s.\n", fileName.c_str());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void AssetBundle::close()
+{
+    file.close();
+    entries = nullptr;
+    names = nullptr;
+    entryCount = 0;
+}
+
+bool AssetBundle::findAsset(const std::string &name, AssetKind kind, const uint8_t *&data, size_t &size) const
+{
+    size_t begin = 0;
+    size_t end = entryCount;
+    while(begin < end)
+    {
+        auto middle = begin + (end - begin) / 2;
+        auto &entry = entries[middle];
+        auto comparison = compareAssetKeys(entry.kind, names + entry.nameOffset, entry.nameLength, uint32_t(kind), name.data(), name.size());
+        if(comparison < 0)
+        {
+            begin = middle + 1;
+        }
+        else if(comparison > 0)
+        {
+            end = middle;
+        }
+        else
+        {
+            // A bundle on a network share may have been truncated or replaced while it was copied.
+            auto entryData = file.data() + entry.offset;
+            if(hashAssetBytes(entryData, size_t(entry.size)) != entry.hash)
+            {
+                fprintf(stderr, "The asset %s of the bundle is corrupted.\n", name.c_str());
+                return false;
+            }
+
+            data = entryData;
+            size = size_t(entry.size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void AssetBundleWriter::addAsset(const std::string &name, AssetKind kind, const void *data, size_t size)
+{
+    auto bytes = reinterpret_cast<const uint8_t*> (data);
+    assets.push_back(Asset{name, kind, std::vector<uint8_t> (bytes, bytes + size)});
+}
+
+bool AssetBundleWriter::write(const std::string &fileName)
+{
+    std::sort(assets.begin(), assets.end(), [](const Asset &left, const Asset &right) {
+        return compareAssetKeys(uint32_t(left.kind), left.name.data(), left.name.size(), uint32_t(right.kind), right.name.data(), right.name.size()) < 0;
+    });
+
+    auto alignBlob = [](uint64_t offset) {
+        return (offset + AssetBundleHeader::BlobAlignment - 1) & ~uint64_t(AssetBundleHeader::BlobAlignment - 1);
+    };
+
+    AssetBundleHeader header = {};
+    header.magic = AssetBundleHeader::Magic;
+    header.version = AssetBundleHeader::CurrentVersion;
+    header.entryCount = uint32_t(assets.size());
+    header.indexOffset = sizeof(header);
+    header.namesOffset = header.indexOffset + assets.size()*sizeof(AssetBundleEntry);
+
+    std::vector<AssetBundleEntry> entries(assets.size());
+    std::string allNames;
+    for(size_t i = 0; i < assets.size(); ++i)
+    {
+        entries[i].nameOffset = uint32_t(allNames.size());
+        entries[i].nameLength = uint32_t(assets[i].name.size());
+        allNames += assets[i].name;
+    }
+    header.namesSize = uint32_t(allNames.size());
+
+    auto blobOffset = alignBlob(header.namesOffset + header.namesSize);
+    for(size_t i = 0; i < assets.size(); ++i)
+    {
+        auto &asset = assets[i];
+        auto &entry = entries[i];
+        entry.offset = blobOffset;
+        entry.size = asset.data.size();
+        entry.hash = hashAssetBytes(asset.data.data(), asset.data.size());
+        entry.kind = uint32_t(asset.kind);
+        blobOffset = alignBlob(blobOffset + entry.size);
+    }
+
+    FILE *output = fopen(fileName.c_str(), "wb");
+    if(!output)
+    {
+        fprintf(stderr, "Failed to open file %s for writing.\n", fileName.c_str());
+        return false;
+    }
+
+    uint8_t padding[AssetBundleHeader::BlobAlignment] = {};
+    uint64_t writtenSize = 0;
+    auto writeBytes = [&](const void *data, size_t size) {
+        writtenSize += size;
+        return size == 0 || fwrite(data, size, 1, output) == 1;
+    };
+    auto writePadding = [&]() {
+        return writeBytes(padding, size_t(alignBlob(writtenSize) - writtenSize));
+    };
+
+    bool succeeded = writeBytes(&header, sizeof(header)) &&
+        writeBytes(entries.data(), entries.size()*sizeof(AssetBundleEntry)) &&
+        writeBytes(allNames.data(), allNames.size());
+    for(auto &asset : assets)
+        succeeded = succeeded && writePadding() && writeBytes(asset.data.data(), asset.data.size());
+    if(fclose(output) != 0)
+        succeeded = false;
+
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the asset bundle %s.\n", fileName.c_str());
+    return succeeded;
+}
@@ -0,0 +1,115 @@
+#ifndef SHADER_VIS_ASSET_BUNDLE_HPP
+#define SHADER_VIS_ASSET_BUNDLE_HPP
+
+#include "MappedFile.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum class AssetKind : uint32_t
+{
+    // The bytes of the original file, e.g. a shader source.
+    File = 0,
+
+    // A texture in the raw texture format, named after its source image.
+    RawTexture = 1,
+
+    // A device shader, named after the hexadecimal shader binary cache key of its source.
+    ShaderBinary = 2,
+};
+
+/**
+ * Header of an asset bundle file. The index follows the header, then the
+ * names, and then the blobs, each one aligned to BlobAlignment.
+ */
+struct AssetBundleHeader
+{
+    static constexpr uint32_t Magic = 0x42415653; // "SVAB"
+    static constexpr uint32_t CurrentVersion = 1;
+    static constexpr uint32_t BlobAlignment = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t namesSize;
+    uint64_t indexOffset;
+    uint64_t namesOffset;
+};
+
+/**
+ * An entry of the index of an asset bundle. The index is sorted by kind and
+ * name, so that an asset is found with a binary search.
+ */
+struct AssetBundleEntry
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t kind;
+    uint32_t reserved;
+};
+
+/**
+ * Read-only access to the assets of a bundle, which is mapped as a whole
+ * when it is opened, so that startup does not pay the latency of opening
+ * every asset file separately. The views that are returned point into the
+ * mapping, and they stay valid while the bundle is open.
+ */
+class AssetBundle
+{
+public:
+    bool open(const std::string &fileName);
+    void close();
+
+    bool isOpen() const
+    {
+        return file.isOpen();
+    }
+
+    size_t getAssetCount() const
+    {
+        return entryCount;
+    }
+
+    // Returns false when the bundle does not hold the asset, or when its bytes do not match its hash.
+    bool findAsset(const std::string &name, AssetKind kind, const uint8_t *&data, size_t &size) const;
+
+private:
+    MappedFile file;
+    const AssetBundleEntry *entries = nullptr;
+    const char *names = nullptr;
+    size_t entryCount = 0;
+};
+
+/**
+ * Builds an asset bundle in memory, and writes it with its index.
+ */
+class AssetBundleWriter
+{
+public:
+    void addAsset(const std::string &name, AssetKind kind, const void *data, size_t size);
+
+    size_t getAssetCount() const
+    {
+        return assets.size();
+    }
+
+    bool write(const std::string &fileName);
+
+private:
+    struct Asset
+    {
+        std::string name;
+        AssetKind kind;
+        std::vector<uint8_t> data;
+    };
+
+    std::vector<Asset> assets;
+};
+
+uint64_t hashAssetBytes(const void *data, size_t size);
+
+#endif //SHADER_VIS_ASSET_BUNDLE_HPP
@@ -0,0 +1,120 @@
+#include "BenchmarkReport.hpp"
+#include <stdio.h>
+#include <algorithm>
+
+BenchmarkReport::BenchmarkReport(const std::string &newSuiteName)
+    : suiteName(newSuiteName)
+{
+}
+
+void BenchmarkReport::setContext(const std::string &key, const std::string &value)
+{
+    for(auto &entry : context)
+    {
+        if(entry.first == key)
+        {
+            entry.second = value;
+            return;
+        }
+    }
+
+    context.push_back(std::make_pair(key, value));
+}
+
+static double percentile(const std::vector<double> &sortedSamples, double fraction)
+{
+    // Nearest rank.
+    auto rank = size_t(fraction * sortedSamples.size() + 0.999999);
+    rank = std::min(std::max(rank, size_t(1)), sortedSamples.size());
+    return sortedSamples[rank - 1];
+}
+
+void BenchmarkReport::addSamples(const std::string &name, std::vector<double> nanoseconds, double itemsPerIteration)
+{
+    if(nanoseconds.empty())
+        return;
+
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = nanoseconds.size();
+    result.itemsPerIteration = itemsPerIteration;
+    result.minimum = nanoseconds.front();
+    result.maximum = nanoseconds.back();
+    result.p50 = percentile(nanoseconds, 0.50);
+    result.p90 = percentile(nanoseconds, 0.90);
+    result.p99 = percentile(nanoseconds, 0.99);
+
+    double sum = 0;
+    for(auto sample : nanoseconds)
+        sum += sample;
+    result.mean = sum / nanoseconds.size();
+    results.push_back(result);
+}
+
+void BenchmarkReport::printTable() const
+{
+    printf("%-40s %8s %12s %12s %12s %12s %14s\n", "Benchmark", "Iters", "Min (us)", "P50 (us)", "P90 (us)", "P99 (us)", "Items/s (P50)");
+    for(auto &result : results)
+    {
+        printf("%-40s %8zu %12.2f %12.2f %12.2f %12.2f %14.4g\n",
+            result.name.c_str(), result.iterations,
+            result.minimum / 1000.0, result.p50 / 1000.0, result.p90 / 1000.0, result.p99 / 1000.0,
+            result.itemsPerIteration * 1e9 / result.p50);
+    }
+}
+
+static void writeJSONString(FILE *file, const std::string &string)
+{
+    fputc('"', file);
+    for(auto c : string)
+    {
+        if(c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if(uint8_t(c) < ' ')
+            fprintf(file, "\\u%04x", unsigned(uint8_t(c)));
+        else
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+bool BenchmarkReport::writeJSON(const std::string &fileName) const
+{
+    auto file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open the benchmark report %s\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "{\n  \"suite\": ");
+    writeJSONString(file, suiteName);
+    fprintf(file, ",\n  \"context\": {");
+    for(size_t i = 0; i < context.size(); ++i)
+    {
+        fprintf(file, "%s\n    ", i > 0 ? "," : "");
+        writeJSONString(file, context[i].first);
+        fprintf(file, ": ");
+        writeJSONString(file, context[i].second);
+    }
+    fprintf(file, "%s},\n  \"benchmarks\": [", context.empty() ? "" : "\n  ");
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        auto &result = results[i];
+        fprintf(file, "%s\n    {\"name\": ", i > 0 ? "," : "");
+        writeJSONString(file, result.name);
+        fprintf(file, ", \"unit\": \"ns\", \"iterations\": %zu, \"items_per_iteration\": %.17g, "
+            "\"min\": %.1f, \"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+            result.iterations, result.itemsPerIteration,
+            result.minimum, result.mean, result.p50, result.p90, result.p99, result.maximum);
+    }
+    fprintf(file, "\n  ]\n}\n");
+
+    bool succeeded = !ferror(file);
+    succeeded = fclose(file) == 0 && succeeded;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the benchmark report %s\n", fileName.c_str());
+    return succeeded;
+}
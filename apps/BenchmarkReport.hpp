@@ -0,0 +1,75 @@
+#ifndef SHADER_VIS_BENCHMARK_REPORT_HPP
+#define SHADER_VIS_BENCHMARK_REPORT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * The distribution of the iteration times of a benchmark, in nanoseconds.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    size_t iterations = 0;
+    double itemsPerIteration = 1;
+    double minimum = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double maximum = 0;
+};
+
+/**
+ * Collects the benchmark results of a run, and writes them as a table and as
+ * JSON, so that the results of different versions can be compared.
+ */
+class BenchmarkReport
+{
+public:
+    explicit BenchmarkReport(const std::string &suiteName);
+
+    void setContext(const std::string &key, const std::string &value);
+    void addSamples(const std::string &name, std::vector<double> nanoseconds, double itemsPerIteration = 1);
+
+    const std::vector<BenchmarkResult> &getResults() const
+    {
+        return results;
+    }
+
+    void printTable() const;
+    bool writeJSON(const std::string &fileName) const;
+
+private:
+    std::string suiteName;
+    std::vector<std::pair<std::string, std::string>> context;
+    std::vector<BenchmarkResult> results;
+};
+
+/**
+ * Runs the function warmupIterations times without measuring it, and then
+ * returns the duration of each of the measured iterations, in nanoseconds.
+ */
+template<typename FT>
+std::vector<double> sampleBenchmark(size_t warmupIterations, size_t iterations, const FT &function)
+{
+    for(size_t i = 0; i < warmupIterations; ++i)
+        function();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        function();
+        auto endTime = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano> (endTime - startTime).count());
+    }
+
+    return samples;
+}
+
+#endif //SHADER_VIS_BENCHMARK_REPORT_HPP
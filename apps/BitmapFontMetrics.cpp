@@ -0,0 +1,79 @@
+#include "BitmapFontMetrics.hpp"
+
+void BitmapFontMetrics::build(uint32_t textureWidth, uint32_t textureHeight, int fontGlyphWidth, int fontGlyphHeight, int columns, float scale)
+{
+    glyphWidth = fontGlyphWidth*scale;
+    glyphHeight = fontGlyphHeight*scale;
+
+    float inverseWidth = 1.0f / textureWidth;
+    float inverseHeight = 1.0f / textureHeight;
+    for(size_t i = 0; i < GlyphCount; ++i)
+    {
+        auto &glyph = glyphs[i];
+        glyph = BitmapFontGlyph();
+        glyph.advance = glyphWidth;
+
+        // The font only contains the printable ASCII characters. The control
+        // characters, and the characters outside of ASCII only advance.
+        if(i < ' ' || i > 127)
+            continue;
+
+        int index = int(i) - ' ';
+        int column = index % columns;
+        int row = index / columns;
+        glyph.hasQuad = true;
+        glyph.fontX = column * fontGlyphWidth * inverseWidth;
+        glyph.fontY = row * fontGlyphHeight * inverseHeight;
+        glyph.fontWidth = fontGlyphWidth * inverseWidth;
+        glyph.fontHeight = fontGlyphHeight * inverseHeight;
+    }
+}
+
+float BitmapFontMetrics::measureString(const char *string, size_t length) const
+{
+    float width = 0;
+    for(size_t i = 0; i < length; ++i)
+        width += getGlyph(string[i]).advance;
+    return width;
+}
+
+size_t BitmapFontMetrics::countStringQuads(const char *string, size_t length) const
+{
+    size_t count = 0;
+    for(size_t i = 0; i < length; ++i)
+        count += getGlyph(string[i]).hasQuad ? 1 : 0;
+    return count;
+}
+
+float BitmapFontMetrics::layoutString(const char *string, size_t length, float x, float y, float r, float g, float b, float a, UIElementQuad *dest) const
+{
+    float advance = 0;
+    for(size_t i = 0; i < length; ++i)
+    {
+        auto &glyph = getGlyph(string[i]);
+        if(glyph.hasQuad)
+        {
+            auto &quad = *dest++;
+            quad.x = x + advance;
+            quad.y = y;
+            quad.width = glyphWidth;
+            quad.height = glyphHeight;
+
+            quad.r = r;
+            quad.g = g;
+            quad.b = b;
+            quad.a = a;
+
+            quad.isGlyph = true;
+            quad.reserved[0] = quad.reserved[1] = quad.reserved[2] = 0;
+            quad.fontX = glyph.fontX;
+            quad.fontY = glyph.fontY;
+            quad.fontWidth = glyph.fontWidth;
+            quad.fontHeight = glyph.fontHeight;
+        }
+
+        advance += glyph.advance;
+    }
+
+    return advance;
+}
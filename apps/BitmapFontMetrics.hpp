@@ -0,0 +1,80 @@
+#ifndef SHADER_VIS_BITMAP_FONT_METRICS_HPP
+#define SHADER_VIS_BITMAP_FONT_METRICS_HPP
+
+#include "UIElementQuad.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * The precomputed placement of a glyph in the font texture, in normalized
+ * texture coordinates, and its advance in screen units.
+ */
+struct BitmapFontGlyph
+{
+    float advance = 0;
+    bool hasQuad = false;
+    float fontX = 0, fontY = 0;
+    float fontWidth = 0, fontHeight = 0;
+};
+
+/**
+ * Glyph metrics table of a fixed grid bitmap font, with a text layout that
+ * writes the quads of whole strings into caller provided storage. The table is
+ * built once when the font is loaded, so that laying out a glyph is a single
+ * table lookup instead of recomputing its row, column and texture rectangle.
+ */
+class BitmapFontMetrics
+{
+public:
+    static constexpr size_t GlyphCount = 256;
+
+    void build(uint32_t textureWidth, uint32_t textureHeight, int glyphWidth, int glyphHeight, int columns, float scale);
+
+    const BitmapFontGlyph &getGlyph(char c) const
+    {
+        return glyphs[uint8_t(c)];
+    }
+
+    float getGlyphWidth() const
+    {
+        return glyphWidth;
+    }
+
+    float getLineHeight() const
+    {
+        return glyphHeight;
+    }
+
+    // The width of the string, without generating any quad.
+    float measureString(const char *string, size_t length) const;
+    float measureString(const std::string &string) const
+    {
+        return measureString(string.data(), string.size());
+    }
+
+    // The number of quads that layoutString emits for the string.
+    size_t countStringQuads(const char *string, size_t length) const;
+    size_t countStringQuads(const std::string &string) const
+    {
+        return countStringQuads(string.data(), string.size());
+    }
+
+    /**
+     * Writes the quads of the string into dest, which must have room for
+     * countStringQuads quads. The glyph positions are the prefix sum of the
+     * advances. Returns the width of the string.
+     */
+    float layoutString(const char *string, size_t length, float x, float y, float r, float g, float b, float a, UIElementQuad *dest) const;
+    float layoutString(const std::string &string, float x, float y, float r, float g, float b, float a, UIElementQuad *dest) const
+    {
+        return layoutString(string.data(), string.size(), x, y, r, g, b, a, dest);
+    }
+
+private:
+    BitmapFontGlyph glyphs[GlyphCount];
+    float glyphWidth = 0;
+    float glyphHeight = 0;
+};
+
+#endif //SHADER_VIS_BITMAP_FONT_METRICS_HPP
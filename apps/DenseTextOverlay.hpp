@@ -0,0 +1,38 @@
+#ifndef SHADER_VIS_DENSE_TEXT_OVERLAY_HPP
+#define SHADER_VIS_DENSE_TEXT_OVERLAY_HPP
+
+#include "ImmediateUI.hpp"
+#include <string>
+
+/**
+ * Fills an area with rows of glyphs that scroll with the frame index, so that
+ * every row is generated and uploaded again each frame. This is the worst case
+ * of the UI pipeline, which is used to compare the quad encodings.
+ */
+inline void denseTextOverlay(ImmediateUI &ui, float width, float height, size_t frameIndex)
+{
+    auto &fontMetrics = ui.getFontMetrics();
+    auto lineHeight = fontMetrics.getLineHeight();
+    if(fontMetrics.getGlyphWidth() <= 0 || lineHeight <= 0)
+        return;
+
+    auto columns = size_t(width / fontMetrics.getGlyphWidth());
+    auto rows = size_t(height / lineHeight);
+    std::string line(columns, ' ');
+    for(size_t row = 0; row < rows; ++row)
+    {
+        for(size_t column = 0; column < columns; ++column)
+            line[column] = char('!' + (row*7 + column*3 + frameIndex) % 94);
+
+        UIWidgetKey key;
+        key.label = line;
+        key.y = row*lineHeight;
+        if(ui.getQuadCache().beginWidget(key))
+        {
+            ui.drawString(line, 0, key.y, 0.9f, 0.9f, 0.9f, 1.0f);
+            ui.getQuadCache().endWidget();
+        }
+    }
+}
+
+#endif //SHADER_VIS_DENSE_TEXT_OVERLAY_HPP
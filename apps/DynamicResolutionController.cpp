@@ -0,0 +1,50 @@
+#include "DynamicResolutionController.hpp"
+#include <math.h>
+#include <algorithm>
+
+void DynamicResolutionController::update(float frameSeconds, bool isGPUBound)
+{
+    if(!isEnabled())
+        return;
+
+    ceiling = std::min(ceiling + CeilingRelaxationPerFrame, MaxScale);
+    if(ignoredFrames > 0)
+    {
+        --ignoredFrames;
+        return;
+    }
+
+    // Without waiting on a fence, the GPU finished the frame with some headroom.
+    if(!isGPUBound)
+    {
+        averageSeconds = 0;
+        grow();
+        return;
+    }
+
+    averageSeconds = averageSeconds > 0 ? averageSeconds + (frameSeconds - averageSeconds)*SmoothingFactor : frameSeconds;
+    if(averageSeconds > targetSeconds*OverrunTolerance)
+    {
+        ceiling = scale;
+        scale = std::max(scale*sqrtf(targetSeconds / averageSeconds), MinScale);
+        averageSeconds = 0;
+        ignoredFrames = latencyFrames;
+    }
+    else if(averageSeconds < targetSeconds*HeadroomFactor)
+    {
+        grow();
+    }
+}
+
+void DynamicResolutionController::grow()
+{
+    // The scale that exceeded the target is only reached again once the ceiling has relaxed.
+    auto limit = ceiling < MaxScale ? ceiling - GrowthPerFrame : MaxScale;
+    scale = std::max(scale, std::min(scale + GrowthPerFrame, limit));
+}
+
+uint32_t DynamicResolutionController::getScaledSize(uint32_t size, float scale)
+{
+    // Rounded up, so that the upscaling never samples outside of the rendered pixels.
+    return std::max(uint32_t(ceilf(size*scale)), 1u);
+}
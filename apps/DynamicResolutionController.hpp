@@ -0,0 +1,81 @@
+#ifndef SHADER_VIS_DYNAMIC_RESOLUTION_CONTROLLER_HPP
+#define SHADER_VIS_DYNAMIC_RESOLUTION_CONTROLLER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Chooses the fraction of the screen size that the noise pass is rendered at,
+ * so that the GPU frame time stays below a target. The cost of the pass is
+ * proportional to its pixel count, so after the target is exceeded the scale
+ * is reduced by the square root of the overrun at once. While the frames stay
+ * under the target, the scale grows slowly back, without going above the
+ * scale that last exceeded the target until that ceiling has relaxed, which
+ * keeps the scale from oscillating around the target.
+ *
+ * agpu has no timestamp queries, so the GPU time is observed through the frame
+ * time: when the CPU had to wait for the fence of a previous frame, the frames
+ * in flight are full and the loop runs at the pace of the GPU.
+ */
+class DynamicResolutionController
+{
+public:
+    static constexpr float MinScale = 0.25f;
+    static constexpr float MaxScale = 1.0f;
+
+    void setTargetSeconds(float newTargetSeconds)
+    {
+        targetSeconds = newTargetSeconds;
+    }
+
+    float getTargetSeconds() const
+    {
+        return targetSeconds;
+    }
+
+    bool isEnabled() const
+    {
+        return targetSeconds > 0;
+    }
+
+    float getScale() const
+    {
+        return scale;
+    }
+
+    // The frames that are already in flight were recorded with the previous
+    // scale, so their times are ignored after the scale drops.
+    void setLatencyFrames(size_t newLatencyFrames)
+    {
+        latencyFrames = newLatencyFrames;
+    }
+
+    // The smoothed time of the frames that waited for the GPU.
+    float getGPUSeconds() const
+    {
+        return averageSeconds;
+    }
+
+    void update(float frameSeconds, bool isGPUBound);
+
+    // The size of the noise pass for a screen size, which is never smaller than a pixel.
+    static uint32_t getScaledSize(uint32_t size, float scale);
+
+private:
+    void grow();
+
+    static constexpr float SmoothingFactor = 0.2f;
+    static constexpr float OverrunTolerance = 1.05f;
+    static constexpr float HeadroomFactor = 0.85f;
+    static constexpr float GrowthPerFrame = 0.01f;
+    static constexpr float CeilingRelaxationPerFrame = 0.002f;
+
+    float targetSeconds = 0;
+    float scale = MaxScale;
+    float ceiling = MaxScale;
+    float averageSeconds = 0;
+    size_t latencyFrames = 2;
+    size_t ignoredFrames = 0;
+};
+
+#endif //SHADER_VIS_DYNAMIC_RESOLUTION_CONTROLLER_HPP
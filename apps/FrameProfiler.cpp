@@ -0,0 +1,158 @@
+#include "FrameProfiler.hpp"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+FrameProfiler &FrameProfiler::get()
+{
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+uint64_t FrameProfiler::now()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+double FrameProfiler::getProcessCPUSeconds()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if(!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return 0;
+
+    auto toSeconds = [](const FILETIME &time) {
+        return double((uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernelTime) + toSeconds(userTime);
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+FrameProfiler::ThreadRing &FrameProfiler::getCurrentThreadRing()
+{
+    // The rings are never destroyed, so they outlive the threads that write into them.
+    thread_local ThreadRing *currentThreadRing = nullptr;
+    if(!currentThreadRing)
+    {
+        std::unique_lock<std::mutex> lock(ringsMutex);
+        rings.push_back(std::unique_ptr<ThreadRing> (new ThreadRing()));
+        currentThreadRing = rings.back().get();
+        currentThreadRing->threadIndex = uint32_t(rings.size());
+    }
+
+    return *currentThreadRing;
+}
+
+void FrameProfiler::setCurrentThreadName(const char *name)
+{
+    getCurrentThreadRing().threadName = name;
+}
+
+void FrameProfiler::record(const char *name, uint64_t startNanoseconds, uint64_t endNanoseconds)
+{
+    auto &ring = getCurrentThreadRing();
+    auto index = ring.writeIndex.load(std::memory_order_relaxed);
+    ring.events[index % ThreadRingCapacity] = ProfileEvent{name, startNanoseconds, endNanoseconds};
+    ring.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void FrameProfiler::copyRingEvents(const ThreadRing &ring, std::vector<ProfileEvent> &events)
+{
+    auto endIndex = ring.writeIndex.load(std::memory_order_acquire);
+    auto startIndex = endIndex > ThreadRingCapacity ? endIndex - ThreadRingCapacity : 0;
+    auto firstCopied = events.size();
+    for(auto i = startIndex; i < endIndex; ++i)
+        events.push_back(ring.events[i % ThreadRingCapacity]);
+
+    // The owner thread may have overwritten the oldest slots while they were copied.
+    auto newEndIndex = ring.writeIndex.load(std::memory_order_acquire);
+    if(newEndIndex > startIndex + ThreadRingCapacity)
+    {
+        auto overwrittenCount = std::min(size_t(newEndIndex - startIndex - ThreadRingCapacity), size_t(endIndex - startIndex));
+        events.erase(events.begin() + firstCopied, events.begin() + firstCopied + overwrittenCount);
+    }
+}
+
+static void writeJSONString(FILE *file, const char *string)
+{
+    fputc('"', file);
+    for(auto c = string; *c; ++c)
+    {
+        if(*c == '"' || *c == '\\')
+            fprintf(file, "\\%c", *c);
+        else if(uint8_t(*c) < ' ')
+            fprintf(file, "\\u%04x", unsigned(uint8_t(*c)));
+        else
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string &fileName)
+{
+    auto file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open the trace file %s\n", fileName.c_str());
+        return false;
+    }
+
+    std::vector<std::pair<const ThreadRing*, std::vector<ProfileEvent>>> threadEvents;
+    uint64_t baseNanoseconds = UINT64_MAX;
+    {
+        std::unique_lock<std::mutex> lock(ringsMutex);
+        for(auto &ring : rings)
+        {
+            std::vector<ProfileEvent> events;
+            copyRingEvents(*ring, events);
+            for(auto &event : events)
+                baseNanoseconds = std::min(baseNanoseconds, event.startNanoseconds);
+            threadEvents.push_back(std::make_pair(ring.get(), std::move(events)));
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool isFirst = true;
+    for(auto &entry : threadEvents)
+    {
+        auto ring = entry.first;
+        if(ring->threadName)
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", isFirst ? "" : ",\n", ring->threadIndex);
+            writeJSONString(file, ring->threadName);
+            fprintf(file, "}}");
+            isFirst = false;
+        }
+
+        for(auto &event : entry.second)
+        {
+            fprintf(file, "%s{\"name\":", isFirst ? "" : ",\n");
+            writeJSONString(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                ring->threadIndex,
+                (event.startNanoseconds - baseNanoseconds) / 1000.0,
+                (event.endNanoseconds - event.startNanoseconds) / 1000.0);
+            isFirst = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool succeeded = !ferror(file);
+    succeeded = fclose(file) == 0 && succeeded;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the trace file %s\n", fileName.c_str());
+    return succeeded;
+}
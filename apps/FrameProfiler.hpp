@@ -0,0 +1,107 @@
+#ifndef SHADER_VIS_FRAME_PROFILER_HPP
+#define SHADER_VIS_FRAME_PROFILER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * A completed profiling zone. The name must be a string with static storage.
+ */
+struct ProfileEvent
+{
+    const char *name;
+    uint64_t startNanoseconds;
+    uint64_t endNanoseconds;
+};
+
+/**
+ * Collects the scoped zones of all the threads. Each thread writes into its
+ * own fixed size ring, with a single atomic store to publish each event, so
+ * that recording a zone never takes a lock. The oldest events of a ring are
+ * overwritten once it is full. Recording is disabled by default, in which case
+ * a zone only costs a relaxed atomic load.
+ */
+class FrameProfiler
+{
+public:
+    static constexpr size_t ThreadRingCapacity = 1 << 14;
+
+    static FrameProfiler &get();
+
+    // High resolution monotonic time.
+    static uint64_t now();
+
+    // The CPU time that was consumed by all the threads of the process.
+    static double getProcessCPUSeconds();
+
+    void setEnabled(bool enabled)
+    {
+        isEnabledFlag.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const
+    {
+        return isEnabledFlag.load(std::memory_order_relaxed);
+    }
+
+    // The name of the calling thread in the exported trace.
+    void setCurrentThreadName(const char *name);
+
+    void record(const char *name, uint64_t startNanoseconds, uint64_t endNanoseconds);
+
+    // Writes the events that are still in the rings in the Chrome trace event format.
+    bool writeChromeTrace(const std::string &fileName);
+
+private:
+    struct ThreadRing
+    {
+        uint32_t threadIndex;
+        const char *threadName = nullptr;
+        std::atomic<uint64_t> writeIndex{0};
+        ProfileEvent events[ThreadRingCapacity];
+    };
+
+    ThreadRing &getCurrentThreadRing();
+    static void copyRingEvents(const ThreadRing &ring, std::vector<ProfileEvent> &events);
+
+    std::atomic<bool> isEnabledFlag{false};
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+};
+
+/**
+ * Records the lifetime of the scope as a zone of the calling thread.
+ */
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *zoneName)
+        : name(FrameProfiler::get().isEnabled() ? zoneName : nullptr),
+          startNanoseconds(name ? FrameProfiler::now() : 0)
+    {
+    }
+
+    ~ProfileZone()
+    {
+        if(name)
+            FrameProfiler::get().record(name, startNanoseconds, FrameProfiler::now());
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;
+    uint64_t startNanoseconds;
+};
+
+#define SHADER_VIS_PROFILE_CONCAT_(a, b) a##b
+#define SHADER_VIS_PROFILE_CONCAT(a, b) SHADER_VIS_PROFILE_CONCAT_(a, b)
+#define SHADER_VIS_PROFILE_ZONE(name) ProfileZone SHADER_VIS_PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+#endif //SHADER_VIS_FRAME_PROFILER_HPP
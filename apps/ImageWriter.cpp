@@ -0,0 +1,182 @@
+#include "ImageWriter.hpp"
+#include <ctype.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+bool writeImagePPM(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch)
+{
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+
+    std::vector<uint8_t> row(width*3);
+    bool succeeded = true;
+    for(uint32_t y = 0; y < height && succeeded; ++y)
+    {
+        auto sourceRow = pixels + y*pitch;
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            auto pixel = sourceRow[x];
+            row[x*3] = uint8_t(pixel >> 16);
+            row[x*3 + 1] = uint8_t(pixel >> 8);
+            row[x*3 + 2] = uint8_t(pixel);
+        }
+
+        succeeded = fwrite(row.data(), row.size(), 1, file) == 1;
+    }
+
+    if(fclose(file) != 0)
+        succeeded = false;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write file %s\n", fileName.c_str());
+    return succeeded;
+}
+
+static uint32_t pngCRCTable[256];
+
+static void initializePNGCRCTable()
+{
+    static bool initialized = false;
+    if(initialized)
+        return;
+
+    for(uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t c = i;
+        for(int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        pngCRCTable[i] = c;
+    }
+    initialized = true;
+}
+
+static uint32_t updatePNGCRC(uint32_t crc, const uint8_t *data, size_t size)
+{
+    for(size_t i = 0; i < size; ++i)
+        crc = pngCRCTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+static void appendBigEndian32(std::vector<uint8_t> &buffer, uint32_t value)
+{
+    buffer.push_back(uint8_t(value >> 24));
+    buffer.push_back(uint8_t(value >> 16));
+    buffer.push_back(uint8_t(value >> 8));
+    buffer.push_back(uint8_t(value));
+}
+
+static bool writePNGChunk(FILE *file, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> header;
+    appendBigEndian32(header, uint32_t(data.size()));
+    header.insert(header.end(), type, type + 4);
+
+    uint32_t crc = updatePNGCRC(0xffffffffu, header.data() + 4, 4);
+    crc = updatePNGCRC(crc, data.data(), data.size()) ^ 0xffffffffu;
+
+    std::vector<uint8_t> footer;
+    appendBigEndian32(footer, crc);
+
+    return fwrite(header.data(), header.size(), 1, file) == 1 &&
+        (data.empty() || fwrite(data.data(), data.size(), 1, file) == 1) &&
+        fwrite(footer.data(), footer.size(), 1, file) == 1;
+}
+
+bool writeImagePNG(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch)
+{
+    initializePNGCRCTable();
+
+    // Filter type byte followed by the RGBA8 pixels of each row.
+    size_t rowSize = 1 + size_t(width)*4;
+    std::vector<uint8_t> rawData(rowSize*height);
+    for(uint32_t y = 0; y < height; ++y)
+    {
+        auto sourceRow = pixels + y*pitch;
+        auto destRow = &rawData[y*rowSize];
+        destRow[0] = 0;
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            auto pixel = sourceRow[x];
+            destRow[1 + x*4] = uint8_t(pixel >> 16);
+            destRow[1 + x*4 + 1] = uint8_t(pixel >> 8);
+            destRow[1 + x*4 + 2] = uint8_t(pixel);
+            destRow[1 + x*4 + 3] = uint8_t(pixel >> 24);
+        }
+    }
+
+    // zlib stream made of stored deflate blocks.
+    const size_t maxStoredBlockSize = 65535;
+    std::vector<uint8_t> zlibData;
+    zlibData.reserve(rawData.size() + rawData.size() / maxStoredBlockSize * 5 + 16);
+    zlibData.push_back(0x78);
+    zlibData.push_back(0x01);
+    size_t offset = 0;
+    do
+    {
+        size_t blockSize = std::min(maxStoredBlockSize, rawData.size() - offset);
+        bool isFinalBlock = offset + blockSize == rawData.size();
+        zlibData.push_back(isFinalBlock ? 1 : 0);
+        zlibData.push_back(uint8_t(blockSize));
+        zlibData.push_back(uint8_t(blockSize >> 8));
+        zlibData.push_back(uint8_t(~blockSize));
+        zlibData.push_back(uint8_t(~blockSize >> 8));
+        zlibData.insert(zlibData.end(), rawData.begin() + offset, rawData.begin() + offset + blockSize);
+        offset += blockSize;
+    } while(offset < rawData.size());
+
+    uint32_t adlerA = 1, adlerB = 0;
+    for(auto byte : rawData)
+    {
+        adlerA = (adlerA + byte) % 65521;
+        adlerB = (adlerB + adlerA) % 65521;
+    }
+    appendBigEndian32(zlibData, (adlerB << 16) | adlerA);
+
+    std::vector<uint8_t> headerData;
+    appendBigEndian32(headerData, width);
+    appendBigEndian32(headerData, height);
+    headerData.push_back(8); // Bit depth
+    headerData.push_back(6); // RGBA
+    headerData.push_back(0); // Deflate
+    headerData.push_back(0); // Adaptive filtering
+    headerData.push_back(0); // No interlacing
+
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
+        return false;
+    }
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    bool succeeded = fwrite(signature, sizeof(signature), 1, file) == 1 &&
+        writePNGChunk(file, "IHDR", headerData) &&
+        writePNGChunk(file, "IDAT", zlibData) &&
+        writePNGChunk(file, "IEND", std::vector<uint8_t> ());
+
+    if(fclose(file) != 0)
+        succeeded = false;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write file %s\n", fileName.c_str());
+    return succeeded;
+}
+
+bool writeImage(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch)
+{
+    auto extensionPosition = fileName.rfind('.');
+    if(extensionPosition != std::string::npos)
+    {
+        auto extension = fileName.substr(extensionPosition);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if(extension == ".ppm")
+            return writeImagePPM(fileName, width, height, pixels, pitch);
+    }
+
+    return writeImagePNG(fileName, width, height, pixels, pitch);
+}
@@ -0,0 +1,19 @@
+#ifndef SHADER_VIS_IMAGE_WRITER_HPP
+#define SHADER_VIS_IMAGE_WRITER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Writers for B8G8R8A8 images, such as the back buffer or the CPU noise
+ * rasterizer output. The pitch is expressed in pixels. The PNG writer emits
+ * uncompressed deflate blocks, so that no compression library is required.
+ */
+bool writeImagePPM(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch);
+bool writeImagePNG(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch);
+
+// Selects the format from the file name extension. PNG is used by default.
+bool writeImage(const std::string &fileName, uint32_t width, uint32_t height, const uint32_t *pixels, size_t pitch);
+
+#endif //SHADER_VIS_IMAGE_WRITER_HPP
@@ -0,0 +1,138 @@
+#include "ImmediateUI.hpp"
+#include <algorithm>
+#include <vector>
+
+void ImmediateUI::beginFrame()
+{
+    quadCache.beginFrame();
+}
+
+void ImmediateUI::endFrame()
+{
+    quadCache.endFrame();
+}
+
+void ImmediateUI::drawRectangle(float x, float y, float w, float h, float r, float g, float b, float a)
+{
+    UIElementQuad quad = {};
+    quad.x = x;
+    quad.y = y;
+    quad.width = w;
+    quad.height = h;
+    
+    quad.r = r;
+    quad.g = g;
+    quad.b = b;
+    quad.a = a;
+
+    quadCache.addQuad(quad);
+}
+
+float ImmediateUI::drawGlyph(char c, float x, float y, float r, float g, float b, float a)
+{
+    return drawString(&c, 1, x, y, r, g, b, a);
+}
+
+float ImmediateUI::drawString(const char *string, size_t length, float x, float y, float r, float g, float b, float a)
+{
+    auto quadCount = fontMetrics.countStringQuads(string, length);
+    auto quads = quadCache.allocateQuads(quadCount);
+    if(!quads)
+        return fontMetrics.measureString(string, length);
+    return fontMetrics.layoutString(string, length, x, y, r, g, b, a, quads);
+}
+
+void ImmediateUI::beginLayout(float x, float y)
+{
+    currentLayoutX = currentLayoutRowX = x;
+    currentLayoutY = currentLayoutRowY = y;
+}
+
+void ImmediateUI::advanceLayoutRow()
+{
+    currentLayoutRowY += fontMetrics.getLineHeight() + 5;
+    currentLayoutX = currentLayoutRowX;
+    currentLayoutY = currentLayoutRowY;
+}
+
+void ImmediateUI::sliderForFloat(const std::string &label, float minValue, float maxValue, float &value)
+{
+    float labelX = currentLayoutX;
+    float labelY = currentLayoutY;
+    currentLayoutX += fontMetrics.measureString(label);
+
+    float sliderHeight = fontMetrics.getLineHeight();
+    float sliderWidth = 80;
+
+    float alpha = (std::min(std::max(value, minValue), maxValue) - minValue) / (maxValue - minValue);
+
+    if(input.hasLeftDragEvent && !input.hasHandledLeftDragEvent &&
+        currentLayoutY <= input.leftDragStartY && input.leftDragStartY <= currentLayoutY + sliderHeight &&
+        currentLayoutX <= input.leftDragStartX && input.leftDragStartX <= currentLayoutX + sliderWidth)
+    {
+        if(input.leftDragDeltaX != 0)
+        {
+            float deltaAlpha = input.leftDragDeltaX / sliderWidth;
+            alpha = std::min(std::max(alpha + deltaAlpha, 0.0f), 1.0f);
+            value = minValue + (maxValue - minValue)*alpha;
+        }
+
+        input.hasHandledLeftDragEvent = true;
+    }
+
+    // The quads are only generated again when something that affects them changed.
+    UIWidgetKey key;
+    key.label = label;
+    key.x = labelX;
+    key.y = labelY;
+    key.value = value;
+    key.minValue = minValue;
+    key.maxValue = maxValue;
+    if(quadCache.beginWidget(key))
+    {
+        drawString(label, labelX, labelY, 1.0, 1.0, 1.0, 0.6);
+        drawRectangle(currentLayoutX, currentLayoutY, sliderWidth, sliderHeight, 1.0, 1.0, 1.0, 0.6);
+
+        float sliderBarWidth = 4;
+        drawRectangle(currentLayoutX + (sliderWidth - sliderBarWidth)*alpha, currentLayoutY, sliderBarWidth, sliderHeight, 0.0, 1.0, 0.0, 1.0);
+        quadCache.endWidget();
+    }
+
+    currentLayoutX += sliderWidth;
+    currentLayoutX += 5;
+}
+
+void ImmediateUI::textOverlay(const std::string &text, float x, float bottomY, float r, float g, float b, float a)
+{
+    static constexpr size_t MaxOverlayLines = 24;
+    std::vector<std::string> lines;
+    size_t lineStart = 0;
+    while(lineStart <= text.size())
+    {
+        auto lineEnd = text.find('\n', lineStart);
+        if(lineEnd == std::string::npos)
+            lineEnd = text.size();
+        if(lineEnd > lineStart)
+            lines.push_back(text.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+    if(lines.size() > MaxOverlayLines)
+        lines.erase(lines.begin() + MaxOverlayLines, lines.end());
+
+    auto lineHeight = fontMetrics.getLineHeight();
+    auto y = bottomY - lines.size()*lineHeight;
+    for(auto &line : lines)
+    {
+        UIWidgetKey key;
+        key.label = line;
+        key.x = x;
+        key.y = y;
+        if(quadCache.beginWidget(key))
+        {
+            drawRectangle(x, y, fontMetrics.measureString(line), lineHeight, 0.0, 0.0, 0.0, 0.75);
+            drawString(line, x, y, r, g, b, a);
+            quadCache.endWidget();
+        }
+        y += lineHeight;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef SHADER_VIS_IMMEDIATE_UI_HPP
+#define SHADER_VIS_IMMEDIATE_UI_HPP
+
+#include "BitmapFontMetrics.hpp"
+#include "RetainedUIQuadCache.hpp"
+#include <string>
+
+/**
+ * The input events of a frame that can be consumed by the UI widgets. The
+ * events that are not handled by a widget are left to the application.
+ */
+struct UIInputEvents
+{
+    bool hasWheelEvent = false;
+    bool hasHandledWheelEvent = false;
+    int wheelDelta = 0;
+
+    bool hasLeftDragEvent = false;
+    bool hasHandledLeftDragEvent = false;
+    int leftDragStartX = 0;
+    int leftDragStartY = 0;
+    int leftDragDeltaX = 0;
+    int leftDragDeltaY = 0;
+
+    void reset()
+    {
+        *this = UIInputEvents();
+    }
+};
+
+/**
+ * Immediate mode widgets, which emit their quads into a retained quad cache.
+ * The widgets lay themselves out in rows, from left to right.
+ */
+class ImmediateUI
+{
+public:
+    RetainedUIQuadCache &getQuadCache()
+    {
+        return quadCache;
+    }
+
+    BitmapFontMetrics &getFontMetrics()
+    {
+        return fontMetrics;
+    }
+
+    UIInputEvents &getInput()
+    {
+        return input;
+    }
+
+    void beginFrame();
+    void endFrame();
+
+    void drawRectangle(float x, float y, float w, float h, float r, float g, float b, float a);
+    float drawGlyph(char c, float x, float y, float r, float g, float b, float a);
+    float drawString(const char *string, size_t length, float x, float y, float r, float g, float b, float a);
+    float drawString(const std::string &string, float x, float y, float r, float g, float b, float a)
+    {
+        return drawString(string.data(), string.size(), x, y, r, g, b, a);
+    }
+
+    void beginLayout(float x = 5, float y = 5);
+    void advanceLayoutRow();
+
+    void sliderForFloat(const std::string &label, float minValue, float maxValue, float &value);
+
+    // Draws a multi line text over a dark background, with its last line ending at bottomY.
+    void textOverlay(const std::string &text, float x, float bottomY, float r, float g, float b, float a);
+
+private:
+    RetainedUIQuadCache quadCache;
+    BitmapFontMetrics fontMetrics;
+    UIInputEvents input;
+
+    float currentLayoutRowX = 0;
+    float currentLayoutRowY = 0;
+    float currentLayoutX = 0;
+    float currentLayoutY = 0;
+};
+
+#endif //SHADER_VIS_IMMEDIATE_UI_HPP
@@ -0,0 +1,125 @@
+#include "MappedFile.hpp"
+#include <stdio.h>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::exists(const std::string &fileName)
+{
+    struct stat fileStat;
+    return stat(fileName.c_str(), &fileStat) == 0;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &fileName)
+{
+    close();
+
+    auto file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        fprintf(stderr, "Failed to map the empty file %s\n", fileName.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    auto view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if(!view)
+    {
+        fprintf(stderr, "Failed to map file %s\n", fileName.c_str());
+        if(mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedData = reinterpret_cast<const uint8_t*> (view);
+    mappedSize = size_t(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(mappedData)
+        UnmapViewOfFile(mappedData);
+    if(mappingHandle)
+        CloseHandle(mappingHandle);
+    if(fileHandle)
+        CloseHandle(fileHandle);
+
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+bool MappedFile::open(const std::string &fileName)
+{
+    close();
+
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        fprintf(stderr, "Failed to map the empty file %s\n", fileName.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping keeps the file alive, so the descriptor is not needed anymore.
+    auto size = size_t(fileStat.st_size);
+    auto view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(view == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map file %s\n", fileName.c_str());
+        return false;
+    }
+
+    // The whole asset is read right away by the upload.
+    madvise(view, size, MADV_WILLNEED);
+
+    mappedData = reinterpret_cast<const uint8_t*> (view);
+    mappedSize = size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(mappedData)
+        munmap(const_cast<uint8_t*> (mappedData), mappedSize);
+
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+#endif
@@ -0,0 +1,57 @@
+#ifndef SHADER_VIS_MAPPED_FILE_HPP
+#define SHADER_VIS_MAPPED_FILE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * Read-only view of a whole file that is mapped into the address space, so
+ * that the assets are given to the device straight from the page cache
+ * without being copied into intermediate buffers. The view stays valid until
+ * the file is closed or the object is destroyed.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    static bool exists(const std::string &fileName);
+
+    bool open(const std::string &fileName);
+    void close();
+
+    bool isOpen() const
+    {
+        return mappedData != nullptr;
+    }
+
+    const uint8_t *data() const
+    {
+        return mappedData;
+    }
+
+    const char *chars() const
+    {
+        return reinterpret_cast<const char*> (mappedData);
+    }
+
+    size_t size() const
+    {
+        return mappedSize;
+    }
+
+private:
+    const uint8_t *mappedData = nullptr;
+    size_t mappedSize = 0;
+
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
+
+#endif //SHADER_VIS_MAPPED_FILE_HPP
@@ -0,0 +1,150 @@
+#include "NoiseMapExporter.hpp"
+#include "VoronoiNoiseCPU.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+NoiseMapExporter::NoiseMapExporter(const ScreenAndUIState &state, NoiseMapChannels channels, uint32_t tileSize)
+    : state(state), channels(channels), tileSize(tileSize)
+{
+}
+
+size_t NoiseMapExporter::getBufferByteSize() const
+{
+    return 2*batchSize*size_t(tileSize)*tileSize*TiledTIFFWriter::getPixelByteSize(getPixelFormat());
+}
+
+bool NoiseMapExporter::exportMap(const std::string &fileName, const NoiseMapTileBatchRenderer &renderer)
+{
+    TiledTIFFWriter writer;
+    if(!writer.open(fileName, state.screenWidth, state.screenHeight, tileSize, getPixelFormat()))
+        return false;
+
+    auto tileCountX = writer.getTileCountX();
+    auto tileCount = size_t(tileCountX)*writer.getTileCountY();
+    auto tileByteSize = writer.getTileByteSize();
+    auto batchTileCount = std::min(batchSize, tileCount);
+    printf("Exporting %ux%u pixels in %zu tiles of %u pixels, with %.1f MB of tile buffers.\n",
+        state.screenWidth, state.screenHeight, tileCount, tileSize, 2.0*batchTileCount*tileByteSize / (1024.0*1024.0));
+
+    std::vector<uint8_t> batchStorage[2];
+    std::vector<NoiseMapExportTile> batchTiles[2];
+    std::vector<uint8_t*> batchDestinations[2];
+    std::thread writerThread;
+    bool writerSucceeded = true;
+    bool succeeded = true;
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastProgressTime = startTime;
+    size_t nextTileIndex = 0;
+    for(size_t batchIndex = 0; nextTileIndex < tileCount; ++batchIndex)
+    {
+        // The other buffer may still be written by the writer thread.
+        auto &storage = batchStorage[batchIndex % 2];
+        auto &tiles = batchTiles[batchIndex % 2];
+        auto &destinations = batchDestinations[batchIndex % 2];
+        storage.resize(batchTileCount*tileByteSize);
+        tiles.clear();
+        destinations.clear();
+        for(; tiles.size() < batchTileCount && nextTileIndex < tileCount; ++nextTileIndex)
+        {
+            NoiseMapExportTile tile;
+            tile.index = nextTileIndex;
+            tile.x = uint32_t(nextTileIndex % tileCountX)*tileSize;
+            tile.y = uint32_t(nextTileIndex / tileCountX)*tileSize;
+            tile.width = std::min(tileSize, state.screenWidth - tile.x);
+            tile.height = std::min(tileSize, state.screenHeight - tile.y);
+
+            auto destination = storage.data() + tiles.size()*tileByteSize;
+            if(tile.width < tileSize || tile.height < tileSize)
+                memset(destination, 0, tileByteSize);
+            tiles.push_back(tile);
+            destinations.push_back(destination);
+        }
+
+        if(!renderer(tiles, destinations))
+        {
+            fprintf(stderr, "Failed to render the tiles of the noise map.\n");
+            succeeded = false;
+            break;
+        }
+
+        if(writerThread.joinable())
+        {
+            writerThread.join();
+            if(!writerSucceeded)
+            {
+                succeeded = false;
+                break;
+            }
+        }
+
+        writerThread = std::thread([&writer, &writerSucceeded, &tiles, &destinations]() {
+            for(size_t i = 0; i < tiles.size() && writerSucceeded; ++i)
+                writerSucceeded = writer.writeTile(tiles[i].index, destinations[i]);
+        });
+
+        auto now = std::chrono::steady_clock::now();
+        if(now - lastProgressTime >= std::chrono::seconds(1) || nextTileIndex == tileCount)
+        {
+            double elapsedSeconds = std::chrono::duration<double> (now - startTime).count();
+            printf("Rendered %zu/%zu tiles (%.1f%%), %.1f Mpixels/s\n", nextTileIndex, tileCount,
+                nextTileIndex*100.0 / tileCount, nextTileIndex*double(tileSize)*tileSize / (elapsedSeconds*1e6));
+            lastProgressTime = now;
+        }
+    }
+
+    if(writerThread.joinable())
+        writerThread.join();
+    succeeded = succeeded && writerSucceeded;
+
+    // Writes the directory, or releases the partial file.
+    succeeded = writer.close() && succeeded;
+    return succeeded;
+}
+
+bool NoiseMapExporter::renderBatchWithCPU(WorkStealingThreadPool &threadPool, const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations) const
+{
+    threadPool.parallelFor(tiles.size(), [&](size_t i) {
+        auto &tile = tiles[i];
+        if(channels == NoiseMapChannels::Components)
+        {
+            renderVoronoiNoiseComponentsRegion(state, tile.x, tile.y, tile.width, tile.height, reinterpret_cast<float*> (destinations[i]), tileSize);
+            return;
+        }
+
+        auto pixels = reinterpret_cast<uint32_t*> (destinations[i]);
+        renderVoronoiNoiseRegion(state, tile.x, tile.y, tile.width, tile.height, pixels, tileSize);
+        convertBGRAToRGBA(pixels, size_t(tileSize)*tileSize);
+    });
+    return true;
+}
+
+void NoiseMapExporter::convertBGRAToRGBA(uint32_t *pixels, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto pixel = pixels[i];
+        pixels[i] = (pixel & 0xff00ff00u) | ((pixel >> 16) & 0xffu) | ((pixel & 0xffu) << 16);
+    }
+}
+
+ScreenAndUIState makeNoiseMapTileState(const ScreenAndUIState &mapState, uint32_t x, uint32_t y, uint32_t tileSize)
+{
+    // A pixel covers screenScale / screenWidth view space units in both directions.
+    double pixelSize = double(mapState.screenScale) / mapState.screenWidth;
+    auto tileState = mapState;
+    tileState.screenWidth = tileSize;
+    tileState.screenHeight = tileSize;
+    tileState.screenScale = float(pixelSize*tileSize);
+    tileState.screenOffsetX = float(mapState.screenOffsetX - (x + (double(tileSize) - mapState.screenWidth)*0.5)*pixelSize);
+
+    // Without the flip, the screen coordinates of the rows are negated.
+    if(mapState.flipVertically)
+        tileState.screenOffsetY = float(mapState.screenOffsetY - (y + (double(tileSize) - mapState.screenHeight)*0.5)*pixelSize);
+    else
+        tileState.screenOffsetY = float(mapState.screenOffsetY + (y + (double(mapState.screenHeight) - tileSize)*0.5)*pixelSize);
+    return tileState;
+}
@@ -0,0 +1,89 @@
+#ifndef SHADER_VIS_NOISE_MAP_EXPORTER_HPP
+#define SHADER_VIS_NOISE_MAP_EXPORTER_HPP
+
+#include "ScreenAndUIState.hpp"
+#include "TiledTIFFWriter.hpp"
+#include "WorkStealingThreadPool.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * The content of an exported noise map.
+ */
+enum class NoiseMapChannels
+{
+    // The colored result, as drawn on the screen.
+    Color = 0,
+
+    // The amplitude normalized F1 to F4 distances as floats.
+    Components,
+};
+
+/**
+ * A tile of an exported noise map, in pixels of the map. The tiles at the
+ * right and bottom edges may be smaller than the tile size.
+ */
+struct NoiseMapExportTile
+{
+    size_t index;
+    uint32_t x, y;
+    uint32_t width, height;
+};
+
+// Renders a batch of tiles. Each tile is written at the start of its destination,
+// with a pitch of the tile size, and in the TIFF pixel format of the exporter.
+typedef std::function<bool (const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations)> NoiseMapTileBatchRenderer;
+
+/**
+ * Exports the noise defined by a ScreenAndUIState, whose screen size is the
+ * size of the map, into a tiled TIFF without ever holding the whole map. The
+ * tiles are rendered in batches into one of two buffers, while a writer
+ * thread streams the previous batch to the file, so the rendering and the
+ * I/O overlap and the memory usage only depends on the batch and tile sizes.
+ */
+class NoiseMapExporter
+{
+public:
+    static constexpr uint32_t DefaultTileSize = 256;
+
+    NoiseMapExporter(const ScreenAndUIState &state, NoiseMapChannels channels, uint32_t tileSize = DefaultTileSize);
+
+    TIFFPixelFormat getPixelFormat() const
+    {
+        return channels == NoiseMapChannels::Color ? TIFFPixelFormat::RGBA8 : TIFFPixelFormat::Float32x4;
+    }
+
+    uint32_t getTileSize() const
+    {
+        return tileSize;
+    }
+
+    void setBatchSize(size_t newBatchSize)
+    {
+        batchSize = newBatchSize > 0 ? newBatchSize : 1;
+    }
+
+    // The memory of the two tile batches.
+    size_t getBufferByteSize() const;
+
+    bool exportMap(const std::string &fileName, const NoiseMapTileBatchRenderer &renderer);
+
+    // Renders the batch with the CPU noise evaluator, with a thread pool job per tile.
+    bool renderBatchWithCPU(WorkStealingThreadPool &threadPool, const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations) const;
+
+    // Converts B8G8R8A8 pixels to the R8G8B8A8 layout of the TIFF color samples.
+    static void convertBGRAToRGBA(uint32_t *pixels, size_t count);
+
+private:
+    ScreenAndUIState state;
+    NoiseMapChannels channels;
+    uint32_t tileSize;
+    size_t batchSize = 16;
+};
+
+// The state that draws the tileSize x tileSize region of the map that starts
+// at (x, y) into a tileSize x tileSize viewport, e.g. with the GPU.
+ScreenAndUIState makeNoiseMapTileState(const ScreenAndUIState &mapState, uint32_t x, uint32_t y, uint32_t tileSize);
+
+#endif //SHADER_VIS_NOISE_MAP_EXPORTER_HPP
@@ -0,0 +1,143 @@
+#include "NoiseParameterSweep.hpp"
+#include "VoronoiNoiseCPU.hpp"
+#include <stdio.h>
+#include <algorithm>
+
+bool NoiseParameterSweep::loadConfigurations(const std::string &fileName, const ScreenAndUIState &baseState)
+{
+    FILE *file = fopen(fileName.c_str(), "r");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open the sweep configurations %s\n", fileName.c_str());
+        return false;
+    }
+
+    char line[4096];
+    size_t lineNumber = 0;
+    bool succeeded = true;
+    while(succeeded && fgets(line, sizeof(line), file))
+    {
+        ++lineNumber;
+        auto state = baseState;
+        bool isEmpty = true;
+        for(auto token = strtok(line, " \t\r\n"); token && *token != '#'; token = strtok(nullptr, " \t\r\n"))
+        {
+            if(!parseScreenAndUIStateAssignment(state, token))
+            {
+                fprintf(stderr, "%s:%zu: invalid parameter assignment %s.\n", fileName.c_str(), lineNumber, token);
+                succeeded = false;
+                break;
+            }
+            isEmpty = false;
+        }
+
+        if(succeeded && !isEmpty)
+            addConfiguration(state);
+    }
+
+    fclose(file);
+    return succeeded;
+}
+
+void NoiseParameterSweep::addConfiguration(const ScreenAndUIState &state)
+{
+    configurations.push_back(state);
+    auto &configuration = configurations.back();
+    configuration.screenWidth = sampleWidth;
+    configuration.screenHeight = sampleHeight;
+    configuration.flipVertically = false;
+    configuration.resolutionScale = 1.0f;
+}
+
+void NoiseParameterSweep::setSampleSize(uint32_t width, uint32_t height)
+{
+    sampleWidth = std::max(width, 1u);
+    sampleHeight = std::max(height, 1u);
+    for(auto &configuration : configurations)
+    {
+        configuration.screenWidth = sampleWidth;
+        configuration.screenHeight = sampleHeight;
+    }
+}
+
+NoiseSweepHeader NoiseParameterSweep::getHeader() const
+{
+    NoiseSweepHeader header = {};
+    header.configurationCount = uint32_t(configurations.size());
+    header.sampleWidth = sampleWidth;
+    header.sampleHeight = sampleHeight;
+    header.atlasColumns = imagesEnabled ? getAtlasColumns() : 0;
+    return header;
+}
+
+uint32_t NoiseParameterSweep::getAtlasColumns() const
+{
+    auto maxColumns = std::max(MaxAtlasSize / sampleWidth, 1u);
+    return uint32_t(std::max(std::min(configurations.size(), size_t(maxColumns)), size_t(1)));
+}
+
+uint32_t NoiseParameterSweep::getAtlasWidth() const
+{
+    return getAtlasColumns()*sampleWidth;
+}
+
+uint32_t NoiseParameterSweep::getAtlasHeight() const
+{
+    auto columns = getAtlasColumns();
+    auto rows = std::max((configurations.size() + columns - 1) / columns, size_t(1));
+    return uint32_t(std::min(rows*sampleHeight, size_t(UINT32_MAX)));
+}
+
+bool NoiseParameterSweep::doImagesFitInAtlas() const
+{
+    return sampleWidth <= MaxAtlasSize && getAtlasHeight() <= MaxAtlasSize;
+}
+
+void NoiseParameterSweep::evaluateWithCPU(WorkStealingThreadPool &threadPool, std::vector<NoiseSweepStatistics> &statistics, uint32_t *atlasPixels) const
+{
+    statistics.assign(configurations.size(), NoiseSweepStatistics{});
+    auto atlasColumns = getAtlasColumns();
+    auto atlasWidth = getAtlasWidth();
+    threadPool.parallelFor(configurations.size(), [&](size_t index) {
+        auto &state = configurations[index];
+        computeVoronoiNoiseStatistics(state, 1, statistics[index]);
+
+        if(imagesEnabled && atlasPixels)
+        {
+            auto tileX = uint32_t(index % atlasColumns)*sampleWidth;
+            auto tileY = uint32_t(index / atlasColumns)*sampleHeight;
+            renderVoronoiNoiseRegion(state, 0, 0, sampleWidth, sampleHeight, atlasPixels + size_t(tileY)*atlasWidth + tileX, atlasWidth);
+        }
+    });
+}
+
+bool NoiseParameterSweep::writeStatistics(const std::string &fileName, const std::vector<NoiseSweepStatistics> &statistics) const
+{
+    FILE *file = fopen(fileName.c_str(), "w");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s for writing.\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "index,minimum,maximum,mean,histogram_minimum,histogram_maximum");
+    for(uint32_t bin = 0; bin < VoronoiNoiseHistogramBinCount; ++bin)
+        fprintf(file, ",bin%u", bin);
+    fprintf(file, "\n");
+
+    for(size_t i = 0; i < statistics.size(); ++i)
+    {
+        auto &result = statistics[i];
+        fprintf(file, "%zu,%.9g,%.9g,%.9g,%.9g,%.9g", i, result.minimum, result.maximum, result.mean, result.histogramMinimum, result.histogramMaximum);
+        for(auto count : result.histogram)
+            fprintf(file, ",%u", count);
+        fprintf(file, "\n");
+    }
+
+    bool succeeded = !ferror(file);
+    if(fclose(file) != 0)
+        succeeded = false;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the sweep statistics %s.\n", fileName.c_str());
+    return succeeded;
+}
@@ -0,0 +1,100 @@
+#ifndef SHADER_VIS_NOISE_PARAMETER_SWEEP_HPP
+#define SHADER_VIS_NOISE_PARAMETER_SWEEP_HPP
+
+#include "ScreenAndUIState.hpp"
+#include "VoronoiNoiseStatistics.hpp"
+#include "WorkStealingThreadPool.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// The statistics of a configuration, over every sample.
+typedef VoronoiNoiseStatistics NoiseSweepStatistics;
+
+/**
+ * The start of the configuration buffer of voronoiNoiseSweep.glsl, which is
+ * followed by the configurations. The atlas column count is zero when the
+ * images are not kept.
+ */
+struct NoiseSweepHeader
+{
+    uint32_t configurationCount;
+    uint32_t sampleWidth;
+    uint32_t sampleHeight;
+    uint32_t atlasColumns;
+};
+static_assert(sizeof(NoiseSweepHeader) == 16 && sizeof(ScreenAndUIState) % 16 == 0, "The sweep configurations must match their shader layout");
+
+/**
+ * Evaluates many noise configurations at once, for the tools that score
+ * them. Every configuration is sampled over the view of its scale and offset
+ * at a small fixed resolution, with the rows from top to bottom as on the
+ * screen. Only the statistics of the noise value are produced by default, and
+ * the B8G8R8A8 images are optionally laid out as the tiles of an atlas, in
+ * the order of the configurations.
+ */
+class NoiseParameterSweep
+{
+public:
+    static constexpr uint32_t DefaultSampleSize = 64;
+    static constexpr uint32_t MaxAtlasSize = 16384;
+
+    // Reads a configuration per line, as name=value assignments of the float
+    // fields that are applied over the base state. Empty lines and # comments
+    // are skipped.
+    bool loadConfigurations(const std::string &fileName, const ScreenAndUIState &baseState);
+
+    void addConfiguration(const ScreenAndUIState &state);
+
+    void setSampleSize(uint32_t width, uint32_t height);
+
+    void setImagesEnabled(bool enabled)
+    {
+        imagesEnabled = enabled;
+    }
+
+    bool areImagesEnabled() const
+    {
+        return imagesEnabled;
+    }
+
+    // The configurations, with the sample size as their screen size.
+    const std::vector<ScreenAndUIState> &getConfigurations() const
+    {
+        return configurations;
+    }
+
+    uint32_t getSampleWidth() const
+    {
+        return sampleWidth;
+    }
+
+    uint32_t getSampleHeight() const
+    {
+        return sampleHeight;
+    }
+
+    NoiseSweepHeader getHeader() const;
+
+    uint32_t getAtlasColumns() const;
+    uint32_t getAtlasWidth() const;
+    uint32_t getAtlasHeight() const;
+
+    // Whether the images of every configuration fit in an atlas of MaxAtlasSize.
+    bool doImagesFitInAtlas() const;
+
+    // Evaluates the configurations with the CPU noise evaluator, with a thread
+    // pool job per configuration. The atlas pitch is the atlas width.
+    void evaluateWithCPU(WorkStealingThreadPool &threadPool, std::vector<NoiseSweepStatistics> &statistics, uint32_t *atlasPixels) const;
+
+    // Writes a CSV line per configuration, with the statistics and the histogram bins.
+    bool writeStatistics(const std::string &fileName, const std::vector<NoiseSweepStatistics> &statistics) const;
+
+private:
+    std::vector<ScreenAndUIState> configurations;
+    uint32_t sampleWidth = DefaultSampleSize;
+    uint32_t sampleHeight = DefaultSampleSize;
+    bool imagesEnabled = false;
+};
+
+#endif //SHADER_VIS_NOISE_PARAMETER_SWEEP_HPP
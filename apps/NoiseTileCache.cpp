@@ -0,0 +1,118 @@
+#include "NoiseTileCache.hpp"
+#include <algorithm>
+#include <math.h>
+
+static constexpr int32_t InvalidTileCoordinate = INT32_MIN;
+
+// The atlas coordinates are wrapped with a mask, in the shaders and here.
+static uint32_t tileCountForPixels(uint32_t pixelCount)
+{
+    // The visible texel range has a margin of one texel on each side, and it
+    // is not aligned with the tiles.
+    auto tileCount = (pixelCount + 4 + NoiseTileCache::TileSize - 1) / NoiseTileCache::TileSize + 1;
+    uint32_t powerOfTwo = 1;
+    while(powerOfTwo < tileCount)
+        powerOfTwo <<= 1;
+    return powerOfTwo;
+}
+
+static int32_t floorToTexel(double value)
+{
+    return int32_t(floor(std::min(std::max(value, -1073741824.0), 1073741824.0)));
+}
+
+static int32_t floorDivide(int32_t value, int32_t divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+bool NoiseTileCache::setViewportSize(uint32_t width, uint32_t height)
+{
+    auto newTilesX = tileCountForPixels(width);
+    auto newTilesY = tileCountForPixels(height);
+    if(newTilesX == atlasTilesX && newTilesY == atlasTilesY)
+        return false;
+
+    atlasTilesX = newTilesX;
+    atlasTilesY = newTilesY;
+    slots.resize(size_t(atlasTilesX)*atlasTilesY);
+    invalidate();
+    return true;
+}
+
+void NoiseTileCache::invalidate()
+{
+    for(auto &slot : slots)
+        slot = TileSlot{InvalidTileCoordinate, InvalidTileCoordinate, 0};
+    refinedOctaves = 0;
+}
+
+const std::vector<NoiseTileBakeJob> &NoiseTileCache::update(const ScreenAndUIState &state)
+{
+    jobs.clear();
+    bakedTileOctaveCount = 0;
+    if(slots.empty() || state.screenWidth == 0 || state.screenHeight == 0)
+        return jobs;
+
+    auto newPixelSize = state.screenScale / float(state.screenWidth);
+    if(newPixelSize != pixelSize || state.lacunarity != lacunarity)
+    {
+        invalidate();
+        pixelSize = newPixelSize;
+        lacunarity = state.lacunarity;
+    }
+
+    // Start again from one octave when tiles must be baked from scratch.
+    auto newTargetOctaves = uint32_t(std::max(1, int(state.octaves)));
+    if(refinedOctaves == 0 || newTargetOctaves < refinedOctaves)
+        refinedOctaves = 1;
+    else
+        refinedOctaves = std::min(refinedOctaves + RefinementOctavesPerFrame, newTargetOctaves);
+    targetOctaves = newTargetOctaves;
+
+    // The view space range of the pixel centers, as computed by the screen quad shaders.
+    double width = state.screenWidth;
+    double height = state.screenHeight;
+    double scale = state.screenScale;
+    double firstViewX = (0.5/width - 0.5)*scale - state.screenOffsetX;
+    double lastViewX = ((width - 0.5)/width - 0.5)*scale - state.screenOffsetX;
+    double firstScreenCoordY = 0.5/height;
+    double lastScreenCoordY = (height - 0.5)/height;
+    if(!state.flipVertically)
+    {
+        firstScreenCoordY = -firstScreenCoordY;
+        lastScreenCoordY = -lastScreenCoordY;
+    }
+    double firstViewY = (firstScreenCoordY - 0.5)*scale*(height/width) - state.screenOffsetY;
+    double lastViewY = (lastScreenCoordY - 0.5)*scale*(height/width) - state.screenOffsetY;
+
+    auto firstTexelX = floorToTexel(std::min(firstViewX, lastViewX) / pixelSize) - 1;
+    auto lastTexelX = floorToTexel(std::max(firstViewX, lastViewX) / pixelSize) + 1;
+    auto firstTexelY = floorToTexel(std::min(firstViewY, lastViewY) / pixelSize) - 1;
+    auto lastTexelY = floorToTexel(std::max(firstViewY, lastViewY) / pixelSize) + 1;
+
+    auto firstTileX = floorDivide(firstTexelX, TileSize);
+    auto firstTileY = floorDivide(firstTexelY, TileSize);
+    auto lastTileX = std::min(floorDivide(lastTexelX, TileSize), firstTileX + int32_t(atlasTilesX) - 1);
+    auto lastTileY = std::min(floorDivide(lastTexelY, TileSize), firstTileY + int32_t(atlasTilesY) - 1);
+    for(auto tileY = firstTileY; tileY <= lastTileY; ++tileY)
+    {
+        for(auto tileX = firstTileX; tileX <= lastTileX; ++tileX)
+        {
+            auto slotIndex = (uint32_t(tileY) & (atlasTilesY - 1))*atlasTilesX + (uint32_t(tileX) & (atlasTilesX - 1));
+            auto &slot = slots[slotIndex];
+            if(slot.tileX != tileX || slot.tileY != tileY || slot.bakedOctaves > targetOctaves)
+                slot = TileSlot{tileX, tileY, 0};
+
+            if(slot.bakedOctaves >= refinedOctaves)
+                continue;
+
+            auto octaveCount = refinedOctaves - slot.bakedOctaves;
+            jobs.push_back(NoiseTileBakeJob{tileX*int32_t(TileSize), tileY*int32_t(TileSize), slot.bakedOctaves, octaveCount});
+            bakedTileOctaveCount += octaveCount;
+            slot.bakedOctaves = refinedOctaves;
+        }
+    }
+
+    return jobs;
+}
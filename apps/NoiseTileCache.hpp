@@ -0,0 +1,98 @@
+#ifndef SHADER_VIS_NOISE_TILE_CACHE_HPP
+#define SHADER_VIS_NOISE_TILE_CACHE_HPP
+
+#include "ScreenAndUIState.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * A request for the bake compute shader to add octaves to a tile of the atlas.
+ * The layout must match the std430 NoiseTileBakeJob struct of voronoiNoiseBake.glsl.
+ */
+struct NoiseTileBakeJob
+{
+    int32_t firstTexelX;
+    int32_t firstTexelY;
+    uint32_t firstOctave;
+    uint32_t octaveCount;
+};
+
+/**
+ * Bookkeeping of the atlas where the noise components are baked by a compute
+ * shader. The atlas texels are aligned with the screen pixels in view space,
+ * so texel (i, j) holds the noise at ((i + 0.5)*pixelSize, (j + 0.5)*pixelSize).
+ * A texel is stored at its view space coordinates modulo the atlas size, which
+ * makes the atlas a toroidal window over the infinite noise plane: panning
+ * keeps the tiles that remain visible and only the newly exposed tiles are
+ * baked.
+ *
+ * The components are stored before being weighted by the Voronoi factors,
+ * the amplitude and the thresholds, so the cache only depends on the pixel
+ * size and the lacunarity. After one of them changes, every tile is baked with
+ * one octave, and the following frames add octaves until the requested count
+ * is reached.
+ */
+class NoiseTileCache
+{
+public:
+    static constexpr uint32_t TileSize = 64;
+    static constexpr uint32_t RefinementOctavesPerFrame = 1;
+
+    // Returns true when the atlas size changed, and a new atlas texture must be created.
+    bool setViewportSize(uint32_t width, uint32_t height);
+
+    uint32_t getAtlasWidth() const
+    {
+        return atlasTilesX*TileSize;
+    }
+
+    uint32_t getAtlasHeight() const
+    {
+        return atlasTilesY*TileSize;
+    }
+
+    // Forgets all the baked tiles, e.g. after the bake shader was reloaded.
+    void invalidate();
+
+    // Computes the tiles that must be baked before drawing a frame with the state.
+    const std::vector<NoiseTileBakeJob> &update(const ScreenAndUIState &state);
+
+    // Whether every visible tile has all the requested octaves.
+    bool isComplete() const
+    {
+        return refinedOctaves == targetOctaves;
+    }
+
+    uint32_t getRefinedOctaves() const
+    {
+        return refinedOctaves;
+    }
+
+    // The sum of the tile octaves of the latest update.
+    size_t getBakedTileOctaveCount() const
+    {
+        return bakedTileOctaveCount;
+    }
+
+private:
+    struct TileSlot
+    {
+        int32_t tileX;
+        int32_t tileY;
+        uint32_t bakedOctaves;
+    };
+
+    std::vector<TileSlot> slots;
+    std::vector<NoiseTileBakeJob> jobs;
+    uint32_t atlasTilesX = 0;
+    uint32_t atlasTilesY = 0;
+
+    float pixelSize = 0;
+    float lacunarity = 0;
+    uint32_t targetOctaves = 0;
+    uint32_t refinedOctaves = 0;
+    size_t bakedTileOctaveCount = 0;
+};
+
+#endif //SHADER_VIS_NOISE_TILE_CACHE_HPP
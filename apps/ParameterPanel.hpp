@@ -0,0 +1,39 @@
+#ifndef SHADER_VIS_PARAMETER_PANEL_HPP
+#define SHADER_VIS_PARAMETER_PANEL_HPP
+
+#include "ImmediateUI.hpp"
+#include "ScreenAndUIState.hpp"
+
+/**
+ * The sliders that edit the noise parameters, laid out in four rows.
+ */
+inline void parameterPanel(ImmediateUI &ui, ScreenAndUIState &state, float x = 5, float y = 5)
+{
+    ui.beginLayout(x, y);
+    ui.sliderForFloat("F1", -1, 1, state.voronoiF1);
+    ui.sliderForFloat("F2", -1, 1, state.voronoiF2);
+    ui.sliderForFloat("F3", -1, 1, state.voronoiF3);
+    ui.sliderForFloat("F4", -1, 1, state.voronoiF4);
+
+    ui.advanceLayoutRow();
+    ui.sliderForFloat("Amplitude", 0, 2, state.amplitude);
+    ui.sliderForFloat("Lacunarity", 0, 5, state.lacunarity);
+    ui.sliderForFloat("Octaves", 1, 8, state.octaves);
+
+    ui.advanceLayoutRow();
+    ui.sliderForFloat("S", -1, 1, state.startThreshold);
+    ui.sliderForFloat("R", 0, 1, state.startColorRed);
+    ui.sliderForFloat("G", 0, 1, state.startColorGreen);
+    ui.sliderForFloat("B", 0, 1, state.startColorBlue);
+
+    ui.advanceLayoutRow();
+    ui.sliderForFloat("E", -1, 1, state.endThreshold);
+    ui.sliderForFloat("R", 0, 1, state.endColorRed);
+    ui.sliderForFloat("G", 0, 1, state.endColorGreen);
+    ui.sliderForFloat("B", 0, 1, state.endColorBlue);
+}
+
+// The number of widgets that are emitted by parameterPanel.
+static constexpr size_t ParameterPanelWidgetCount = 15;
+
+#endif //SHADER_VIS_PARAMETER_PANEL_HPP
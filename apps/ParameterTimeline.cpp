@@ -0,0 +1,193 @@
+#include "ParameterTimeline.hpp"
+#include <stdio.h>
+#include <algorithm>
+
+static bool parseInterpolation(const char *name, TimelineInterpolation &interpolation)
+{
+    if(!strcmp(name, "step"))
+        interpolation = TimelineInterpolation::Step;
+    else if(!strcmp(name, "linear"))
+        interpolation = TimelineInterpolation::Linear;
+    else if(!strcmp(name, "smooth"))
+        interpolation = TimelineInterpolation::Smooth;
+    else if(!strcmp(name, "cubic"))
+        interpolation = TimelineInterpolation::Cubic;
+    else
+        return false;
+    return true;
+}
+
+bool ParameterTimeline::loadFromFile(const std::string &fileName)
+{
+    FILE *file = fopen(fileName.c_str(), "r");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open the timeline %s\n", fileName.c_str());
+        return false;
+    }
+
+    char line[1024];
+    size_t lineNumber = 0;
+    bool succeeded = true;
+    while(fgets(line, sizeof(line), file))
+    {
+        ++lineNumber;
+        if(!parseLine(line))
+        {
+            fprintf(stderr, "%s:%zu: invalid timeline keyframe.\n", fileName.c_str(), lineNumber);
+            succeeded = false;
+            break;
+        }
+    }
+
+    fclose(file);
+    return succeeded;
+}
+
+bool ParameterTimeline::parseLine(const char *line)
+{
+    // Split the line into the tokens before the comment.
+    std::vector<std::string> tokens;
+    std::string token;
+    for(auto c = line; ; ++c)
+    {
+        if(*c == 0 || *c == '#' || *c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+        {
+            if(!token.empty())
+                tokens.push_back(token);
+            token.clear();
+            if(*c == 0 || *c == '#')
+                break;
+            continue;
+        }
+
+        token += *c;
+    }
+
+    if(tokens.empty())
+        return true;
+
+    char *timeEnd = nullptr;
+    auto time = strtof(tokens[0].c_str(), &timeEnd);
+    if(*timeEnd != 0 || time < 0 || tokens.size() < 2)
+        return false;
+
+    // The interpolation may be given after the assignments.
+    auto interpolation = TimelineInterpolation::Linear;
+    auto assignmentCount = tokens.size() - 1;
+    if(tokens.back().find('=') == std::string::npos)
+    {
+        if(!parseInterpolation(tokens.back().c_str(), interpolation))
+            return false;
+        --assignmentCount;
+    }
+
+    for(size_t i = 1; i <= assignmentCount; ++i)
+    {
+        auto &assignment = tokens[i];
+        auto separator = assignment.find('=');
+        if(separator == std::string::npos)
+            return false;
+
+        auto name = assignment.substr(0, separator);
+        if(!addKeyframe(name.c_str(), time, float(atof(assignment.c_str() + separator + 1)), interpolation))
+            return false;
+    }
+
+    return true;
+}
+
+bool ParameterTimeline::addKeyframe(const char *fieldName, float time, float value, TimelineInterpolation interpolation)
+{
+    const ScreenAndUIStateFloatField *field = nullptr;
+    for(auto &candidate : ScreenAndUIStateFloatFields)
+    {
+        if(!strcmp(candidate.name, fieldName))
+            field = &candidate;
+    }
+    if(!field)
+        return false;
+
+    auto track = std::find_if(tracks.begin(), tracks.end(), [&](const Track &track) {
+        return track.member == field->member;
+    });
+    if(track == tracks.end())
+    {
+        tracks.push_back(Track{field->member, {}});
+        track = tracks.end() - 1;
+    }
+
+    // The keyframes stay sorted by time, and a keyframe at the same time is replaced.
+    auto &keyframes = track->keyframes;
+    auto position = std::lower_bound(keyframes.begin(), keyframes.end(), time, [](const TimelineKeyframe &keyframe, float time) {
+        return keyframe.time < time;
+    });
+    TimelineKeyframe keyframe{time, value, interpolation};
+    if(position != keyframes.end() && position->time == time)
+        *position = keyframe;
+    else
+        keyframes.insert(position, keyframe);
+    return true;
+}
+
+float ParameterTimeline::getDuration() const
+{
+    float duration = 0;
+    for(auto &track : tracks)
+        duration = std::max(duration, track.keyframes.back().time);
+    return duration;
+}
+
+void ParameterTimeline::evaluate(float time, ScreenAndUIState &state) const
+{
+    for(auto &track : tracks)
+        state.*track.member = evaluateTrack(track, time);
+}
+
+float ParameterTimeline::evaluateTrack(const Track &track, float time)
+{
+    auto &keyframes = track.keyframes;
+    if(time <= keyframes.front().time)
+        return keyframes.front().value;
+    if(time >= keyframes.back().time)
+        return keyframes.back().value;
+
+    // The segment [keyframes[index], keyframes[index + 1]) contains the time.
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](float time, const TimelineKeyframe &keyframe) {
+        return time < keyframe.time;
+    });
+    auto index = size_t(next - keyframes.begin()) - 1;
+    auto &start = keyframes[index];
+    auto &end = keyframes[index + 1];
+    auto alpha = (time - start.time) / (end.time - start.time);
+    switch(start.interpolation)
+    {
+    case TimelineInterpolation::Step:
+        return start.value;
+    case TimelineInterpolation::Smooth:
+        alpha = alpha*alpha*(3.0f - 2.0f*alpha);
+        return start.value + (end.value - start.value)*alpha;
+    case TimelineInterpolation::Cubic:
+        {
+            // The tangents are the slopes between the neighbor keyframes, per
+            // second, so that the velocity stays continuous across keyframes
+            // with uneven spacing. The missing neighbors at the ends are
+            // extrapolated linearly, which gives the slope of the segment.
+            auto duration = end.time - start.time;
+            auto segmentSlope = (end.value - start.value) / duration;
+            auto startSlope = index > 0 ?
+                (end.value - keyframes[index - 1].value) / (end.time - keyframes[index - 1].time) : segmentSlope;
+            auto endSlope = index + 2 < keyframes.size() ?
+                (keyframes[index + 2].value - start.value) / (keyframes[index + 2].time - start.time) : segmentSlope;
+            auto alpha2 = alpha*alpha;
+            auto alpha3 = alpha2*alpha;
+            return (2.0f*alpha3 - 3.0f*alpha2 + 1.0f)*start.value +
+                (alpha3 - 2.0f*alpha2 + alpha)*startSlope*duration +
+                (3.0f*alpha2 - 2.0f*alpha3)*end.value +
+                (alpha3 - alpha2)*endSlope*duration;
+        }
+    case TimelineInterpolation::Linear:
+    default:
+        return start.value + (end.value - start.value)*alpha;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef SHADER_VIS_PARAMETER_TIMELINE_HPP
+#define SHADER_VIS_PARAMETER_TIMELINE_HPP
+
+#include "ScreenAndUIState.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * How a field moves from a keyframe to the next one.
+ */
+enum class TimelineInterpolation
+{
+    // Keeps the value until the next keyframe.
+    Step = 0,
+    Linear,
+
+    // Eases in and out of each keyframe.
+    Smooth,
+
+    // Catmull-Rom spline through the neighbor keyframes, with the tangents
+    // scaled by the keyframe spacing, which keeps the velocity continuous.
+    Cubic,
+};
+
+/**
+ * A value of a field at a time, in seconds. The interpolation applies to the
+ * segment that starts at this keyframe.
+ */
+struct TimelineKeyframe
+{
+    float time;
+    float value;
+    TimelineInterpolation interpolation;
+};
+
+/**
+ * Keyframe animation of the float fields of ScreenAndUIState, by name. The
+ * fields without keyframes keep the value of the state that is animated. A
+ * timeline is read from a text file where each line holds a time followed by
+ * name=value assignments, and optionally an interpolation, e.g.
+ *
+ *     # time  assignments                     interpolation
+ *     0       voronoiF1=1 voronoiF2=0         smooth
+ *     2.5     voronoiF1=0 voronoiF2=1 octaves=4
+ */
+class ParameterTimeline
+{
+public:
+    bool loadFromFile(const std::string &fileName);
+
+    // Parses a line of the file format. Empty lines and comments are accepted.
+    bool parseLine(const char *line);
+
+    bool addKeyframe(const char *fieldName, float time, float value, TimelineInterpolation interpolation = TimelineInterpolation::Linear);
+
+    bool isEmpty() const
+    {
+        return tracks.empty();
+    }
+
+    // The time of the last keyframe.
+    float getDuration() const;
+
+    // Writes the value of every animated field at the time into the state.
+    void evaluate(float time, ScreenAndUIState &state) const;
+
+private:
+    struct Track
+    {
+        float ScreenAndUIState::*member;
+        std::vector<TimelineKeyframe> keyframes;
+    };
+
+    static float evaluateTrack(const Track &track, float time);
+
+    std::vector<Track> tracks;
+};
+
+#endif //SHADER_VIS_PARAMETER_TIMELINE_HPP
@@ -0,0 +1,205 @@
+#include "PersistentRingBuffer.hpp"
+#include <stdio.h>
+#include <algorithm>
+
+PersistentRingBuffer::~PersistentRingBuffer()
+{
+    retireBuffer();
+    for(auto &retired : retiredBuffers)
+        releaseRetiredBuffer(retired);
+}
+
+bool PersistentRingBuffer::initialize(const agpu_device_ref &newDevice, size_t initialCapacity, size_t frameSlotCount)
+{
+    device = newDevice;
+    persistentlyMapped = device->isFeatureSupported(AGPU_FEATURE_PERSISTENT_MEMORY_MAPPING) &&
+        device->isFeatureSupported(AGPU_FEATURE_COHERENT_MEMORY_MAPPING);
+    frameMarkers.resize(frameSlotCount);
+    return createBuffer(initialCapacity);
+}
+
+bool PersistentRingBuffer::createBuffer(size_t newCapacity)
+{
+    newCapacity = (newCapacity + DefaultAlignment - 1) & ~(DefaultAlignment - 1);
+
+    agpu_buffer_description desc = {};
+    desc.size = agpu_size(newCapacity);
+    desc.heap_type = AGPU_MEMORY_HEAP_TYPE_HOST_TO_DEVICE;
+    desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_UNIFORM_BUFFER | AGPU_STORAGE_BUFFER);
+    desc.main_usage_mode = AGPU_UNIFORM_BUFFER;
+    if(persistentlyMapped)
+        desc.mapping_flags = AGPU_MAP_WRITE_BIT | AGPU_MAP_PERSISTENT_BIT | AGPU_MAP_COHERENT_BIT;
+    else
+        desc.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+
+    auto newBuffer = device->createBuffer(&desc, nullptr);
+    if(!newBuffer)
+    {
+        fprintf(stderr, "Failed to create a ring buffer of %zu bytes.\n", newCapacity);
+        return false;
+    }
+
+    uint8_t *newMappedMemory = nullptr;
+    if(persistentlyMapped)
+    {
+        newMappedMemory = reinterpret_cast<uint8_t*> (newBuffer->mapBuffer(AGPU_WRITE_ONLY));
+        if(!newMappedMemory)
+        {
+            fprintf(stderr, "Failed to map the ring buffer.\n");
+            return false;
+        }
+    }
+
+    retireBuffer();
+    buffer = newBuffer;
+    mappedMemory = newMappedMemory;
+    if(!persistentlyMapped)
+    {
+        shadowMemory.resize(newCapacity);
+        mappedMemory = shadowMemory.data();
+    }
+
+    capacity = newCapacity;
+    head = 0;
+    tail = 0;
+    liveBytes = 0;
+    currentFrameBytes = 0;
+    for(auto &marker : frameMarkers)
+        marker = FrameMarker();
+    return true;
+}
+
+void PersistentRingBuffer::retireBuffer()
+{
+    if(!buffer)
+        return;
+
+    // The frames in flight may still read the old buffer, and the current
+    // frame may still write into the allocations that it already obtained.
+    retiredBuffers.push_back(RetiredBuffer{buffer, std::move(shadowMemory), frameMarkers.size()});
+    shadowMemory = std::vector<uint8_t> ();
+    buffer.reset();
+    mappedMemory = nullptr;
+}
+
+void PersistentRingBuffer::releaseRetiredBuffer(RetiredBuffer &retired)
+{
+    if(persistentlyMapped)
+        retired.buffer->unmapBuffer();
+    retired.buffer.reset();
+}
+
+void PersistentRingBuffer::beginFrame(size_t frameSlot)
+{
+    auto &marker = frameMarkers[frameSlot];
+    if(marker.isValid)
+    {
+        // Frames finish in order, so the oldest live data ends with this frame.
+        tail = marker.endOffset;
+        liveBytes -= marker.consumedBytes;
+        marker.isValid = false;
+        if(liveBytes == 0)
+            head = tail = 0;
+    }
+
+    for(auto &retired : retiredBuffers)
+    {
+        if(--retired.remainingFrames == 0)
+            releaseRetiredBuffer(retired);
+    }
+    retiredBuffers.erase(std::remove_if(retiredBuffers.begin(), retiredBuffers.end(), [](const RetiredBuffer &retired) {
+        return retired.remainingFrames == 0;
+    }), retiredBuffers.end());
+}
+
+void PersistentRingBuffer::endFrame(size_t frameSlot)
+{
+    auto &marker = frameMarkers[frameSlot];
+    marker.isValid = true;
+    marker.endOffset = head;
+    marker.consumedBytes = currentFrameBytes;
+    currentFrameBytes = 0;
+
+    for(auto &upload : pendingUploads)
+    {
+        if(upload.size > 0)
+            upload.buffer->uploadBufferData(upload.offset, upload.size, upload.source);
+    }
+    pendingUploads.clear();
+}
+
+bool PersistentRingBuffer::tryAllocate(size_t size, size_t alignment, size_t &offset)
+{
+    // head == tail with live data means that the ring is full.
+    if(liveBytes > 0 && head == tail)
+        return false;
+
+    size_t alignedHead = (head + alignment - 1) & ~(alignment - 1);
+    size_t consumed = 0;
+    if(liveBytes == 0 || head > tail)
+    {
+        // Free space in [head, capacity) and in [0, tail).
+        if(alignedHead + size <= capacity)
+        {
+            offset = alignedHead;
+            consumed = alignedHead + size - head;
+        }
+        else if(size <= tail)
+        {
+            offset = 0;
+            consumed = capacity - head + size;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Free space in [head, tail).
+        if(alignedHead + size > tail)
+            return false;
+        offset = alignedHead;
+        consumed = alignedHead + size - head;
+    }
+
+    head = offset + size;
+    liveBytes += consumed;
+    currentFrameBytes += consumed;
+    return true;
+}
+
+PersistentRingBuffer::Allocation PersistentRingBuffer::allocate(size_t size, size_t alignment)
+{
+    Allocation allocation;
+    size_t offset = 0;
+    if(!tryAllocate(size, alignment, offset))
+    {
+        // Grow instead of overwriting the data of the frames in flight.
+        auto newCapacity = std::max(capacity*2, size*frameMarkers.size() + DefaultAlignment);
+        if(!createBuffer(newCapacity) || !tryAllocate(size, alignment, offset))
+            return allocation;
+    }
+
+    allocation.buffer = buffer;
+    allocation.offset = offset;
+    allocation.size = size;
+    allocation.pointer = mappedMemory + offset;
+    if(!persistentlyMapped)
+        pendingUploads.push_back(PendingUpload{buffer, allocation.pointer, offset, size});
+    return allocation;
+}
+
+void PersistentRingBuffer::shrinkLastAllocation(Allocation &allocation, size_t newSize)
+{
+    if(allocation.buffer != buffer || allocation.offset + allocation.size != head || newSize >= allocation.size)
+        return;
+
+    auto releasedBytes = allocation.size - newSize;
+    head -= releasedBytes;
+    liveBytes -= releasedBytes;
+    currentFrameBytes -= releasedBytes;
+    allocation.size = newSize;
+    if(!pendingUploads.empty() && pendingUploads.back().source == allocation.pointer)
+        pendingUploads.back().size = newSize;
+}
@@ -0,0 +1,103 @@
+#ifndef SHADER_VIS_PERSISTENT_RING_BUFFER_HPP
+#define SHADER_VIS_PERSISTENT_RING_BUFFER_HPP
+
+#include "AGPU/agpu.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Linear ring allocator for per frame data, over a host to device buffer that
+ * stays mapped for the whole lifetime of the allocator. The CPU writes the
+ * per frame uniforms directly into the mapped memory, and the memory of a
+ * frame is reclaimed once the fence of that frame has been waited on.
+ *
+ * When an allocation does not fit, a larger buffer is created. The old buffer
+ * is kept alive until the frames that reference it have finished. On devices
+ * without persistent mapping, the allocations are written into a CPU shadow
+ * copy that is uploaded at the end of the frame.
+ */
+class PersistentRingBuffer
+{
+public:
+    static constexpr size_t DefaultAlignment = 256;
+
+    struct Allocation
+    {
+        agpu_buffer_ref buffer;
+        size_t offset = 0;
+        size_t size = 0;
+        uint8_t *pointer = nullptr;
+    };
+
+    ~PersistentRingBuffer();
+
+    bool initialize(const agpu_device_ref &device, size_t capacity, size_t frameSlotCount);
+
+    size_t getCapacity() const
+    {
+        return capacity;
+    }
+
+    bool isPersistentlyMapped() const
+    {
+        return persistentlyMapped;
+    }
+
+    // Reclaims the memory that was used by the frame slot. Its fence must have been waited on.
+    void beginFrame(size_t frameSlot);
+
+    // Records the allocations of the current frame in the frame slot, and uploads the shadow copy if needed.
+    void endFrame(size_t frameSlot);
+
+    // The returned allocation is only valid until the end of the frame.
+    Allocation allocate(size_t size, size_t alignment = DefaultAlignment);
+
+    // Returns the unused end of the latest allocation to the ring.
+    void shrinkLastAllocation(Allocation &allocation, size_t newSize);
+
+private:
+    struct FrameMarker
+    {
+        bool isValid = false;
+        size_t endOffset = 0;
+        size_t consumedBytes = 0;
+    };
+
+    struct RetiredBuffer
+    {
+        agpu_buffer_ref buffer;
+        std::vector<uint8_t> shadowMemory;
+        size_t remainingFrames;
+    };
+
+    struct PendingUpload
+    {
+        agpu_buffer_ref buffer;
+        uint8_t *source;
+        size_t offset;
+        size_t size;
+    };
+
+    bool createBuffer(size_t newCapacity);
+    void retireBuffer();
+    void releaseRetiredBuffer(RetiredBuffer &retired);
+    bool tryAllocate(size_t size, size_t alignment, size_t &offset);
+
+    agpu_device_ref device;
+    agpu_buffer_ref buffer;
+    uint8_t *mappedMemory = nullptr;
+    std::vector<uint8_t> shadowMemory;
+    bool persistentlyMapped = false;
+
+    size_t capacity = 0;
+    size_t head = 0;
+    size_t tail = 0;
+    size_t liveBytes = 0;
+    size_t currentFrameBytes = 0;
+    std::vector<FrameMarker> frameMarkers;
+    std::vector<RetiredBuffer> retiredBuffers;
+    std::vector<PendingUpload> pendingUploads;
+};
+
+#endif //SHADER_VIS_PERSISTENT_RING_BUFFER_HPP
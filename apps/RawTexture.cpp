@@ -0,0 +1,90 @@
+#include "RawTexture.hpp"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t getPixelByteSize(RawTextureFormat format)
+{
+    switch(format)
+    {
+    case RawTextureFormat::BGRA8: return 4;
+    default: return 0;
+    }
+}
+
+std::string getRawTextureFileName(const std::string &imageFileName)
+{
+    auto dotPosition = imageFileName.rfind('.');
+    auto separatorPosition = imageFileName.find_last_of("/\\");
+    if(dotPosition == std::string::npos || (separatorPosition != std::string::npos && dotPosition < separatorPosition))
+        return imageFileName + ".bgra8";
+    return imageFileName.substr(0, dotPosition) + ".bgra8";
+}
+
+bool parseRawTexture(const uint8_t *data, size_t size, RawTextureView &view)
+{
+    RawTextureHeader header;
+    if(size < sizeof(header))
+        return false;
+
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != RawTextureHeader::Magic || header.version != RawTextureHeader::CurrentVersion)
+        return false;
+
+    auto pixelSize = getPixelByteSize(RawTextureFormat(header.format));
+    if(pixelSize == 0 || header.width == 0 || header.height == 0 ||
+        header.pitch < uint64_t(header.width)*pixelSize ||
+        header.dataSize != uint64_t(header.pitch)*header.height ||
+        uint64_t(header.dataOffset) + header.dataSize > size)
+        return false;
+
+    view.format = RawTextureFormat(header.format);
+    view.width = header.width;
+    view.height = header.height;
+    view.pitch = header.pitch;
+    view.pixels = data + header.dataOffset;
+    return true;
+}
+
+bool encodeRawTexture(RawTextureFormat format, uint32_t width, uint32_t height, uint32_t pitch, const void *pixels, std::vector<uint8_t> &encoded)
+{
+    auto pixelSize = getPixelByteSize(format);
+    if(pixelSize == 0 || pitch < width*pixelSize)
+        return false;
+
+    RawTextureHeader header = {};
+    header.magic = RawTextureHeader::Magic;
+    header.version = RawTextureHeader::CurrentVersion;
+    header.format = uint32_t(format);
+    header.width = width;
+    header.height = height;
+    header.pitch = pitch;
+    header.dataOffset = (sizeof(header) + RawTextureHeader::DataAlignment - 1) & ~(RawTextureHeader::DataAlignment - 1);
+    header.dataSize = pitch*height;
+
+    encoded.assign(header.dataOffset + header.dataSize, 0);
+    memcpy(encoded.data(), &header, sizeof(header));
+    memcpy(encoded.data() + header.dataOffset, pixels, header.dataSize);
+    return true;
+}
+
+bool writeRawTexture(const std::string &fileName, RawTextureFormat format, uint32_t width, uint32_t height, uint32_t pitch, const void *pixels)
+{
+    std::vector<uint8_t> encoded;
+    if(!encodeRawTexture(format, width, height, pitch, pixels, encoded))
+        return false;
+
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s for writing.\n", fileName.c_str());
+        return false;
+    }
+
+    bool succeeded = fwrite(encoded.data(), encoded.size(), 1, file) == 1;
+    if(fclose(file) != 0)
+        succeeded = false;
+
+    if(!succeeded)
+        fprintf(stderr, "Failed to write the raw texture %s.\n", fileName.c_str());
+    return succeeded;
+}
@@ -0,0 +1,57 @@
+#ifndef SHADER_VIS_RAW_TEXTURE_HPP
+#define SHADER_VIS_RAW_TEXTURE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum class RawTextureFormat : uint32_t
+{
+    BGRA8 = 1,
+};
+
+/**
+ * Header of a texture whose pixels are stored in the layout of the device
+ * texture, so that they are uploaded straight from the mapped file without any
+ * decoding or conversion. The rows are stored from top to bottom, and the
+ * pixels start at dataOffset.
+ */
+struct RawTextureHeader
+{
+    static constexpr uint32_t Magic = 0x58545653; // "SVTX"
+    static constexpr uint32_t CurrentVersion = 1;
+    static constexpr uint32_t DataAlignment = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t dataOffset;
+    uint32_t dataSize;
+};
+
+/**
+ * The pixels of a raw texture, pointing into the memory of its file.
+ */
+struct RawTextureView
+{
+    RawTextureFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    const uint8_t *pixels;
+};
+
+// The name of the raw texture that is converted from an image file, e.g. font.bmp -> font.bgra8.
+std::string getRawTextureFileName(const std::string &imageFileName);
+
+// Validates the header of a mapped raw texture, and returns a view of its pixels.
+bool parseRawTexture(const uint8_t *data, size_t size, RawTextureView &view);
+
+bool encodeRawTexture(RawTextureFormat format, uint32_t width, uint32_t height, uint32_t pitch, const void *pixels, std::vector<uint8_t> &encoded);
+bool writeRawTexture(const std::string &fileName, RawTextureFormat format, uint32_t width, uint32_t height, uint32_t pitch, const void *pixels);
+
+#endif //SHADER_VIS_RAW_TEXTURE_HPP
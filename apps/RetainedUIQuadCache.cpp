@@ -0,0 +1,168 @@
+#include "RetainedUIQuadCache.hpp"
+#include <algorithm>
+
+// Past this number of ranges per frame slot, the ranges are merged into one.
+static constexpr size_t MaxDirtyRangesPerFrameSlot = 16;
+
+RetainedUIQuadCache::RetainedUIQuadCache(size_t frameSlotCount)
+{
+    setFrameSlotCount(frameSlotCount);
+}
+
+void RetainedUIQuadCache::setFrameSlotCount(size_t frameSlotCount)
+{
+    dirtyRanges.resize(frameSlotCount);
+    for(size_t i = 0; i < frameSlotCount; ++i)
+        markFrameSlotFullyDirty(i);
+}
+
+void RetainedUIQuadCache::setPackedQuadsEnabled(bool enabled)
+{
+    packedQuadsEnabled = enabled;
+    if(!enabled)
+    {
+        packedQuads = std::vector<PackedUIElementQuad> ();
+        return;
+    }
+
+    packedQuads.resize(quads.size());
+    packQuads(0, quads.size());
+}
+
+void RetainedUIQuadCache::beginFrame()
+{
+    currentWidgetIndex = 0;
+    regeneratedWidgetCount = 0;
+}
+
+bool RetainedUIQuadCache::beginWidget(const UIWidgetKey &key)
+{
+    if(currentWidgetIndex < widgets.size() && widgets[currentWidgetIndex].key == key)
+    {
+        ++currentWidgetIndex;
+        return false;
+    }
+
+    if(currentWidgetIndex == widgets.size())
+    {
+        Widget widget;
+        widget.firstQuad = quads.size();
+        widgets.push_back(widget);
+    }
+
+    widgets[currentWidgetIndex].key = key;
+    generatedQuads.clear();
+    isGeneratingWidget = true;
+    ++regeneratedWidgetCount;
+    return true;
+}
+
+void RetainedUIQuadCache::addQuad(const UIElementQuad &quad)
+{
+    if(isGeneratingWidget)
+        generatedQuads.push_back(quad);
+}
+
+UIElementQuad *RetainedUIQuadCache::allocateQuads(size_t count)
+{
+    if(!isGeneratingWidget)
+        return nullptr;
+
+    auto first = generatedQuads.size();
+    generatedQuads.resize(first + count);
+    return generatedQuads.data() + first;
+}
+
+void RetainedUIQuadCache::endWidget()
+{
+    if(!isGeneratingWidget)
+        return;
+
+    isGeneratingWidget = false;
+    auto &widget = widgets[currentWidgetIndex++];
+    auto first = quads.begin() + widget.firstQuad;
+    if(generatedQuads.size() == widget.quadCount)
+    {
+        // Same size, so the other widgets are not affected.
+        std::copy(generatedQuads.begin(), generatedQuads.end(), first);
+        markDirty(widget.firstQuad, widget.firstQuad + widget.quadCount);
+        packQuads(widget.firstQuad, widget.firstQuad + widget.quadCount);
+        return;
+    }
+
+    // The following widgets move.
+    quads.erase(first, first + widget.quadCount);
+    quads.insert(quads.begin() + widget.firstQuad, generatedQuads.begin(), generatedQuads.end());
+
+    auto delta = ptrdiff_t(generatedQuads.size()) - ptrdiff_t(widget.quadCount);
+    widget.quadCount = generatedQuads.size();
+    for(size_t i = currentWidgetIndex; i < widgets.size(); ++i)
+        widgets[i].firstQuad += delta;
+
+    markDirty(widget.firstQuad, quads.size());
+    packQuads(widget.firstQuad, quads.size());
+}
+
+void RetainedUIQuadCache::endFrame()
+{
+    if(currentWidgetIndex >= widgets.size())
+        return;
+
+    // The remaining quads are simply not drawn anymore.
+    quads.resize(widgets[currentWidgetIndex].firstQuad);
+    widgets.resize(currentWidgetIndex);
+    if(packedQuadsEnabled)
+        packedQuads.resize(quads.size());
+}
+
+void RetainedUIQuadCache::clearDirtyRanges(size_t frameSlot)
+{
+    dirtyRanges[frameSlot].clear();
+}
+
+void RetainedUIQuadCache::markFrameSlotFullyDirty(size_t frameSlot)
+{
+    auto &ranges = dirtyRanges[frameSlot];
+    ranges.clear();
+    ranges.push_back(UIQuadRange{0, quads.size()});
+}
+
+void RetainedUIQuadCache::markDirty(size_t begin, size_t end)
+{
+    if(begin >= end)
+        return;
+
+    for(auto &ranges : dirtyRanges)
+    {
+        if(!ranges.empty() && begin <= ranges.back().end && ranges.back().begin <= end)
+        {
+            ranges.back().begin = std::min(ranges.back().begin, begin);
+            ranges.back().end = std::max(ranges.back().end, end);
+        }
+        else if(ranges.size() < MaxDirtyRangesPerFrameSlot)
+        {
+            ranges.push_back(UIQuadRange{begin, end});
+        }
+        else
+        {
+            UIQuadRange merged{begin, end};
+            for(auto &range : ranges)
+            {
+                merged.begin = std::min(merged.begin, range.begin);
+                merged.end = std::max(merged.end, range.end);
+            }
+            ranges.clear();
+            ranges.push_back(merged);
+        }
+    }
+}
+
+void RetainedUIQuadCache::packQuads(size_t begin, size_t end)
+{
+    if(!packedQuadsEnabled)
+        return;
+
+    packedQuads.resize(quads.size());
+    if(begin < end)
+        packUIElementQuads(&quads[begin], end - begin, &packedQuads[begin]);
+}
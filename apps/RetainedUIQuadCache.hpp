@@ -0,0 +1,127 @@
+#ifndef SHADER_VIS_RETAINED_UI_QUAD_CACHE_HPP
+#define SHADER_VIS_RETAINED_UI_QUAD_CACHE_HPP
+
+#include "UIElementQuad.hpp"
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * The inputs that fully determine the quads that are generated by a widget.
+ */
+struct UIWidgetKey
+{
+    std::string label;
+    float x = 0, y = 0;
+    float value = 0;
+    float minValue = 0;
+    float maxValue = 0;
+
+    bool operator==(const UIWidgetKey &other) const
+    {
+        return x == other.x && y == other.y &&
+            value == other.value && minValue == other.minValue && maxValue == other.maxValue &&
+            label == other.label;
+    }
+
+    bool operator!=(const UIWidgetKey &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+/**
+ * A range of quads, expressed in quad indices.
+ */
+struct UIQuadRange
+{
+    size_t begin;
+    size_t end;
+};
+
+/**
+ * Retained layer below the immediate UI. The widgets are identified by their
+ * order in the frame, and the quads of a widget are only generated again when
+ * its key changes. All the quads are kept in one array with the layout of the
+ * UI data buffer, and the modified quad ranges are tracked separately for
+ * each frame slot, so that every copy of the buffer only receives the bytes
+ * that changed since it was last used. Optionally, the quads are also kept
+ * in their packed encoding, and only the modified ones are packed again.
+ */
+class RetainedUIQuadCache
+{
+public:
+    explicit RetainedUIQuadCache(size_t frameSlotCount = 1);
+
+    void setFrameSlotCount(size_t frameSlotCount);
+
+    // Keeps a packed copy of the quads, which is updated together with the dirty ranges.
+    void setPackedQuadsEnabled(bool enabled);
+
+    void beginFrame();
+
+    // Returns true when the quads of the widget must be generated with addQuad.
+    bool beginWidget(const UIWidgetKey &key);
+    void addQuad(const UIElementQuad &quad);
+
+    // Reserves count consecutive quads of the current widget, to be written by the caller.
+    // Returns nullptr when the widget is not being generated.
+    UIElementQuad *allocateQuads(size_t count);
+    void endWidget();
+
+    // Drops the widgets that were not visited during this frame.
+    void endFrame();
+
+    const std::vector<UIElementQuad> &getQuads() const
+    {
+        return quads;
+    }
+
+    const std::vector<PackedUIElementQuad> &getPackedQuads() const
+    {
+        return packedQuads;
+    }
+
+    size_t getQuadCount() const
+    {
+        return quads.size();
+    }
+
+    size_t getRegeneratedWidgetCount() const
+    {
+        return regeneratedWidgetCount;
+    }
+
+    // The ranges that changed since the frame slot was last synchronized.
+    const std::vector<UIQuadRange> &getDirtyRanges(size_t frameSlot) const
+    {
+        return dirtyRanges[frameSlot];
+    }
+
+    void clearDirtyRanges(size_t frameSlot);
+    void markFrameSlotFullyDirty(size_t frameSlot);
+
+private:
+    struct Widget
+    {
+        UIWidgetKey key;
+        size_t firstQuad = 0;
+        size_t quadCount = 0;
+    };
+
+    void markDirty(size_t begin, size_t end);
+    void packQuads(size_t begin, size_t end);
+
+    std::vector<Widget> widgets;
+    std::vector<UIElementQuad> quads;
+    std::vector<UIElementQuad> generatedQuads;
+    std::vector<PackedUIElementQuad> packedQuads;
+    bool packedQuadsEnabled = false;
+    std::vector<std::vector<UIQuadRange>> dirtyRanges;
+
+    size_t currentWidgetIndex = 0;
+    bool isGeneratingWidget = false;
+    size_t regeneratedWidgetCount = 0;
+};
+
+#endif //SHADER_VIS_RETAINED_UI_QUAD_CACHE_HPP
@@ -0,0 +1,116 @@
+#ifndef SHADER_VIS_SCREEN_AND_UI_STATE_HPP
+#define SHADER_VIS_SCREEN_AND_UI_STATE_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The shader visible state. The layout must match the std140
+ * ScreenAndUIStateBlock uniform block that is declared in the shaders.
+ */
+struct ScreenAndUIState
+{
+    uint32_t screenWidth = 640;
+    uint32_t screenHeight = 480;
+
+    uint32_t flipVertically = false;
+    float screenScale = 10.0f;
+
+    float screenOffsetX = 0.0f;
+    float screenOffsetY = 0.0f;
+
+    float startThreshold = 0.0;
+    float endThreshold = 1.0;
+
+    float amplitude = 1.0;
+    float octaves = 1.0;
+    float lacunarity = 1.478;
+
+    // The fraction of the screen size that the noise pass is rendered at, with
+    // dynamic resolution. It is written into the uniforms of each frame.
+    float resolutionScale = 1.0;
+
+    float voronoiF1 = 1;
+    float voronoiF2 = 0;
+    float voronoiF3 = 0;
+    float voronoiF4 = 0;
+
+    float startColorRed = 0;
+    float startColorGreen = 0;
+    float startColorBlue = 0;
+    float startColorAlpha = 1;
+
+    float endColorRed = 1;
+    float endColorGreen = 1;
+    float endColorBlue = 1;
+    float endColorAlpha = 1;
+};
+
+/**
+ * Named access to the float parameters of the state, for the command line
+ * and the batch tools.
+ */
+struct ScreenAndUIStateFloatField
+{
+    const char *name;
+    float ScreenAndUIState::*member;
+};
+
+inline constexpr ScreenAndUIStateFloatField ScreenAndUIStateFloatFields[] = {
+    {"screenScale", &ScreenAndUIState::screenScale},
+    {"screenOffsetX", &ScreenAndUIState::screenOffsetX},
+    {"screenOffsetY", &ScreenAndUIState::screenOffsetY},
+    {"startThreshold", &ScreenAndUIState::startThreshold},
+    {"endThreshold", &ScreenAndUIState::endThreshold},
+    {"amplitude", &ScreenAndUIState::amplitude},
+    {"octaves", &ScreenAndUIState::octaves},
+    {"lacunarity", &ScreenAndUIState::lacunarity},
+    {"voronoiF1", &ScreenAndUIState::voronoiF1},
+    {"voronoiF2", &ScreenAndUIState::voronoiF2},
+    {"voronoiF3", &ScreenAndUIState::voronoiF3},
+    {"voronoiF4", &ScreenAndUIState::voronoiF4},
+    {"startColorRed", &ScreenAndUIState::startColorRed},
+    {"startColorGreen", &ScreenAndUIState::startColorGreen},
+    {"startColorBlue", &ScreenAndUIState::startColorBlue},
+    {"startColorAlpha", &ScreenAndUIState::startColorAlpha},
+    {"endColorRed", &ScreenAndUIState::endColorRed},
+    {"endColorGreen", &ScreenAndUIState::endColorGreen},
+    {"endColorBlue", &ScreenAndUIState::endColorBlue},
+    {"endColorAlpha", &ScreenAndUIState::endColorAlpha},
+};
+
+inline float *findScreenAndUIStateFloatField(ScreenAndUIState &state, const char *name)
+{
+    for(auto &field : ScreenAndUIStateFloatFields)
+    {
+        if(!strcmp(field.name, name))
+            return &(state.*field.member);
+    }
+
+    return nullptr;
+}
+
+// Parses a name=value assignment of a float field.
+inline bool parseScreenAndUIStateAssignment(ScreenAndUIState &state, const char *assignment)
+{
+    auto separator = strchr(assignment, '=');
+    if(!separator)
+        return false;
+
+    char name[64];
+    size_t nameLength = size_t(separator - assignment);
+    if(nameLength >= sizeof(name))
+        return false;
+    memcpy(name, assignment, nameLength);
+    name[nameLength] = 0;
+
+    auto field = findScreenAndUIStateFloatField(state, name);
+    if(!field)
+        return false;
+
+    *field = float(atof(separator + 1));
+    return true;
+}
+
+#endif //SHADER_VIS_SCREEN_AND_UI_STATE_HPP
@@ -0,0 +1,198 @@
+#include "ShaderBinaryCache.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <atomic>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr uint32_t ShaderBinaryCacheMagic = 0x42535653; // SVSB
+static constexpr uint32_t ShaderBinaryCacheVersion = 1;
+
+struct ShaderBinaryCacheEntryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+{
+    // FNV-1a
+    auto bytes = reinterpret_cast<const uint8_t*> (data);
+    for(size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static constexpr uint64_t HashSeed = 0xcbf29ce484222325ull;
+
+// Distinguishes the temporary files of the threads of this process.
+static std::atomic<uint32_t> temporaryFileCount;
+
+static bool createDirectory(const std::string &path)
+{
+#ifdef _WIN32
+    auto result = _mkdir(path.c_str());
+#else
+    auto result = mkdir(path.c_str(), 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+bool ShaderBinaryCache::setDirectory(const std::string &newDirectory)
+{
+    directory = newDirectory;
+    if(directory.empty())
+        return true;
+
+    if(!createDirectory(directory))
+    {
+        fprintf(stderr, "Failed to create the shader cache directory %s, the shader cache is disabled.\n", directory.c_str());
+        directory.clear();
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t ShaderBinaryCache::computeKey(const char *source, size_t sourceSize, int shaderType) const
+{
+    // The lengths separate the fields, so that moving bytes from one field to
+    // the next changes the key.
+    uint64_t identityLength = deviceIdentity.size();
+    uint64_t sourceLength = sourceSize;
+    int32_t type = shaderType;
+
+    auto hash = hashBytes(HashSeed, &ShaderBinaryCacheVersion, sizeof(ShaderBinaryCacheVersion));
+    hash = hashBytes(hash, &identityLength, sizeof(identityLength));
+    hash = hashBytes(hash, deviceIdentity.data(), deviceIdentity.size());
+    hash = hashBytes(hash, &type, sizeof(type));
+    hash = hashBytes(hash, &sourceLength, sizeof(sourceLength));
+    return hashBytes(hash, source, sourceSize);
+}
+
+std::string ShaderBinaryCache::getEntryFileName(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return directory + "/" + name;
+}
+
+bool ShaderBinaryCache::load(uint64_t key, std::vector<uint8_t> &binary)
+{
+    if(!isEnabled())
+        return false;
+
+    if(rebuildEnabled)
+    {
+        countLoad(false, false);
+        return false;
+    }
+
+    auto file = fopen(getEntryFileName(key).c_str(), "rb");
+    if(!file)
+    {
+        countLoad(false, false);
+        return false;
+    }
+
+    // The stored size must account for the rest of the file, so that a
+    // corrupt header never makes us allocate more than the file holds.
+    long fileLength = -1;
+    if(fseek(file, 0, SEEK_END) == 0)
+        fileLength = ftell(file);
+    rewind(file);
+
+    ShaderBinaryCacheEntryHeader header;
+    bool isValid = fileLength >= long(sizeof(header)) &&
+        fread(&header, sizeof(header), 1, file) == 1 &&
+        header.magic == ShaderBinaryCacheMagic &&
+        header.version == ShaderBinaryCacheVersion &&
+        header.key == key &&
+        header.size > 0 &&
+        header.size == uint64_t(fileLength) - sizeof(header);
+    if(isValid)
+    {
+        binary.resize(size_t(header.size));
+        isValid = fread(binary.data(), binary.size(), 1, file) == 1 &&
+            hashBytes(HashSeed, binary.data(), binary.size()) == header.checksum;
+    }
+    fclose(file);
+
+    if(!isValid)
+    {
+        binary.clear();
+        countLoad(false, true);
+        return false;
+    }
+
+    countLoad(true, false);
+    return true;
+}
+
+void ShaderBinaryCache::countLoad(bool isHit, bool isRejected)
+{
+    std::unique_lock<std::mutex> lock(statisticsMutex);
+    if(isHit)
+        ++statistics.hits;
+    else
+        ++statistics.misses;
+    if(isRejected)
+        ++statistics.rejectedEntries;
+}
+
+bool ShaderBinaryCache::store(uint64_t key, const std::vector<uint8_t> &binary)
+{
+    if(!isEnabled() || binary.empty())
+        return false;
+
+    // Write into a temporary file first, so that a concurrent or interrupted
+    // run never observes a partial entry. The name is unique per process and
+    // thread, so that concurrent writers of the same entry do not share it.
+    auto fileName = getEntryFileName(key);
+    auto temporaryFileName = fileName + "." + std::to_string(getpid()) + "." +
+        std::to_string(temporaryFileCount++) + ".tmp";
+    auto file = fopen(temporaryFileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to write the shader cache entry %s\n", temporaryFileName.c_str());
+        return false;
+    }
+
+    ShaderBinaryCacheEntryHeader header = {};
+    header.magic = ShaderBinaryCacheMagic;
+    header.version = ShaderBinaryCacheVersion;
+    header.key = key;
+    header.size = binary.size();
+    header.checksum = hashBytes(HashSeed, binary.data(), binary.size());
+
+    bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(binary.data(), binary.size(), 1, file) == 1;
+    succeeded = fclose(file) == 0 && succeeded;
+
+    // rename does not replace an existing file on Windows.
+    remove(fileName.c_str());
+    if(!succeeded || rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+        fprintf(stderr, "Failed to write the shader cache entry %s\n", fileName.c_str());
+        remove(temporaryFileName.c_str());
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(statisticsMutex);
+    ++statistics.stores;
+    return true;
+}
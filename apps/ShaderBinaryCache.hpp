@@ -0,0 +1,74 @@
+#ifndef SHADER_VIS_SHADER_BINARY_CACHE_HPP
+#define SHADER_VIS_SHADER_BINARY_CACHE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * The counters of a shader binary cache.
+ */
+struct ShaderBinaryCacheStatistics
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t stores = 0;
+    uint32_t rejectedEntries = 0;
+};
+
+/**
+ * On-disk cache of compiled device shaders. An entry is keyed by a hash of the
+ * device identity, the shader type and the shader source text, so that any
+ * change to one of them selects a different entry. Each entry is a small file
+ * whose header repeats the key and carries a checksum of the binary, so that
+ * a truncated or foreign file is treated as a miss instead of being given to
+ * the driver. Loads and stores may run concurrently once the cache is set up.
+ */
+class ShaderBinaryCache
+{
+public:
+    // Creates the directory if needed. An empty directory disables the cache.
+    bool setDirectory(const std::string &newDirectory);
+
+    bool isEnabled() const
+    {
+        return !directory.empty();
+    }
+
+    // The platform, device and shader language that produced the binaries.
+    void setDeviceIdentity(const std::string &identity)
+    {
+        deviceIdentity = identity;
+    }
+
+    // Ignores the existing entries, and replaces them with the new binaries.
+    void setRebuildEnabled(bool enabled)
+    {
+        rebuildEnabled = enabled;
+    }
+
+    uint64_t computeKey(const char *source, size_t sourceSize, int shaderType) const;
+
+    bool load(uint64_t key, std::vector<uint8_t> &binary);
+    bool store(uint64_t key, const std::vector<uint8_t> &binary);
+
+    ShaderBinaryCacheStatistics getStatistics() const
+    {
+        std::unique_lock<std::mutex> lock(statisticsMutex);
+        return statistics;
+    }
+
+private:
+    std::string getEntryFileName(uint64_t key) const;
+    void countLoad(bool isHit, bool isRejected);
+
+    std::string directory;
+    std::string deviceIdentity;
+    bool rebuildEnabled = false;
+    mutable std::mutex statisticsMutex;
+    ShaderBinaryCacheStatistics statistics;
+};
+
+#endif //SHADER_VIS_SHADER_BINARY_CACHE_HPP
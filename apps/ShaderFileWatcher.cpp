@@ -0,0 +1,105 @@
+#include "ShaderFileWatcher.hpp"
+#include <stdio.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+ShaderFileWatcher::~ShaderFileWatcher()
+{
+#ifdef __linux__
+    if(inotifyDescriptor >= 0)
+        close(inotifyDescriptor);
+#endif
+}
+
+int64_t ShaderFileWatcher::getModificationTime(const std::string &path)
+{
+    struct stat fileStat;
+    if(stat(path.c_str(), &fileStat) != 0)
+        return 0;
+    return int64_t(fileStat.st_mtime);
+}
+
+bool ShaderFileWatcher::watch(const std::string &directory, const std::vector<std::string> &fileNames)
+{
+    watchedDirectory = directory;
+    watchedFiles.clear();
+    for(auto &name : fileNames)
+    {
+        WatchedFile file;
+        file.name = name;
+        file.modificationTime = getModificationTime(directory + "/" + name);
+        watchedFiles.push_back(file);
+    }
+
+#ifdef __linux__
+    inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotifyDescriptor < 0 ||
+        inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        // The modification times are polled instead.
+        fprintf(stderr, "Failed to watch %s with inotify, polling it instead.\n", directory.c_str());
+        if(inotifyDescriptor >= 0)
+            close(inotifyDescriptor);
+        inotifyDescriptor = -1;
+    }
+#endif
+    return true;
+}
+
+void ShaderFileWatcher::addChangedFile(const std::string &name, std::vector<std::string> &changedFiles)
+{
+    auto path = watchedDirectory + "/" + name;
+    if(std::find(changedFiles.begin(), changedFiles.end(), path) == changedFiles.end())
+        changedFiles.push_back(path);
+}
+
+void ShaderFileWatcher::pollChangedFiles(std::vector<std::string> &changedFiles)
+{
+    if(!isWatching())
+        return;
+
+#ifdef __linux__
+    if(inotifyDescriptor >= 0)
+    {
+        alignas(struct inotify_event) char buffer[4096];
+        for(;;)
+        {
+            auto readSize = read(inotifyDescriptor, buffer, sizeof(buffer));
+            if(readSize <= 0)
+                break;
+
+            for(ssize_t offset = 0; offset < readSize; )
+            {
+                auto event = reinterpret_cast<const struct inotify_event*> (buffer + offset);
+                offset += sizeof(struct inotify_event) + event->len;
+                if(event->len == 0)
+                    continue;
+
+                std::string name = event->name;
+                for(auto &file : watchedFiles)
+                {
+                    if(file.name == name)
+                        addChangedFile(name, changedFiles);
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for(auto &file : watchedFiles)
+    {
+        auto modificationTime = getModificationTime(watchedDirectory + "/" + file.name);
+        if(modificationTime != file.modificationTime)
+        {
+            file.modificationTime = modificationTime;
+            addChangedFile(file.name, changedFiles);
+        }
+    }
+}
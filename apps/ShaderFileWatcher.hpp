@@ -0,0 +1,49 @@
+#ifndef SHADER_VIS_SHADER_FILE_WATCHER_HPP
+#define SHADER_VIS_SHADER_FILE_WATCHER_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Reports the files of a directory that have been modified. On Linux the
+ * directory is watched with inotify, so polling only costs a non blocking
+ * read. Elsewhere, the modification time of the watched files is compared on
+ * each poll.
+ */
+class ShaderFileWatcher
+{
+public:
+    ShaderFileWatcher() = default;
+    ~ShaderFileWatcher();
+
+    ShaderFileWatcher(const ShaderFileWatcher &) = delete;
+    ShaderFileWatcher &operator=(const ShaderFileWatcher &) = delete;
+
+    // The file names are relative to the directory.
+    bool watch(const std::string &directory, const std::vector<std::string> &fileNames);
+
+    bool isWatching() const
+    {
+        return !watchedDirectory.empty();
+    }
+
+    // Appends the paths of the watched files that changed since the last poll, without blocking.
+    void pollChangedFiles(std::vector<std::string> &changedFiles);
+
+private:
+    struct WatchedFile
+    {
+        std::string name;
+        int64_t modificationTime = 0;
+    };
+
+    static int64_t getModificationTime(const std::string &path);
+    void addChangedFile(const std::string &name, std::vector<std::string> &changedFiles);
+
+    std::string watchedDirectory;
+    std::vector<WatchedFile> watchedFiles;
+    int inotifyDescriptor = -1;
+};
+
+#endif //SHADER_VIS_SHADER_FILE_WATCHER_HPP
@@ -1,69 +1,171 @@
 #include "SDL.h"
 #include "SDL_syswm.h"
 #include "AGPU/agpu.hpp"
+#include "AssetBundle.hpp"
+#include "BenchmarkReport.hpp"
+#include "FrameProfiler.hpp"
+#include "ImmediateUI.hpp"
+#include "ParameterPanel.hpp"
+#include "DenseTextOverlay.hpp"
+#include "DynamicResolutionController.hpp"
+#include "ImageWriter.hpp"
+#include "MappedFile.hpp"
+#include "NoiseMapExporter.hpp"
+#include "NoiseParameterSweep.hpp"
+#include "NoiseTileCache.hpp"
+#include "PersistentRingBuffer.hpp"
+#include "RawTexture.hpp"
+#include "ShaderBinaryCache.hpp"
+#include "ShaderFileWatcher.hpp"
+#include "ScreenAndUIState.hpp"
+#include "TiledNoiseRasterizer.hpp"
+#include "TimelineRenderer.hpp"
+#include "UIElementQuad.hpp"
+#include "VoronoiNoiseVariant.hpp"
+#include "VoronoiNoiseCellTable.hpp"
+#include "VoronoiNoiseStatistics.hpp"
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
-struct ScreenAndUIState
-{
-    uint32_t screenWidth = 640;
-    uint32_t screenHeight = 480;
-
-    uint32_t flipVertically = false;
-    float screenScale = 10.0f;
+static constexpr size_t MaxFramesInFlight = 3;
+static constexpr size_t FrameTimeHistorySize = 240;
 
-    float screenOffsetX = 0.0f;
-    float screenOffsetY = 0.0f;
+// The workgroup size of voronoiNoiseStatistics.glsl, in samples on each side.
+static constexpr uint32_t NoiseStatisticsWorkgroupSide = 16;
 
-    float startThreshold = 0.0;
-    float endThreshold = 1.0;
+// The workgroup size of voronoiNoiseCellTable.glsl, in cells.
+static constexpr uint32_t NoiseCellTableWorkgroupSize = 64;
 
-    float amplitude = 1.0;
-    float octaves = 1.0;
-    float lacunarity = 1.478;
-    float reserved;
-
-    float voronoiF1 = 1;
-    float voronoiF2 = 0;
-    float voronoiF3 = 0;
-    float voronoiF4 = 0;
+/**
+ * The resources that are used by a frame while it is being executed by the GPU.
+ */
+struct FrameResources
+{
+    agpu_command_allocator_ref commandAllocator;
+    agpu_command_list_ref commandList;
+    agpu_fence_ref fence;
+    agpu_shader_resource_binding_ref dataBinding;
+    agpu_buffer_ref uiDataBuffer;
+    size_t uiDataBufferCapacity = 0;
+    size_t noiseTileBakeJobCount = 0;
+
+    // The viewport statistics are read back when the frame slot is reused.
+    agpu_buffer_ref noiseStatisticsPartialBuffer;
+    agpu_buffer_ref noiseStatisticsBuffer;
+    bool isNoiseStatisticsRequested = false;
+    bool isNoiseStatisticsPending = false;
+
+    // The feature points of the cell table, and the header that they were
+    // last filled for, so that they are only hashed again when it changes.
+    agpu_buffer_ref noiseCellTablePointsBuffer;
+    VoronoiNoiseCellTableHeader noiseCellTableHeader = {};
+    bool isNoiseCellTableUsed = false;
+    bool isNoiseCellTableFillRequested = false;
+    bool isInFlight = false;
+};
 
-    float startColorRed = 0;
-    float startColorGreen = 0;
-    float startColorBlue = 0;
-    float startColorAlpha = 1;
+/**
+ * An offscreen frame of the batched timeline rendering. Each frame of a
+ * submission has its own state uniforms, so it has its own binding.
+ */
+struct TimelineFrameTarget
+{
+    agpu_texture_ref colorBuffer;
+    agpu_framebuffer_ref framebuffer;
+    agpu_shader_resource_binding_ref dataBinding;
+};
 
-    float endColorRed = 1;
-    float endColorGreen = 1;
-    float endColorBlue = 1;
-    float endColorAlpha = 1;
+/**
+ * A shader of the startup pipelines, compiled on the pipeline compilation thread pool.
+ */
+struct ShaderCompileJob
+{
+    const char *fileName = nullptr;
+    agpu_shader_type type;
+    size_t pipelineJobIndex = 0;
+    agpu_shader_ref *target = nullptr;
+    double seconds = 0;
+    bool isCached = false;
 };
 
-struct UIElementQuad
+/**
+ * A startup pipeline, which is built by the thread that compiles its last shader.
+ */
+struct PipelineBuildJob
 {
-    float x, y;
-    float width, height;
+    const char *name = nullptr;
+    agpu_pipeline_state_ref *target = nullptr;
+    std::atomic<uint32_t> pendingShaderCount;
+    agpu_pipeline_state_ref pipeline;
+    double buildSeconds = 0;
+    double readySeconds = 0;
+    bool isEnabled = true;
+    bool hasFailed = false;
+    std::atomic<bool> isFinished;
+};
 
-    float r, g, b, a;
+enum PipelineBuildJobIndex
+{
+    ScreenQuadPipelineJob = 0,
+    UIPipelineJob,
+    NoiseBakePipelineJob,
+    CachedScreenQuadPipelineJob,
+    UpscalePipelineJob,
+    NoiseSweepPipelineJob,
+    NoiseStatisticsPipelineJob,
+    NoiseStatisticsResolvePipelineJob,
+    NoiseCellTablePipelineJob,
+    PipelineBuildJobCount
+};
 
-    uint32_t isGlyph;
-    uint32_t reserved[3];
+/**
+ * The outcome of recompiling the shaders of a pipeline after one of its source files changed.
+ */
+struct ShaderReloadResult
+{
+    size_t pipelineJobIndex = 0;
+    agpu_shader_ref vertexShader;
+    agpu_shader_ref fragmentShader;
+    agpu_shader_ref computeShader;
+    agpu_pipeline_state_ref pipeline;
+    std::string errorLog;
+};
 
-    float fontX, fontY;
-    float fontWidth, fontHeight;
+/**
+ * A replaced pipeline, which is kept alive until the frames that used it have finished.
+ */
+struct RetiredPipeline
+{
+    agpu_pipeline_state_ref pipeline;
+    size_t remainingFrames;
 };
 
 class ShaderVis
 {
 public:
     ShaderVis() = default;
-    ~ShaderVis() = default;
+    ~ShaderVis()
+    {
+        if(pipelineCompilationThread.joinable())
+            pipelineCompilationThread.join();
+        if(shaderReloadThread.joinable())
+            shaderReloadThread.join();
+        if(noiseVariantBuildThread.joinable())
+            noiseVariantBuildThread.join();
+    }
 
     int main(int argc, const char *argv[])
     {
+        startupStartCounter = lastStartupStageCounter = SDL_GetPerformanceCounter();
+
         bool vsyncDisabled = false;
         bool debugLayerEnabled = false;
     #ifdef _DEBUG
@@ -71,6 +173,8 @@ public:
     #endif
         agpu_uint platformIndex = 0;
         agpu_uint gpuIndex = 0;
+        std::string shaderCacheDirectory = "shader-cache";
+        bool shaderCacheRebuildEnabled = false;
         for (int i = 1; i < argc; ++i)
         {
             std::string arg = argv[i];
@@ -90,26 +194,236 @@ public:
             {
                 debugLayerEnabled = true;
             }
+            else if (arg == "-frames-in-flight" && i + 1 < argc)
+            {
+                framesInFlightCount = std::min(std::max(size_t(atoi(argv[++i])), size_t(1)), MaxFramesInFlight);
+            }
+            else if (arg == "-continuous-redraw")
+            {
+                continuousRedrawEnabled = true;
+            }
+            else if (arg == "-target-ms" && i + 1 < argc)
+            {
+                dynamicResolution.setTargetSeconds(std::max(0.0f, float(atof(argv[++i]))) / 1000.0f);
+            }
+            else if (arg == "-report-frame-time")
+            {
+                frameTimeReportEnabled = true;
+            }
+            else if (arg == "-headless" && i + 1 < argc)
+            {
+                unsigned int width = 0, height = 0;
+                if(sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+                {
+                    fprintf(stderr, "Invalid headless size %s, expected WxH.\n", argv[i]);
+                    return 1;
+                }
+
+                isHeadless = true;
+                screenAndUIState.screenWidth = width;
+                screenAndUIState.screenHeight = height;
+            }
+            else if (arg == "-out" && i + 1 < argc)
+            {
+                headlessOutputFileName = argv[++i];
+            }
+            else if (arg == "-export" && i + 1 < argc)
+            {
+                exportFileName = argv[++i];
+            }
+            else if (arg == "-export-channels" && i + 1 < argc)
+            {
+                std::string channels = argv[++i];
+                if(channels == "color")
+                {
+                    exportChannels = NoiseMapChannels::Color;
+                }
+                else if(channels == "components")
+                {
+                    exportChannels = NoiseMapChannels::Components;
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown export channels %s, expected color or components.\n", channels.c_str());
+                    return 1;
+                }
+            }
+            else if (arg == "-export-tile" && i + 1 < argc)
+            {
+                exportTileSize = uint32_t(std::max(16, atoi(argv[++i]))) & ~15u;
+            }
+            else if (arg == "-sweep" && i + 1 < argc)
+            {
+                sweepFileName = argv[++i];
+            }
+            else if (arg == "-sweep-out" && i + 1 < argc)
+            {
+                sweepOutputFileName = argv[++i];
+            }
+            else if (arg == "-sweep-images" && i + 1 < argc)
+            {
+                sweepImagesFileName = argv[++i];
+            }
+            else if (arg == "-sweep-size" && i + 1 < argc)
+            {
+                if(sscanf(argv[++i], "%ux%u", &sweepSampleWidth, &sweepSampleHeight) != 2 || sweepSampleWidth == 0 || sweepSampleHeight == 0)
+                {
+                    fprintf(stderr, "Invalid sweep sample size %s, expected WxH.\n", argv[i]);
+                    return 1;
+                }
+            }
+            else if (arg == "-timeline" && i + 1 < argc)
+            {
+                if(!timeline.loadFromFile(argv[++i]))
+                    return 1;
+            }
+            else if (arg == "-render-timeline" && i + 1 < argc)
+            {
+                timelineOutputFileName = argv[++i];
+            }
+            else if (arg == "-fps" && i + 1 < argc)
+            {
+                timelineFramesPerSecond = uint32_t(std::max(1, atoi(argv[++i])));
+            }
+            else if (arg == "-frames-per-submit" && i + 1 < argc)
+            {
+                timelineFramesPerSubmit = size_t(std::max(1, atoi(argv[++i])));
+            }
+            else if (arg == "-convert-texture" && i + 2 < argc)
+            {
+                std::string inputFileName = argv[++i];
+                std::string outputFileName = argv[++i];
+                return convertTextureMain(inputFileName, outputFileName);
+            }
+            else if (arg == "-asset-bundle" && i + 1 < argc)
+            {
+                assetBundleFileName = argv[++i];
+            }
+            else if (arg == "-no-asset-bundle")
+            {
+                assetBundleFileName.clear();
+            }
+            else if (arg == "-pack-assets" && i + 1 < argc)
+            {
+                packedAssetBundleFileName = argv[++i];
+                while(i + 1 < argc && argv[i + 1][0] != '-')
+                    packedAssetFileNames.push_back(argv[++i]);
+            }
+            else if (arg == "-pack-shader-binaries")
+            {
+                packedShaderBinariesEnabled = true;
+            }
+            else if (arg == "-full-ui-quads")
+            {
+                packedUIQuadsEnabled = false;
+            }
+            else if (arg == "-bench-dense-text")
+            {
+                denseTextBenchmarkEnabled = true;
+            }
+            else if (arg == "-cpu")
+            {
+                cpuRenderingForced = true;
+            }
+            else if (arg == "-shader-cache" && i + 1 < argc)
+            {
+                shaderCacheDirectory = argv[++i];
+            }
+            else if (arg == "-no-shader-cache")
+            {
+                shaderCacheDirectory.clear();
+            }
+            else if (arg == "-rebuild-shader-cache")
+            {
+                shaderCacheRebuildEnabled = true;
+            }
+            else if (arg == "-no-hot-reload")
+            {
+                hotReloadEnabled = false;
+            }
+            else if (arg == "-noise-cache")
+            {
+                noiseTileCacheEnabled = true;
+            }
+            else if (arg == "-no-noise-cache")
+            {
+                noiseTileCacheEnabled = false;
+            }
+            else if (arg == "-no-shader-variants")
+            {
+                noiseVariantsEnabled = false;
+            }
+            else if (arg == "-bench-variants")
+            {
+                noiseVariantBenchmarkEnabled = true;
+            }
+            else if (arg == "-cell-table")
+            {
+                noiseCellTableEnabled = true;
+            }
+            else if (arg == "-bench-cell-table")
+            {
+                noiseCellTableBenchmarkEnabled = true;
+            }
+            else if (arg == "-auto-range")
+            {
+                autoRangeEnabled = true;
+            }
+            else if (arg == "-profile")
+            {
+                frameTimeGraphVisible = true;
+            }
+            else if (arg == "-trace-out" && i + 1 < argc)
+            {
+                traceOutputFileName = argv[++i];
+            }
+            else if (arg == "-bench-frames" && i + 1 < argc)
+            {
+                benchmarkFrameCount = size_t(std::max(0, atoi(argv[++i])));
+            }
+            else if (arg == "-bench-json" && i + 1 < argc)
+            {
+                benchmarkJSONFileName = argv[++i];
+            }
+            else if (arg == "-report-startup")
+            {
+                startupReportEnabled = true;
+            }
+            else if (arg == "-param" && i + 1 < argc)
+            {
+                if(!parseScreenAndUIStateAssignment(screenAndUIState, argv[++i]))
+                {
+                    fprintf(stderr, "Invalid parameter assignment %s.\n", argv[i]);
+                    return 1;
+                }
+            }
         }
 
+        FrameProfiler::get().setEnabled(frameTimeGraphVisible || !traceOutputFileName.empty());
+        FrameProfiler::get().setCurrentThreadName("Main");
+        shaderBinaryCache.setDirectory(shaderCacheDirectory);
+        shaderBinaryCache.setRebuildEnabled(shaderCacheRebuildEnabled);
+
+        if(!packedAssetBundleFileName.empty())
+            return packAssetsMain(platformIndex, gpuIndex, debugLayerEnabled);
+
+        // The whole bundle is mapped at once, and the assets that it lacks are read from their files.
+        if(!assetBundleFileName.empty() && MappedFile::exists(assetBundleFileName) && assetBundle.open(assetBundleFileName))
+            markStartupStage("Asset bundle");
+
+        if(!exportFileName.empty())
+            return exportMain(platformIndex, gpuIndex, debugLayerEnabled);
+        if(!sweepFileName.empty())
+            return sweepMain(platformIndex, gpuIndex, debugLayerEnabled);
+        if(!timelineOutputFileName.empty())
+            return renderTimelineMain(platformIndex, gpuIndex, debugLayerEnabled);
+        if(isHeadless)
+            return headlessMain(platformIndex, gpuIndex, debugLayerEnabled);
+
         // Get the platform.
-        agpu_uint numPlatforms;
-        agpuGetPlatforms(0, nullptr, &numPlatforms);
-        if (numPlatforms == 0)
-        {
-            fprintf(stderr, "No agpu platforms are available.\n");
-            return 1;
-        }
-        else if (platformIndex >= numPlatforms)
-        {
-            fprintf(stderr, "Selected platform index is not available.\n");
+        auto platform = getPlatform(platformIndex);
+        if(!platform)
             return 1;
-        }
-
-        std::vector<agpu_platform*> platforms;
-        platforms.resize(numPlatforms);
-        agpuGetPlatforms(numPlatforms, &platforms[0], nullptr);
-        auto platform = platforms[platformIndex];
 
         printf("Choosen platform: %s\n", agpuGetPlatformName(platform));
 
@@ -120,9 +434,12 @@ public:
         if(!window)
         {
             fprintf(stderr, "Failed to create window.\n");
+            SDL_Quit();
             return 1;
         }
 
+        markStartupStage("Window");
+
         // Get the window info.
         SDL_SysWMinfo windowInfo;
         SDL_VERSION(&windowInfo.version);
@@ -153,13 +470,13 @@ public:
     #endif
         default:
             fprintf(stderr, "Unsupported window system\n");
-            return -1;
+            return destroyWindowAndQuit(-1);
         }
 
         currentSwapChainCreateInfo.colorbuffer_format = colorBufferFormat;
         currentSwapChainCreateInfo.width = screenAndUIState.screenWidth;
         currentSwapChainCreateInfo.height = screenAndUIState.screenHeight;
-        currentSwapChainCreateInfo.buffer_count = 3;
+        currentSwapChainCreateInfo.buffer_count = std::max(framesInFlightCount, size_t(3));
         currentSwapChainCreateInfo.flags = AGPU_SWAP_CHAIN_FLAG_APPLY_SCALE_FACTOR_FOR_HI_DPI;
         if (vsyncDisabled)
         {
@@ -171,7 +488,7 @@ public:
         if(!device)
         {
             fprintf(stderr, "Failed to open the device\n");
-            return false;
+            return destroyWindowAndQuit(1);
         }
 
         // Get the default command queue
@@ -182,12 +499,116 @@ public:
         if(!swapChain)
         {
             fprintf(stderr, "Failed to create the swap chain\n");
-            return false;
+            return destroyWindowAndQuit(1);
         }
 
         displayWidth = swapChain->getWidth();
         displayHeight = swapChain->getHeight();
+        setShaderCacheDeviceIdentity(platform, gpuIndex);
+        markStartupStage("Device and swap chain");
+
+        if(!createDeviceResources())
+            return destroyWindowAndQuit(1);
+
+        // Main loop
+        int exitCode = 0;
+        auto oldCounter = SDL_GetPerformanceCounter();
+        frameTimeReportStartCounter = oldCounter;
+        frameTimeReportStartCPUSeconds = FrameProfiler::getProcessCPUSeconds();
+        while(!isQuitting)
+        {
+            // Block until something happens, instead of drawing the same frame again.
+            processEvents(needsRedraw() ? 0 : IdleEventTimeoutMilliseconds);
+            if(!adoptFinishedPipelines())
+            {
+                exitCode = 1;
+                break;
+            }
+            if(arePipelinesReady && hotReloadEnabled)
+                updateShaderHotReload();
+
+            if(!needsRedraw())
+            {
+                // The idle time is not part of the next frame.
+                oldCounter = SDL_GetPerformanceCounter();
+                if(frameTimeReportEnabled)
+                    reportFrameTime(false);
+                continue;
+            }
+
+            SHADER_VIS_PROFILE_ZONE("Frame");
+            auto newCounter = SDL_GetPerformanceCounter();
+            auto deltaTime = float(double(newCounter - oldCounter) / double(SDL_GetPerformanceFrequency()));
+            oldCounter = newCounter;
+            if(isDynamicResolutionActive())
+                dynamicResolution.update(deltaTime, lastFrameWaitSeconds > GPUBoundWaitSeconds);
+            recordFrameTime(deltaTime);
+
+            // Until the pipelines are ready, the frame only contains what can already be drawn.
+            updateAndRender(deltaTime);
+            redrawRequested = false;
+            lastDrawnState = screenAndUIState;
+            if(startupReportEnabled)
+            {
+                if(!hasPresentedFirstFrame)
+                    markStartupStage("First frame");
+                hasPresentedFirstFrame = true;
+                if(arePipelinesReady)
+                {
+                    markStartupStage("First complete frame");
+                    reportStartupTimes();
+                    startupReportEnabled = false;
+                }
+            }
+            if(frameTimeReportEnabled)
+                reportFrameTime(true);
+        }
+
+        return destroyWindowAndQuit(exitCode);
+    }
+
+    // The cleanup of the windowed mode, for its normal exit and for the
+    // failures after the window is created.
+    int destroyWindowAndQuit(int exitCode)
+    {
+        if(commandQueue)
+            commandQueue->finishExecution();
+        swapChain.reset();
+        commandQueue.reset();
+
+        if(!traceOutputFileName.empty())
+            FrameProfiler::get().writeChromeTrace(traceOutputFileName);
+
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return exitCode;
+    }
+
+    agpu_platform *getPlatform(agpu_uint platformIndex, bool quiet = false)
+    {
+        agpu_uint numPlatforms;
+        agpuGetPlatforms(0, nullptr, &numPlatforms);
+        if (numPlatforms == 0)
+        {
+            if(!quiet)
+                fprintf(stderr, "No agpu platforms are available.\n");
+            return nullptr;
+        }
+        else if (platformIndex >= numPlatforms)
+        {
+            if(!quiet)
+                fprintf(stderr, "Selected platform index is not available.\n");
+            return nullptr;
+        }
+
+        std::vector<agpu_platform*> platforms;
+        platforms.resize(numPlatforms);
+        agpuGetPlatforms(numPlatforms, &platforms[0], nullptr);
+        return platforms[platformIndex];
+    }
 
+    bool createDeviceResources()
+    {
         // Create the render pass
         {
             agpu_renderpass_color_attachment_description colorAttachment = {};
@@ -219,10 +640,19 @@ public:
             builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_UNIFORM_BUFFER, 1); // Screen and UI state
             builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // UI Data
             builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLED_IMAGE, 1); // Bitmap font
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_IMAGE, 1); // Noise tile atlas, or the sweep images
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Noise tile bake jobs
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_SAMPLED_IMAGE, 1); // Scaled noise
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Sweep configurations
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Sweep statistics
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Partial noise statistics
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Noise statistics
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Noise cell table header
+            builder->addBindingBankElement(AGPU_SHADER_BINDING_TYPE_STORAGE_BUFFER, 1); // Noise cell table points
 
             shaderSignature = builder->build();
             if(!shaderSignature)
-                return 1;
+                return false;
         }
 
         // Samplers binding
@@ -236,160 +666,1359 @@ public:
             if(!sampler)
             {
                 fprintf(stderr, "Failed to create the sampler.\n");
-                return 1;
+                return false;
             }
 
             samplersBinding = shaderSignature->createShaderResourceBinding(0);
             samplersBinding->bindSampler(0, sampler);
         }
 
-        // Screen and UI State buffer
+        // Screen and UI State ring buffer
         {
-            agpu_buffer_description desc = {};
-            desc.size = (sizeof(ScreenAndUIState) + 255) & (-256);
-            desc.heap_type = AGPU_MEMORY_HEAP_TYPE_HOST_TO_DEVICE;
-            desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_UNIFORM_BUFFER);
-            desc.main_usage_mode = AGPU_UNIFORM_BUFFER;
-	        desc.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
-            screenAndUIStateUniformBuffer = device->createBuffer(&desc, nullptr);
+            auto frameDataSize = alignedRingSize(sizeof(ScreenAndUIState));
+            if(!frameDataRingBuffer.initialize(device, frameDataSize*framesInFlightCount, framesInFlightCount))
+                return false;
         }
 
-        {
-            uiElementQuadBuffer.reserve(UIElementQuadBufferMaxCapacity);
-            agpu_buffer_description desc = {};
-            desc.size = (sizeof(UIElementQuad)*UIElementQuadBufferMaxCapacity + 255) & (-256);
-            desc.heap_type = AGPU_MEMORY_HEAP_TYPE_HOST_TO_DEVICE;
-            desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_STORAGE_BUFFER);
-            desc.main_usage_mode = AGPU_UNIFORM_BUFFER;
-	        desc.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
-            uiDataBuffer = device->createBuffer(&desc, nullptr);
-        }
+        ui.getQuadCache().setFrameSlotCount(framesInFlightCount);
+        ui.getQuadCache().setPackedQuadsEnabled(packedUIQuadsEnabled);
+        markStartupStage("Render pass, signature and buffers");
 
         bitmapFont = loadTexture("assets/textures/pixel_font_basic_latin_ascii.bmp", false);
         if(!bitmapFont)
         {
             fprintf(stderr, "Failed to load the bitmap font.");
-            return 1;
+            return false;
         }
         {
             agpu_texture_description desc;
             bitmapFont->getDescription(&desc);
-            bitmapFontInverseWidth = 1.0 / desc.width;
-            bitmapFontInverseHeight = 1.0 / desc.height;
+            ui.getFontMetrics().build(desc.width, desc.height, bitmapFontGlyphWidth, bitmapFontGlyphHeight, bitmapFontColumns, bitmapFontScale);
         }
-
-        // Data binding
-        dataBinding = shaderSignature->createShaderResourceBinding(1);
-        dataBinding->bindUniformBuffer(0, screenAndUIStateUniformBuffer);
-        dataBinding->bindStorageBuffer(1, uiDataBuffer);
-        dataBinding->bindSampledTextureView(2, bitmapFont->getOrCreateFullView());
-
-        // Screen quad pipeline state.
-        screenQuadVertex = compileShaderWithSourceFile("assets/shaders/screenQuad.glsl", AGPU_VERTEX_SHADER);
-        screenQuadFragment = compileShaderWithSourceFile("assets/shaders/voronoiNoise.glsl", AGPU_FRAGMENT_SHADER);
+        markStartupStage("Font");
+
+        // The shaders and the pipelines are compiled in the background.
+        // A single headless frame has nothing to reuse from the noise tile cache.
+        // The cache already bounds the noise cost per frame, and its texels are
+        // aligned with the screen pixels, so it is not used with dynamic resolution.
+        dynamicResolution.setLatencyFrames(framesInFlightCount);
+        if(isHeadless)
+            dynamicResolution.setTargetSeconds(0);
+        noiseTileCacheEnabled = noiseTileCacheEnabled && !isHeadless && !dynamicResolution.isEnabled() && device->isFeatureSupported(AGPU_FEATURE_COMPUTE_SHADER);
         screenAndUIState.flipVertically = device->hasTopLeftNdcOrigin() == device->hasBottomLeftTextureCoordinates();
+        startPipelineCompilation();
 
-        if(!screenQuadVertex || !screenQuadFragment)
-            return 1;
-
+        // Per frame resources.
+        for(size_t i = 0; i < MaxFramesInFlight; ++i)
         {
-            auto builder = device->createPipelineBuilder();
-            builder->setRenderTargetFormat(0, colorBufferFormat);
-            builder->setShaderSignature(shaderSignature);
-            builder->attachShader(screenQuadVertex);
-            builder->attachShader(screenQuadFragment);
-            builder->setPrimitiveType(AGPU_TRIANGLES);
-            screenQuadPipeline = finishBuildingPipeline(builder);
+            auto &frame = frames[i];
+            frame.commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
+            frame.commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, frame.commandAllocator, nullptr);
+            frame.commandList->close();
+            frame.fence = device->createFence();
+            if(!frame.commandAllocator || !frame.commandList || !frame.fence)
+            {
+                fprintf(stderr, "Failed to create the per frame resources.\n");
+                return false;
+            }
+
+            // The data buffer ranges are bound when the frame is recorded.
+            frame.dataBinding = shaderSignature->createShaderResourceBinding(1);
+            frame.dataBinding->bindSampledTextureView(2, bitmapFont->getOrCreateFullView());
         }
+        markStartupStage("Frame resources");
 
-        // UI pipeline state.
-        uiElementVertex = compileShaderWithSourceFile("assets/shaders/uiElementVertex.glsl", AGPU_VERTEX_SHADER);
-        uiElementFragment = compileShaderWithSourceFile("assets/shaders/uiElementFragment.glsl", AGPU_FRAGMENT_SHADER);
+        return true;
+    }
 
-        if(!screenQuadVertex || !screenQuadFragment)
+    int headlessMain(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
+    {
+        if(headlessOutputFileName.empty())
+        {
+            fprintf(stderr, "The headless mode requires an output file name, given with -out.\n");
             return 1;
+        }
+
+        auto width = screenAndUIState.screenWidth;
+        auto height = screenAndUIState.screenHeight;
+        std::vector<uint32_t> pixels(size_t(width)*height);
 
+        // The thresholds of a single image come from the CPU statistics.
+        if(!openHeadlessDevice(platformIndex, gpuIndex, debugLayerEnabled))
         {
-            auto builder = device->createPipelineBuilder();
-            builder->setRenderTargetFormat(0, colorBufferFormat);
-            builder->setShaderSignature(shaderSignature);
-            builder->attachShader(uiElementVertex);
-            builder->attachShader(uiElementFragment);
-            builder->setBlendFunction(-1,
-                AGPU_BLENDING_ONE, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD,
-                AGPU_BLENDING_ONE, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD
-            );
-            builder->setBlendState(-1, true);
-            builder->setPrimitiveType(AGPU_TRIANGLE_STRIP);
-            uiPipeline = finishBuildingPipeline(builder);
+            if(autoRangeEnabled)
+                applyAutoRangeWithCPU();
+            return headlessRenderWithCPU(pixels) ? 0 : 1;
         }
+        if(!createDeviceResources() || !waitForPipelines())
+            return 1;
+        markStartupStage("Pipelines");
+        if(autoRangeEnabled)
+            applyAutoRangeWithCPU();
 
-        // Create the command allocator and command list
-        commandAllocator = device->createCommandAllocator(AGPU_COMMAND_LIST_TYPE_DIRECT, commandQueue);
-        commandList = device->createCommandList(AGPU_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr);
-        commandList->close();
+        agpu_texture_ref colorBuffer;
+        agpu_framebuffer_ref framebuffer;
+        if(!createOffscreenFramebuffer(width, height, colorBuffer, framebuffer))
+            return 1;
 
-        // Main loop
-        auto oldTime = SDL_GetTicks();
-        while(!isQuitting)
-        {
-            auto newTime = SDL_GetTicks();
-            auto deltaTime = newTime - oldTime;
-            oldTime = newTime;
+        displayWidth = width;
+        displayHeight = height;
 
-            processEvents();
-            updateAndRender(deltaTime * 0.001f);
+        // The overlay is not part of the generated images.
+        auto &frame = frames[0];
+        frameDataRingBuffer.beginFrame(0);
+        finishFrameData(frame, 0);
+        frameDataRingBuffer.endFrame(0);
+        recordRenderCommands(frame, framebuffer);
+        commandQueue->addCommandList(frame.commandList);
+        commandQueue->finishExecution();
+        if(startupReportEnabled)
+        {
+            markStartupStage("First frame");
+            reportStartupTimes();
         }
 
-        commandQueue->finishExecution();
-        swapChain.reset();
+        colorBuffer->readTextureData(0, 0, width*4, width*height*4, pixels.data());
+        if(noiseVariantBenchmarkEnabled)
+        {
+            if(!runNoiseVariantBenchmark(framebuffer))
+                return 1;
+        }
+        else if(noiseCellTableBenchmarkEnabled)
+        {
+            if(!runNoiseCellTableBenchmark(framebuffer))
+                return 1;
+        }
+        else if(benchmarkFrameCount > 0 && !runHeadlessFrameBenchmark(framebuffer))
+        {
+            return 1;
+        }
         commandQueue.reset();
-
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 0;
+        if(!traceOutputFileName.empty())
+            FrameProfiler::get().writeChromeTrace(traceOutputFileName);
+        return writeImage(headlessOutputFileName, width, height, pixels.data(), width) ? 0 : 1;
     }
 
-    std::string readWholeFile(const std::string &fileName)
+    // Opens a device without a window. Returns false when none is available,
+    // in which case the CPU noise evaluator is used instead.
+    bool openHeadlessDevice(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
     {
-        FILE *file = fopen(fileName.c_str(), "rb");
-        if(!file)
+        agpu_platform *platform = cpuRenderingForced ? nullptr : getPlatform(platformIndex, true);
+        if(platform)
         {
-            fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
-            return std::string();
+            agpu_device_open_info openInfo = {};
+            openInfo.gpu_index = gpuIndex;
+            openInfo.debug_layer = debugLayerEnabled;
+            device = platform->openDevice(&openInfo);
         }
 
-        // Allocate the data.
-        std::vector<char> data;
-        fseek(file, 0, SEEK_END);
-        data.resize(ftell(file));
-        fseek(file, 0, SEEK_SET);
-
-        // Read the file
-        if(fread(&data[0], data.size(), 1, file) != 1)
+        if(!device)
         {
-            fprintf(stderr, "Failed to read file %s\n", fileName.c_str());
-            fclose(file);
-            return std::string();
+            if(!cpuRenderingForced)
+                fprintf(stderr, "No agpu device is available, using the CPU noise evaluator.\n");
+            return false;
         }
 
-        fclose(file);
-        return std::string(data.begin(), data.end());
+        printf("Choosen platform: %s\n", agpuGetPlatformName(platform));
+        commandQueue = device->getDefaultCommandQueue();
+        setShaderCacheDeviceIdentity(platform, gpuIndex);
+        markStartupStage("Device");
+        return true;
     }
 
-    agpu_shader_ref compileShaderWithSourceFile(const std::string &sourceFileName, agpu_shader_type type)
+    // Offscreen color buffer that replaces the swap chain back buffer.
+    bool createOffscreenFramebuffer(uint32_t width, uint32_t height, agpu_texture_ref &colorBuffer, agpu_framebuffer_ref &framebuffer)
     {
-        return compileShaderWithSource(sourceFileName, readWholeFile(sourceFileName), type);
-    }
+        agpu_texture_description desc = {};
+        desc.type = AGPU_TEXTURE_2D;
+        desc.format = colorBufferFormat;
+        desc.width = width;
+        desc.height = height;
+        desc.depth = 1;
+        desc.layers = 1;
+        desc.miplevels = 1;
+        desc.sample_count = 1;
+        desc.sample_quality = 0;
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        desc.usage_modes = agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT | AGPU_TEXTURE_USAGE_READED_BACK);
+        desc.main_usage_mode = AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT;
+        colorBuffer = device->createTexture(&desc);
+        if(!colorBuffer)
+        {
+            fprintf(stderr, "Failed to create the offscreen color buffer.\n");
+            return false;
+        }
 
-    agpu_shader_ref compileShaderWithSource(const std::string &name, const std::string &source, agpu_shader_type type)
-    {
-        if(source.empty())
-            return nullptr;
+        auto colorBufferView = colorBuffer->getOrCreateFullView();
+        framebuffer = device->createFrameBuffer(width, height, 1, &colorBufferView, nullptr);
+        if(!framebuffer)
+        {
+            fprintf(stderr, "Failed to create the offscreen framebuffer.\n");
+            return false;
+        }
+
+        return true;
+    }
+
+    // Exports the noise of the headless screen size into a tiled TIFF. The
+    // colored result is rendered by the GPU when available, and the distance
+    // components are always evaluated by the CPU.
+    int exportMain(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
+    {
+        isHeadless = true;
+        if(exportChannels == NoiseMapChannels::Color && openHeadlessDevice(platformIndex, gpuIndex, debugLayerEnabled))
+        {
+            if(!createDeviceResources() || !waitForPipelines())
+                return 1;
+
+            for(size_t i = 0; i < framesInFlightCount; ++i)
+            {
+                if(!createOffscreenFramebuffer(exportTileSize, exportTileSize, exportColorBuffers[i], exportFramebuffers[i]))
+                    return 1;
+            }
+
+            displayWidth = exportTileSize;
+            displayHeight = exportTileSize;
+            auto mapState = screenAndUIState;
+            NoiseMapExporter exporter(mapState, exportChannels, exportTileSize);
+            exporter.setBatchSize(std::max(framesInFlightCount*4, size_t(16)));
+            bool succeeded = exporter.exportMap(exportFileName, [&](const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations) {
+                return renderNoiseMapTilesWithGPU(mapState, tiles, destinations);
+            });
+            screenAndUIState = mapState;
+            commandQueue->finishExecution();
+            commandQueue.reset();
+            return succeeded ? 0 : 1;
+        }
+
+        WorkStealingThreadPool threadPool;
+        NoiseMapExporter exporter(screenAndUIState, exportChannels, exportTileSize);
+        exporter.setBatchSize(threadPool.getThreadCount()*4);
+        bool succeeded = exporter.exportMap(exportFileName, [&](const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations) {
+            return exporter.renderBatchWithCPU(threadPool, tiles, destinations);
+        });
+        return succeeded ? 0 : 1;
+    }
+
+    // Each tile goes through one of the frames in flight, and it is read back
+    // once the following tiles were submitted.
+    bool renderNoiseMapTilesWithGPU(const ScreenAndUIState &mapState, const std::vector<NoiseMapExportTile> &tiles, const std::vector<uint8_t*> &destinations)
+    {
+        auto pixelCount = size_t(exportTileSize)*exportTileSize;
+        auto readBackTile = [&](size_t tileIndex) {
+            auto slot = tileIndex % framesInFlightCount;
+            waitForFrame(frames[slot]);
+            exportColorBuffers[slot]->readTextureData(0, 0, exportTileSize*4, agpu_uint(pixelCount*4), destinations[tileIndex]);
+            NoiseMapExporter::convertBGRAToRGBA(reinterpret_cast<uint32_t*> (destinations[tileIndex]), pixelCount);
+        };
+
+        for(size_t i = 0; i < tiles.size(); ++i)
+        {
+            auto slot = i % framesInFlightCount;
+            if(i >= framesInFlightCount)
+                readBackTile(i - framesInFlightCount);
+
+            auto &frame = frames[slot];
+            screenAndUIState = makeNoiseMapTileState(mapState, tiles[i].x, tiles[i].y, exportTileSize);
+            frameDataRingBuffer.beginFrame(slot);
+            finishFrameData(frame, slot);
+            frameDataRingBuffer.endFrame(slot);
+            recordRenderCommands(frame, exportFramebuffers[slot]);
+            commandQueue->addCommandList(frame.commandList);
+            commandQueue->signalFence(frame.fence);
+            frame.isInFlight = true;
+        }
+
+        auto firstPendingTile = tiles.size() > framesInFlightCount ? tiles.size() - framesInFlightCount : 0;
+        for(auto i = firstPendingTile; i < tiles.size(); ++i)
+            readBackTile(i);
+        return true;
+    }
+
+    // Evaluates the configurations of the sweep file, and writes their
+    // statistics. The GPU evaluates them with one dispatch and a single
+    // readback, and the CPU evaluator is used when compute shaders are missing.
+    int sweepMain(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
+    {
+        isHeadless = true;
+        NoiseParameterSweep sweep;
+        sweep.setSampleSize(sweepSampleWidth, sweepSampleHeight);
+        sweep.setImagesEnabled(!sweepImagesFileName.empty());
+        if(!sweep.loadConfigurations(sweepFileName, screenAndUIState))
+            return 1;
+        if(sweep.getConfigurations().empty())
+        {
+            fprintf(stderr, "The sweep %s has no configurations.\n", sweepFileName.c_str());
+            return 1;
+        }
+        if(sweep.areImagesEnabled() && !sweep.doImagesFitInAtlas())
+        {
+            fprintf(stderr, "The images of the sweep do not fit in a %ux%u atlas, reduce the sample size or the configuration count.\n",
+                NoiseParameterSweep::MaxAtlasSize, NoiseParameterSweep::MaxAtlasSize);
+            return 1;
+        }
+
+        std::vector<NoiseSweepStatistics> statistics;
+        std::vector<uint32_t> atlasPixels;
+        if(sweep.areImagesEnabled())
+            atlasPixels.resize(size_t(sweep.getAtlasWidth())*sweep.getAtlasHeight());
+
+        const char *backend = "gpu";
+        auto startCounter = SDL_GetPerformanceCounter();
+        if(openHeadlessDevice(platformIndex, gpuIndex, debugLayerEnabled))
+        {
+            if(!createDeviceResources() || !waitForPipelines())
+                return 1;
+            startCounter = SDL_GetPerformanceCounter();
+        }
+
+        if(noiseSweepPipeline)
+        {
+            if(!evaluateNoiseSweepWithGPU(sweep, statistics, atlasPixels.empty() ? nullptr : atlasPixels.data()))
+                return 1;
+            commandQueue.reset();
+        }
+        else
+        {
+            backend = "cpu";
+            WorkStealingThreadPool threadPool;
+            sweep.evaluateWithCPU(threadPool, statistics, atlasPixels.empty() ? nullptr : atlasPixels.data());
+        }
+
+        auto seconds = secondsSince(startCounter);
+        auto configurationCount = sweep.getConfigurations().size();
+        printf("Evaluated %zu configurations of %ux%u samples on the %s in %.3f ms (%.1f configurations/s).\n",
+            configurationCount, sweep.getSampleWidth(), sweep.getSampleHeight(), backend, seconds*1000.0, configurationCount / seconds);
+
+        if(!sweep.writeStatistics(sweepOutputFileName, statistics))
+            return 1;
+        if(!atlasPixels.empty() && !writeImage(sweepImagesFileName, sweep.getAtlasWidth(), sweep.getAtlasHeight(), atlasPixels.data(), sweep.getAtlasWidth()))
+            return 1;
+        return 0;
+    }
+
+    // The configurations are evaluated by a single dispatch of a workgroup per
+    // configuration, recorded in one command list. Only the statistics are read
+    // back, together with the atlas when the images are requested.
+    bool evaluateNoiseSweepWithGPU(const NoiseParameterSweep &sweep, std::vector<NoiseSweepStatistics> &statistics, uint32_t *atlasPixels)
+    {
+        auto &configurations = sweep.getConfigurations();
+        auto header = sweep.getHeader();
+        auto configurationsSize = sizeof(NoiseSweepHeader) + configurations.size()*sizeof(ScreenAndUIState);
+        auto statisticsSize = configurations.size()*sizeof(NoiseSweepStatistics);
+
+        agpu_buffer_description desc = {};
+        desc.size = agpu_size((configurationsSize + 255) & (-256));
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_HOST_TO_DEVICE;
+        desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_STORAGE_BUFFER);
+        desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+        desc.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+        auto configurationsBuffer = device->createBuffer(&desc, nullptr);
+
+        desc.size = agpu_size((statisticsSize + 255) & (-256));
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_TO_HOST;
+        desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_SOURCE_BUFFER | AGPU_STORAGE_BUFFER);
+        desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+        desc.mapping_flags = AGPU_MAP_READ_BIT;
+        auto statisticsBuffer = device->createBuffer(&desc, nullptr);
+        if(!configurationsBuffer || !statisticsBuffer)
+        {
+            fprintf(stderr, "Failed to create the sweep buffers.\n");
+            return false;
+        }
+
+        std::vector<uint8_t> configurationsData(configurationsSize);
+        memcpy(configurationsData.data(), &header, sizeof(header));
+        memcpy(configurationsData.data() + sizeof(header), configurations.data(), configurations.size()*sizeof(ScreenAndUIState));
+        configurationsBuffer->uploadBufferData(0, agpu_size(configurationsSize), configurationsData.data());
+
+        // The shader needs an image even when only the statistics are kept.
+        agpu_texture_description textureDesc = {};
+        textureDesc.type = AGPU_TEXTURE_2D;
+        textureDesc.format = AGPU_TEXTURE_FORMAT_R8G8B8A8_UNORM;
+        textureDesc.width = atlasPixels ? sweep.getAtlasWidth() : 1;
+        textureDesc.height = atlasPixels ? sweep.getAtlasHeight() : 1;
+        textureDesc.depth = 1;
+        textureDesc.layers = 1;
+        textureDesc.miplevels = 1;
+        textureDesc.sample_count = 1;
+        textureDesc.sample_quality = 0;
+        textureDesc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        textureDesc.usage_modes = agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_STORAGE | AGPU_TEXTURE_USAGE_READED_BACK);
+        textureDesc.main_usage_mode = AGPU_TEXTURE_USAGE_STORAGE;
+        auto atlas = device->createTexture(&textureDesc);
+        if(!atlas)
+        {
+            fprintf(stderr, "Failed to create the sweep atlas.\n");
+            return false;
+        }
+
+        auto binding = shaderSignature->createShaderResourceBinding(1);
+        binding->bindStorageImageView(3, atlas->getOrCreateFullView());
+        binding->bindStorageBuffer(6, configurationsBuffer);
+        binding->bindStorageBuffer(7, statisticsBuffer);
+
+        // The dispatch is split in rows of workgroups beyond the minimum limit of the dispatch width.
+        const size_t MaxDispatchWidth = 65535;
+        auto dispatchWidth = std::min(configurations.size(), MaxDispatchWidth);
+        auto dispatchHeight = (configurations.size() + dispatchWidth - 1) / dispatchWidth;
+
+        auto &frame = frames[0];
+        frame.commandAllocator->reset();
+        frame.commandList->reset(frame.commandAllocator, nullptr);
+        frame.commandList->setShaderSignature(shaderSignature);
+        frame.commandList->usePipelineState(noiseSweepPipeline);
+        frame.commandList->useComputeShaderResources(binding);
+        frame.commandList->dispatchCompute(agpu_uint(dispatchWidth), agpu_uint(dispatchHeight), 1);
+        frame.commandList->close();
+        commandQueue->addCommandList(frame.commandList);
+        commandQueue->finishExecution();
+
+        statistics.resize(configurations.size());
+        statisticsBuffer->readBufferData(0, agpu_size(statisticsSize), statistics.data());
+        if(atlasPixels)
+            atlas->readTextureData(0, 0, sweep.getAtlasWidth()*4, sweep.getAtlasWidth()*sweep.getAtlasHeight()*4, atlasPixels);
+        return true;
+    }
+
+    // Renders the frames of the timeline, with the headless screen size. On the
+    // GPU, several frames are recorded in each submitted command list.
+    int renderTimelineMain(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
+    {
+        if(timeline.isEmpty())
+        {
+            fprintf(stderr, "Rendering a timeline requires keyframes, given with -timeline.\n");
+            return 1;
+        }
+
+        isHeadless = true;
+        auto width = screenAndUIState.screenWidth;
+        auto height = screenAndUIState.screenHeight;
+        if(openHeadlessDevice(platformIndex, gpuIndex, debugLayerEnabled))
+        {
+            if(!createDeviceResources() || !waitForPipelines())
+                return 1;
+
+            for(size_t slot = 0; slot < framesInFlightCount; ++slot)
+            {
+                timelineTargets[slot].resize(timelineFramesPerSubmit);
+                for(auto &target : timelineTargets[slot])
+                {
+                    if(!createOffscreenFramebuffer(width, height, target.colorBuffer, target.framebuffer))
+                        return 1;
+
+                    target.dataBinding = shaderSignature->createShaderResourceBinding(1);
+                    target.dataBinding->bindSampledTextureView(2, bitmapFont->getOrCreateFullView());
+                }
+            }
+
+            displayWidth = width;
+            displayHeight = height;
+
+            // A batch fills every frame in flight twice, so that the readback of a submission overlaps the following ones.
+            TimelineRenderer renderer(timeline, screenAndUIState, timelineFramesPerSecond);
+            renderer.setBatchSize(timelineFramesPerSubmit*framesInFlightCount*2);
+            bool succeeded = renderer.render(timelineOutputFileName, [&](const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations) {
+                return renderTimelineFramesWithGPU(states, destinations);
+            });
+            commandQueue->finishExecution();
+            commandQueue.reset();
+            return succeeded ? 0 : 1;
+        }
+
+        WorkStealingThreadPool threadPool;
+        TiledNoiseRasterizer rasterizer(threadPool);
+        TimelineRenderer renderer(timeline, screenAndUIState, timelineFramesPerSecond);
+        renderer.setBatchSize(timelineFramesPerSubmit);
+        bool succeeded = renderer.render(timelineOutputFileName, [&](const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations) {
+            return TimelineRenderer::renderBatchWithCPU(rasterizer, states, destinations);
+        });
+        return succeeded ? 0 : 1;
+    }
+
+    // Each submission records up to timelineFramesPerSubmit frames through one
+    // of the frames in flight, and it is read back once the following
+    // submissions were queued.
+    bool renderTimelineFramesWithGPU(const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations)
+    {
+        auto width = screenAndUIState.screenWidth;
+        auto height = screenAndUIState.screenHeight;
+        auto submissionCount = (states.size() + timelineFramesPerSubmit - 1) / timelineFramesPerSubmit;
+        auto readBackSubmission = [&](size_t submissionIndex) {
+            auto slot = submissionIndex % framesInFlightCount;
+            waitForFrame(frames[slot]);
+            auto firstFrame = submissionIndex*timelineFramesPerSubmit;
+            auto endFrame = std::min(firstFrame + timelineFramesPerSubmit, states.size());
+            for(auto i = firstFrame; i < endFrame; ++i)
+                timelineTargets[slot][i - firstFrame].colorBuffer->readTextureData(0, 0, width*4, width*height*4, destinations[i]);
+        };
+
+        for(size_t submissionIndex = 0; submissionIndex < submissionCount; ++submissionIndex)
+        {
+            auto slot = submissionIndex % framesInFlightCount;
+            if(submissionIndex >= framesInFlightCount)
+                readBackSubmission(submissionIndex - framesInFlightCount);
+
+            auto &frame = frames[slot];
+            auto firstFrame = submissionIndex*timelineFramesPerSubmit;
+            auto frameCount = std::min(timelineFramesPerSubmit, states.size() - firstFrame);
+            frameDataRingBuffer.beginFrame(slot);
+            for(size_t i = 0; i < frameCount; ++i)
+            {
+                auto stateAllocation = frameDataRingBuffer.allocate(sizeof(ScreenAndUIState));
+                if(!stateAllocation.pointer)
+                    return false;
+
+                memcpy(stateAllocation.pointer, &states[firstFrame + i], sizeof(ScreenAndUIState));
+                timelineTargets[slot][i].dataBinding->bindUniformBufferRange(0, stateAllocation.buffer, stateAllocation.offset, stateAllocation.size);
+            }
+            frameDataRingBuffer.endFrame(slot);
+
+            recordTimelineCommands(frame, timelineTargets[slot], &states[firstFrame], frameCount);
+            commandQueue->addCommandList(frame.commandList);
+            commandQueue->signalFence(frame.fence);
+            frame.isInFlight = true;
+        }
+
+        auto firstPendingSubmission = submissionCount > framesInFlightCount ? submissionCount - framesInFlightCount : 0;
+        for(auto i = firstPendingSubmission; i < submissionCount; ++i)
+            readBackSubmission(i);
+        return true;
+    }
+
+    // A render pass per frame, with only the noise. The overlay is not part of the generated frames.
+    void recordTimelineCommands(FrameResources &frame, const std::vector<TimelineFrameTarget> &targets, const ScreenAndUIState *states, size_t frameCount)
+    {
+        auto &commandAllocator = frame.commandAllocator;
+        auto &commandList = frame.commandList;
+        commandAllocator->reset();
+        commandList->reset(commandAllocator, nullptr);
+        commandList->setShaderSignature(shaderSignature);
+
+        for(size_t i = 0; i < frameCount; ++i)
+        {
+            auto &target = targets[i];
+            commandList->beginRenderPass(mainRenderPass, target.framebuffer, false);
+            commandList->setViewport(0, 0, displayWidth, displayHeight);
+            commandList->setScissor(0, 0, displayWidth, displayHeight);
+            commandList->useShaderResources(samplersBinding);
+            commandList->useShaderResources(target.dataBinding);
+            commandList->usePipelineState(getNoisePipeline(states[i]));
+            commandList->drawArrays(3, 1, 0, 0);
+            commandList->endRenderPass();
+        }
+
+        commandList->close();
+    }
+
+    bool headlessRenderWithCPU(std::vector<uint32_t> &pixels)
+    {
+        WorkStealingThreadPool threadPool;
+        TiledNoiseRasterizer rasterizer(threadPool);
+        rasterizer.setCellTableEnabled(noiseCellTableEnabled);
+        rasterizer.render(screenAndUIState, pixels.data(), screenAndUIState.screenWidth);
+        if(benchmarkFrameCount > 0)
+        {
+            // The image is the one of the unmodified state.
+            auto initialState = screenAndUIState;
+            std::vector<uint32_t> benchmarkPixels(pixels.size());
+            size_t frameIndex = 0;
+            BenchmarkReport report("ShaderVisFrameLoop");
+            setFrameBenchmarkContext(report, "cpu");
+            report.addSamples("frame/cpu", sampleBenchmark(1, benchmarkFrameCount, [&]() {
+                advanceBenchmarkFrameState(frameIndex++);
+                rasterizer.render(screenAndUIState, benchmarkPixels.data(), screenAndUIState.screenWidth);
+            }));
+            screenAndUIState = initialState;
+            if(!finishFrameBenchmark(report))
+                return false;
+        }
+        return writeImage(headlessOutputFileName, screenAndUIState.screenWidth, screenAndUIState.screenHeight, pixels.data(), screenAndUIState.screenWidth);
+    }
+
+    // Deterministic panning, so that every frame of the benchmark draws different pixels.
+    void advanceBenchmarkFrameState(size_t frameIndex)
+    {
+        benchmarkFrameIndex = frameIndex;
+        screenAndUIState.screenOffsetX = frameIndex * 0.01f;
+        screenAndUIState.screenOffsetY = frameIndex * 0.005f;
+    }
+
+    void setFrameBenchmarkContext(BenchmarkReport &report, const char *backend)
+    {
+        report.setContext("backend", backend);
+        report.setContext("resolution", std::to_string(screenAndUIState.screenWidth) + "x" + std::to_string(screenAndUIState.screenHeight));
+        report.setContext("frames_in_flight", std::to_string(framesInFlightCount));
+        report.setContext("octaves", std::to_string(int(screenAndUIState.octaves)));
+        report.setContext("ui_quad_format", packedUIQuadsEnabled ? "packed" : "full");
+        report.setContext("ui_dense_text", denseTextBenchmarkEnabled ? "true" : "false");
+    }
+
+    bool finishFrameBenchmark(const BenchmarkReport &report)
+    {
+        report.printTable();
+        return benchmarkJSONFileName.empty() || report.writeJSON(benchmarkJSONFileName);
+    }
+
+    // Runs the per frame path of updateAndRender into the offscreen framebuffer,
+    // with the parameter panel, and measures each of its stages.
+    bool runHeadlessFrameBenchmark(const agpu_framebuffer_ref &framebuffer)
+    {
+        auto initialState = screenAndUIState;
+        std::vector<double> frameSamples, uiSamples, uploadSamples, recordSamples, submitSamples;
+        auto frequency = double(SDL_GetPerformanceFrequency());
+        auto elapsedNanoseconds = [&](uint64_t startCounter, uint64_t endCounter) {
+            return double(endCounter - startCounter) * 1e9 / frequency;
+        };
+
+        uiUploadedBytes = 0;
+        auto loopStartCounter = SDL_GetPerformanceCounter();
+        for(size_t i = 0; i < benchmarkFrameCount; ++i)
+        {
+            auto slot = i % framesInFlightCount;
+            auto &frame = frames[slot];
+            auto frameStartCounter = SDL_GetPerformanceCounter();
+            waitForFrame(frame);
+            frameDataRingBuffer.beginFrame(slot);
+            advanceBenchmarkFrameState(i);
+
+            auto uiStartCounter = SDL_GetPerformanceCounter();
+            updateUI();
+            auto uploadStartCounter = SDL_GetPerformanceCounter();
+            finishFrameData(frame, slot);
+            frameDataRingBuffer.endFrame(slot);
+            auto recordStartCounter = SDL_GetPerformanceCounter();
+            recordRenderCommands(frame, framebuffer);
+            auto submitStartCounter = SDL_GetPerformanceCounter();
+            commandQueue->addCommandList(frame.commandList);
+            commandQueue->signalFence(frame.fence);
+            frame.isInFlight = true;
+            auto frameEndCounter = SDL_GetPerformanceCounter();
+
+            frameSamples.push_back(elapsedNanoseconds(frameStartCounter, frameEndCounter));
+            uiSamples.push_back(elapsedNanoseconds(uiStartCounter, uploadStartCounter));
+            uploadSamples.push_back(elapsedNanoseconds(uploadStartCounter, recordStartCounter));
+            recordSamples.push_back(elapsedNanoseconds(recordStartCounter, submitStartCounter));
+            submitSamples.push_back(elapsedNanoseconds(submitStartCounter, frameEndCounter));
+        }
+        commandQueue->finishExecution();
+        for(auto &frame : frames)
+            frame.isInFlight = false;
+        auto loopNanoseconds = elapsedNanoseconds(loopStartCounter, SDL_GetPerformanceCounter());
+        screenAndUIState = initialState;
+
+        BenchmarkReport report("ShaderVisFrameLoop");
+        setFrameBenchmarkContext(report, "gpu");
+        report.addSamples("frame/gpu/cpu-frame", frameSamples);
+        report.addSamples("frame/gpu/ui", uiSamples);
+        report.addSamples("frame/gpu/upload", uploadSamples);
+        report.addSamples("frame/gpu/record", recordSamples);
+        report.addSamples("frame/gpu/submit", submitSamples);
+        report.setContext("ui_uploaded_bytes_per_frame", std::to_string(uiUploadedBytes / benchmarkFrameCount));
+
+        // The average over the whole loop includes the GPU, once the frames in flight are full.
+        report.addSamples("frame/gpu/throughput", std::vector<double>{loopNanoseconds / benchmarkFrameCount});
+        return finishFrameBenchmark(report);
+    }
+
+    // Compares the GPU time of the generic noise pipeline with the specialized
+    // variants. Each sample is a frame that is submitted and waited for alone.
+    bool runNoiseVariantBenchmark(const agpu_framebuffer_ref &framebuffer)
+    {
+        struct FactorSet
+        {
+            const char *name;
+            float factors[4];
+        };
+        const FactorSet factorSets[] = {
+            {"F1", {1, 0, 0, 0}},
+            {"F1..F4", {0.25f, 0.25f, 0.25f, 0.25f}},
+        };
+        const int octaveCounts[] = {1, 4, 8};
+
+        auto initialState = screenAndUIState;
+        auto initialVariantsEnabled = noiseVariantsEnabled;
+        auto iterations = benchmarkFrameCount > 0 ? benchmarkFrameCount : 32;
+        BenchmarkReport report("ShaderVisNoiseVariants");
+        setFrameBenchmarkContext(report, "gpu");
+        std::vector<std::string> caseNames;
+        for(auto octaves : octaveCounts)
+        {
+            for(auto &factorSet : factorSets)
+            {
+                screenAndUIState = initialState;
+                screenAndUIState.octaves = float(octaves);
+                screenAndUIState.voronoiF1 = factorSet.factors[0];
+                screenAndUIState.voronoiF2 = factorSet.factors[1];
+                screenAndUIState.voronoiF3 = factorSet.factors[2];
+                screenAndUIState.voronoiF4 = factorSet.factors[3];
+
+                std::string caseName = "octaves=" + std::to_string(octaves) + "/" + factorSet.name;
+                caseNames.push_back(caseName);
+                for(int specialized = 0; specialized < 2; ++specialized)
+                {
+                    noiseVariantsEnabled = specialized != 0;
+                    auto &frame = frames[0];
+                    report.addSamples(std::string("noise/gpu/") + (specialized ? "specialized/" : "generic/") + caseName, sampleBenchmark(1, iterations, [&]() {
+                        frameDataRingBuffer.beginFrame(0);
+                        finishFrameData(frame, 0);
+                        frameDataRingBuffer.endFrame(0);
+                        recordRenderCommands(frame, framebuffer);
+                        commandQueue->addCommandList(frame.commandList);
+                        commandQueue->finishExecution();
+                    }));
+                }
+            }
+        }
+
+        screenAndUIState = initialState;
+        noiseVariantsEnabled = initialVariantsEnabled;
+        if(!finishFrameBenchmark(report))
+            return false;
+
+        // The generic and the specialized results of each case are consecutive.
+        auto &results = report.getResults();
+        for(size_t i = 0; i < caseNames.size(); ++i)
+            printf("%-24s speedup %5.2fx\n", caseNames[i].c_str(), results[i*2].p50 / results[i*2 + 1].p50);
+        return true;
+    }
+
+    // Compares the GPU time of a frame that hashes the feature points with
+    // one that fetches them from the cell table, from a zoomed in view to a
+    // zoomed out one, whose cells exceed the table. Each table frame fills the
+    // table again, so that its pass is included.
+    bool runNoiseCellTableBenchmark(const agpu_framebuffer_ref &framebuffer)
+    {
+        if(!noiseCellTablePipeline)
+        {
+            fprintf(stderr, "The noise cell table requires compute shaders.\n");
+            return false;
+        }
+
+        const float screenScales[] = {1.0f, 10.0f, 100.0f, 400.0f, 1000.0f};
+        auto initialState = screenAndUIState;
+        auto initialCellTableEnabled = noiseCellTableEnabled;
+        auto iterations = benchmarkFrameCount > 0 ? benchmarkFrameCount : 32;
+        BenchmarkReport report("ShaderVisNoiseCellTable");
+        setFrameBenchmarkContext(report, "gpu");
+        std::vector<std::string> caseNames;
+        std::vector<uint32_t> casePointCounts;
+        for(auto screenScale : screenScales)
+        {
+            screenAndUIState = initialState;
+            screenAndUIState.screenScale = screenScale;
+
+            VoronoiNoiseCellTableHeader header;
+            layoutVoronoiNoiseCellTable(screenAndUIState, header);
+            casePointCounts.push_back(header.pointCount);
+
+            std::string caseName = "scale=" + std::to_string(int(screenScale));
+            caseNames.push_back(caseName);
+            for(int cellTable = 0; cellTable < 2; ++cellTable)
+            {
+                noiseCellTableEnabled = cellTable != 0;
+                auto &frame = frames[0];
+                report.addSamples(std::string("noise/gpu/") + (cellTable ? "cell-table/" : "hashed/") + caseName, sampleBenchmark(1, iterations, [&]() {
+                    frame.noiseCellTableHeader = VoronoiNoiseCellTableHeader{};
+                    frameDataRingBuffer.beginFrame(0);
+                    finishFrameData(frame, 0);
+                    frameDataRingBuffer.endFrame(0);
+                    recordRenderCommands(frame, framebuffer);
+                    commandQueue->addCommandList(frame.commandList);
+                    commandQueue->finishExecution();
+                }));
+            }
+        }
+
+        screenAndUIState = initialState;
+        noiseCellTableEnabled = initialCellTableEnabled;
+        if(!finishFrameBenchmark(report))
+            return false;
+
+        // The hashed and the cell table results of each case are consecutive.
+        auto &results = report.getResults();
+        for(size_t i = 0; i < caseNames.size(); ++i)
+            printf("%-12s %7u points  speedup %5.2fx\n", caseNames[i].c_str(), casePointCounts[i], results[i*2].p50 / results[i*2 + 1].p50);
+        return true;
+    }
+
+    void createShaderCompileJobs()
+    {
+        shaderCompileJobs = {
+            {"assets/shaders/screenQuad.glsl", AGPU_VERTEX_SHADER, ScreenQuadPipelineJob, &screenQuadVertex},
+            {"assets/shaders/voronoiNoise.glsl", AGPU_FRAGMENT_SHADER, ScreenQuadPipelineJob, &screenQuadFragment},
+            {packedUIQuadsEnabled ? "assets/shaders/uiElementVertex.glsl" : "assets/shaders/uiElementFullVertex.glsl", AGPU_VERTEX_SHADER, UIPipelineJob, &uiElementVertex},
+            {"assets/shaders/uiElementFragment.glsl", AGPU_FRAGMENT_SHADER, UIPipelineJob, &uiElementFragment},
+        };
+        if(noiseTileCacheEnabled)
+        {
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseBake.glsl", AGPU_COMPUTE_SHADER, NoiseBakePipelineJob, &noiseBakeShader});
+            shaderCompileJobs.push_back({"assets/shaders/screenQuad.glsl", AGPU_VERTEX_SHADER, CachedScreenQuadPipelineJob, &cachedScreenQuadVertex});
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseCached.glsl", AGPU_FRAGMENT_SHADER, CachedScreenQuadPipelineJob, &cachedScreenQuadFragment});
+        }
+        if(dynamicResolution.isEnabled())
+        {
+            shaderCompileJobs.push_back({"assets/shaders/screenQuad.glsl", AGPU_VERTEX_SHADER, UpscalePipelineJob, &upscaleVertex});
+            shaderCompileJobs.push_back({"assets/shaders/upscaleNoise.glsl", AGPU_FRAGMENT_SHADER, UpscalePipelineJob, &upscaleFragment});
+        }
+        if(!sweepFileName.empty() && device->isFeatureSupported(AGPU_FEATURE_COMPUTE_SHADER))
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseSweep.glsl", AGPU_COMPUTE_SHADER, NoiseSweepPipelineJob, &noiseSweepShader});
+
+        // The headless modes compute the statistics of their single state on the CPU.
+        if(!isHeadless && device->isFeatureSupported(AGPU_FEATURE_COMPUTE_SHADER))
+        {
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseStatistics.glsl", AGPU_COMPUTE_SHADER, NoiseStatisticsPipelineJob, &noiseStatisticsShader});
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseStatisticsResolve.glsl", AGPU_COMPUTE_SHADER, NoiseStatisticsResolvePipelineJob, &noiseStatisticsResolveShader});
+        }
+
+        // The cell table can be toggled while running, so its fill pass is always built.
+        if(device->isFeatureSupported(AGPU_FEATURE_COMPUTE_SHADER))
+            shaderCompileJobs.push_back({"assets/shaders/voronoiNoiseCellTable.glsl", AGPU_COMPUTE_SHADER, NoiseCellTablePipelineJob, &noiseCellTableShader});
+    }
+
+    void startPipelineCompilation()
+    {
+        createShaderCompileJobs();
+
+        pipelineBuildJobs[ScreenQuadPipelineJob].name = "Screen quad";
+        pipelineBuildJobs[ScreenQuadPipelineJob].target = &screenQuadPipeline;
+        pipelineBuildJobs[UIPipelineJob].name = "UI";
+        pipelineBuildJobs[UIPipelineJob].target = &uiPipeline;
+        pipelineBuildJobs[NoiseBakePipelineJob].name = "Noise bake";
+        pipelineBuildJobs[NoiseBakePipelineJob].target = &noiseBakePipeline;
+        pipelineBuildJobs[CachedScreenQuadPipelineJob].name = "Cached screen quad";
+        pipelineBuildJobs[CachedScreenQuadPipelineJob].target = &cachedScreenQuadPipeline;
+        pipelineBuildJobs[UpscalePipelineJob].name = "Upscale";
+        pipelineBuildJobs[UpscalePipelineJob].target = &upscalePipeline;
+        pipelineBuildJobs[NoiseSweepPipelineJob].name = "Noise sweep";
+        pipelineBuildJobs[NoiseSweepPipelineJob].target = &noiseSweepPipeline;
+        pipelineBuildJobs[NoiseStatisticsPipelineJob].name = "Noise statistics";
+        pipelineBuildJobs[NoiseStatisticsPipelineJob].target = &noiseStatisticsPipeline;
+        pipelineBuildJobs[NoiseStatisticsResolvePipelineJob].name = "Noise statistics resolve";
+        pipelineBuildJobs[NoiseStatisticsResolvePipelineJob].target = &noiseStatisticsResolvePipeline;
+        pipelineBuildJobs[NoiseCellTablePipelineJob].name = "Noise cell table";
+        pipelineBuildJobs[NoiseCellTablePipelineJob].target = &noiseCellTablePipeline;
+        for(auto &job : pipelineBuildJobs)
+        {
+            job.pendingShaderCount = 0;
+            job.isFinished = false;
+        }
+        for(auto &job : shaderCompileJobs)
+            ++pipelineBuildJobs[job.pipelineJobIndex].pendingShaderCount;
+
+        // The pipelines without shaders are disabled.
+        for(auto &job : pipelineBuildJobs)
+        {
+            job.isEnabled = job.pendingShaderCount > 0;
+            if(!job.isEnabled)
+                job.isFinished = true;
+        }
+
+        // The device objects are created concurrently, which agpu allows.
+        // The results are only published to the render loop through
+        // adoptFinishedPipelines.
+        pipelineCompilationThread = std::thread([this]() {
+            WorkStealingThreadPool threadPool(std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), shaderCompileJobs.size()));
+            threadPool.parallelFor(shaderCompileJobs.size(), [this](size_t i) {
+                runShaderCompileJob(shaderCompileJobs[i]);
+            });
+        });
+    }
+
+    void runShaderCompileJob(ShaderCompileJob &job)
+    {
+        SHADER_VIS_PROFILE_ZONE("Compile shader");
+        auto startCounter = SDL_GetPerformanceCounter();
+        auto shader = compileShaderAsset(job.fileName, job.type, &job.isCached);
+        job.seconds = secondsSince(startCounter);
+
+        // The shader handles are read by the thread that builds the pipeline,
+        // after it observes the decrement.
+        *job.target = shader;
+        auto &pipelineJob = pipelineBuildJobs[job.pipelineJobIndex];
+        if(--pipelineJob.pendingShaderCount == 0)
+            runPipelineBuildJob(job.pipelineJobIndex);
+    }
+
+    void runPipelineBuildJob(size_t jobIndex)
+    {
+        SHADER_VIS_PROFILE_ZONE("Build pipeline");
+        auto &job = pipelineBuildJobs[jobIndex];
+        auto startCounter = SDL_GetPerformanceCounter();
+        switch(jobIndex)
+        {
+        case ScreenQuadPipelineJob:
+            job.pipeline = buildPipeline(jobIndex, screenQuadVertex, screenQuadFragment);
+            break;
+        case UIPipelineJob:
+            job.pipeline = buildPipeline(jobIndex, uiElementVertex, uiElementFragment);
+            break;
+        case NoiseBakePipelineJob:
+            job.pipeline = buildComputePipeline(noiseBakeShader);
+            break;
+        case CachedScreenQuadPipelineJob:
+            job.pipeline = buildPipeline(jobIndex, cachedScreenQuadVertex, cachedScreenQuadFragment);
+            break;
+        case UpscalePipelineJob:
+            job.pipeline = buildPipeline(jobIndex, upscaleVertex, upscaleFragment);
+            break;
+        case NoiseSweepPipelineJob:
+            job.pipeline = buildComputePipeline(noiseSweepShader);
+            break;
+        case NoiseStatisticsPipelineJob:
+            job.pipeline = buildComputePipeline(noiseStatisticsShader);
+            break;
+        case NoiseStatisticsResolvePipelineJob:
+            job.pipeline = buildComputePipeline(noiseStatisticsResolveShader);
+            break;
+        case NoiseCellTablePipelineJob:
+            job.pipeline = buildComputePipeline(noiseCellTableShader);
+            break;
+        }
+        job.buildSeconds = secondsSince(startCounter);
+        job.readySeconds = secondsSince(startupStartCounter);
+        job.hasFailed = !job.pipeline;
+        job.isFinished.store(true, std::memory_order_release);
+    }
+
+    agpu_pipeline_state_ref buildPipeline(size_t jobIndex, const agpu_shader_ref &vertexShader, const agpu_shader_ref &fragmentShader, std::string *errorLog = nullptr)
+    {
+        if(!vertexShader || !fragmentShader)
+            return nullptr;
+
+        auto builder = device->createPipelineBuilder();
+        builder->setRenderTargetFormat(0, colorBufferFormat);
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(vertexShader);
+        builder->attachShader(fragmentShader);
+
+        switch(jobIndex)
+        {
+        case ScreenQuadPipelineJob:
+        case CachedScreenQuadPipelineJob:
+        case UpscalePipelineJob:
+            builder->setPrimitiveType(AGPU_TRIANGLES);
+            break;
+        case UIPipelineJob:
+            builder->setBlendFunction(-1,
+                AGPU_BLENDING_ONE, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD,
+                AGPU_BLENDING_ONE, AGPU_BLENDING_INVERTED_SRC_ALPHA, AGPU_BLENDING_OPERATION_ADD
+            );
+            builder->setBlendState(-1, true);
+            builder->setPrimitiveType(AGPU_TRIANGLE_STRIP);
+            break;
+        default:
+            return nullptr;
+        }
+
+        return finishBuildingPipeline(builder, errorLog);
+    }
+
+    agpu_pipeline_state_ref buildComputePipeline(const agpu_shader_ref &computeShader, std::string *errorLog = nullptr)
+    {
+        if(!computeShader)
+            return nullptr;
+
+        auto builder = device->createComputePipelineBuilder();
+        builder->setShaderSignature(shaderSignature);
+        builder->attachShader(computeShader);
+        return finishBuildingPipeline(builder, errorLog);
+    }
+
+    // Makes the finished startup pipelines available to the render loop.
+    // Returns false when one of them failed.
+    bool adoptFinishedPipelines()
+    {
+        if(arePipelinesReady)
+            return true;
+
+        bool allFinished = true;
+        for(auto &job : pipelineBuildJobs)
+        {
+            if(!job.isFinished.load(std::memory_order_acquire))
+            {
+                allFinished = false;
+                continue;
+            }
+
+            if(job.hasFailed)
+            {
+                fprintf(stderr, "Failed to build the %s pipeline.\n", job.name);
+                return false;
+            }
+
+            if(!*job.target)
+                *job.target = job.pipeline;
+        }
+
+        if(allFinished)
+        {
+            pipelineCompilationThread.join();
+            arePipelinesReady = true;
+            redrawRequested = true;
+        }
+        return true;
+    }
+
+    bool waitForPipelines()
+    {
+        if(pipelineCompilationThread.joinable())
+            pipelineCompilationThread.join();
+        return adoptFinishedPipelines();
+    }
+
+    void startShaderHotReload()
+    {
+        std::vector<std::string> fileNames;
+        for(auto &job : shaderCompileJobs)
+        {
+            std::string path = job.fileName;
+            fileNames.push_back(path.substr(path.rfind('/') + 1));
+        }
+        shaderFileWatcher.watch("assets/shaders", fileNames);
+    }
+
+    // Called between frames. Starts recompiling the pipelines whose sources
+    // changed, and swaps in the pipelines that were rebuilt successfully.
+    void updateShaderHotReload()
+    {
+        if(!shaderFileWatcher.isWatching())
+            startShaderHotReload();
+
+        std::vector<std::string> changedFiles;
+        shaderFileWatcher.pollChangedFiles(changedFiles);
+        for(auto &changedFile : changedFiles)
+        {
+            for(auto &job : shaderCompileJobs)
+            {
+                if(changedFile == job.fileName)
+                    pendingShaderReloads[job.pipelineJobIndex] = true;
+            }
+            lastShaderChangeTicks = SDL_GetTicks();
+        }
+
+        if(isShaderReloadRunning.load(std::memory_order_acquire))
+            return;
+
+        if(shaderReloadThread.joinable())
+        {
+            shaderReloadThread.join();
+            for(auto &result : shaderReloadResults)
+                applyShaderReloadResult(result);
+            shaderReloadResults.clear();
+        }
+
+        // Editors often write a file in several steps.
+        bool hasPendingReload = std::find(std::begin(pendingShaderReloads), std::end(pendingShaderReloads), true) != std::end(pendingShaderReloads);
+        if(!hasPendingReload || SDL_GetTicks() - lastShaderChangeTicks < 100)
+            return;
+
+        std::vector<size_t> pipelineJobIndices;
+        for(size_t i = 0; i < PipelineBuildJobCount; ++i)
+        {
+            if(pendingShaderReloads[i])
+                pipelineJobIndices.push_back(i);
+            pendingShaderReloads[i] = false;
+        }
 
-        // Create the shader compiler.
+        isShaderReloadRunning = true;
+        shaderReloadThread = std::thread([this, pipelineJobIndices]() {
+            std::vector<ShaderReloadResult> results;
+            for(auto jobIndex : pipelineJobIndices)
+                results.push_back(reloadPipeline(jobIndex));
+
+            shaderReloadResults = std::move(results);
+            isShaderReloadRunning.store(false, std::memory_order_release);
+        });
+    }
+
+    ShaderReloadResult reloadPipeline(size_t jobIndex)
+    {
+        SHADER_VIS_PROFILE_ZONE("Reload pipeline");
+        ShaderReloadResult result;
+        result.pipelineJobIndex = jobIndex;
+        for(auto &job : shaderCompileJobs)
+        {
+            if(job.pipelineJobIndex != jobIndex || !result.errorLog.empty())
+                continue;
+
+            auto shader = compileShaderWithSourceFile(job.fileName, job.type, nullptr, &result.errorLog);
+            if(job.type == AGPU_VERTEX_SHADER)
+                result.vertexShader = shader;
+            else if(job.type == AGPU_COMPUTE_SHADER)
+                result.computeShader = shader;
+            else
+                result.fragmentShader = shader;
+        }
+
+        if(!result.errorLog.empty())
+            return result;
+
+        if(jobIndex == NoiseBakePipelineJob || jobIndex == NoiseSweepPipelineJob ||
+            jobIndex == NoiseStatisticsPipelineJob || jobIndex == NoiseStatisticsResolvePipelineJob ||
+            jobIndex == NoiseCellTablePipelineJob)
+            result.pipeline = buildComputePipeline(result.computeShader, &result.errorLog);
+        else
+            result.pipeline = buildPipeline(jobIndex, result.vertexShader, result.fragmentShader, &result.errorLog);
+        return result;
+    }
+
+    void applyShaderReloadResult(const ShaderReloadResult &result)
+    {
+        // Either the pipeline or the error overlay changes.
+        redrawRequested = true;
+        auto &job = pipelineBuildJobs[result.pipelineJobIndex];
+        if(!result.pipeline)
+        {
+            // Keep drawing with the previous pipeline.
+            shaderReloadErrorLogs[result.pipelineJobIndex] = result.errorLog.empty() ? "Failed to reload the shaders." : result.errorLog;
+            return;
+        }
+
+        shaderReloadErrorLogs[result.pipelineJobIndex].clear();
+
+        // The specialized variants are generated again from the new source.
+        // The variant build thread reads the screen quad vertex shader, so it
+        // is joined before the shaders are replaced.
+        if(result.pipelineJobIndex == ScreenQuadPipelineJob)
+        {
+            isNoiseShaderSourceReloaded = true;
+            discardNoiseVariants();
+        }
+
+        for(auto &compileJob : shaderCompileJobs)
+        {
+            if(compileJob.pipelineJobIndex != result.pipelineJobIndex)
+                continue;
+
+            if(compileJob.type == AGPU_VERTEX_SHADER)
+                *compileJob.target = result.vertexShader;
+            else if(compileJob.type == AGPU_COMPUTE_SHADER)
+                *compileJob.target = result.computeShader;
+            else
+                *compileJob.target = result.fragmentShader;
+        }
+
+        // The baked tiles were produced by the previous shader.
+        if(result.pipelineJobIndex == NoiseBakePipelineJob)
+            noiseTileCache.invalidate();
+
+        // So were the points of the cell tables, which are filled again by
+        // the next frame of each slot.
+        if(result.pipelineJobIndex == NoiseCellTablePipelineJob)
+        {
+            for(auto &frame : frames)
+                frame.noiseCellTableHeader = VoronoiNoiseCellTableHeader{};
+        }
+
+        // The frames in flight may still be using the previous pipeline.
+        retiredPipelines.push_back(RetiredPipeline{*job.target, framesInFlightCount});
+        *job.target = result.pipeline;
+        printf("Reloaded the %s pipeline.\n", job.name);
+    }
+
+    void releaseRetiredPipelines()
+    {
+        for(auto &retired : retiredPipelines)
+            --retired.remainingFrames;
+        retiredPipelines.erase(std::remove_if(retiredPipelines.begin(), retiredPipelines.end(), [](const RetiredPipeline &retired) {
+            return retired.remainingFrames == 0;
+        }), retiredPipelines.end());
+    }
+
+    // The noise pipeline that is specialized for the parameters of the state.
+    // A missing variant is built in the background, and the generic pipeline
+    // is used until it is ready. The headless modes build it right away. The
+    // cell table variants require the table bindings of the frame.
+    const agpu_pipeline_state_ref &getNoisePipeline(const ScreenAndUIState &state, bool cellTable = false)
+    {
+        auto variant = selectVoronoiNoiseVariant(state, cellTable);
+        if(!noiseVariantsEnabled)
+        {
+            variant = VoronoiNoiseVariant();
+            variant.cellTable = cellTable;
+        }
+        if(variant.isGeneric() || !screenQuadPipeline)
+            return screenQuadPipeline;
+
+        adoptBuiltNoiseVariant();
+        auto it = noiseVariantPipelines.find(variant.getKey());
+        if(it != noiseVariantPipelines.end())
+            return it->second ? it->second : screenQuadPipeline;
+
+        if(isHeadless)
+        {
+            auto &pipeline = noiseVariantPipelines[variant.getKey()];
+            pipeline = buildNoiseVariantPipeline(variant);
+            return pipeline ? pipeline : screenQuadPipeline;
+        }
+
+        if(!isNoiseVariantBuildRunning.load(std::memory_order_acquire))
+        {
+            buildingNoiseVariant = variant;
+            isNoiseVariantBuildRunning = true;
+            noiseVariantBuildThread = std::thread([this]() {
+                builtNoiseVariantPipeline = buildNoiseVariantPipeline(buildingNoiseVariant);
+                isNoiseVariantBuildRunning.store(false, std::memory_order_release);
+            });
+        }
+        return screenQuadPipeline;
+    }
+
+    void adoptBuiltNoiseVariant()
+    {
+        if(isNoiseVariantBuildRunning.load(std::memory_order_acquire) || !noiseVariantBuildThread.joinable())
+            return;
+
+        noiseVariantBuildThread.join();
+        noiseVariantPipelines[buildingNoiseVariant.getKey()] = builtNoiseVariantPipeline;
+        builtNoiseVariantPipeline.reset();
+    }
+
+    // A variant that fails to build is kept as null, so that it is not built again.
+    agpu_pipeline_state_ref buildNoiseVariantPipeline(const VoronoiNoiseVariant &variant)
+    {
+        SHADER_VIS_PROFILE_ZONE("Build noise variant");
+        std::string errorLog;
+        auto fragmentShader = compileNoiseVariantShader(variant, &errorLog);
+        auto pipeline = buildPipeline(ScreenQuadPipelineJob, screenQuadVertex, fragmentShader, &errorLog);
+        if(!pipeline)
+            fprintf(stderr, "Failed to build the noise variant %s:\n%s\n", variant.getName().c_str(), errorLog.c_str());
+        return pipeline;
+    }
+
+    agpu_shader_ref compileNoiseVariantShader(const VoronoiNoiseVariant &variant, std::string *errorLog)
+    {
+        const std::string fileName = "assets/shaders/voronoiNoise.glsl";
+        std::string source;
+        const uint8_t *bundledSource = nullptr;
+        size_t bundledSourceSize = 0;
+        if(!isNoiseShaderSourceReloaded && assetBundle.isOpen() && assetBundle.findAsset(fileName, AssetKind::File, bundledSource, bundledSourceSize))
+        {
+            source.assign(reinterpret_cast<const char*> (bundledSource), bundledSourceSize);
+        }
+        else
+        {
+            MappedFile sourceFile;
+            if(!sourceFile.open(fileName))
+            {
+                *errorLog = "Failed to read " + fileName;
+                return nullptr;
+            }
+            source.assign(sourceFile.chars(), sourceFile.size());
+        }
+
+        // The definitions must follow the #version directive, and #line keeps
+        // the line numbers of the compilation errors.
+        auto versionLineEnd = source.find('\n');
+        if(source.compare(0, 8, "#version") != 0 || versionLineEnd == std::string::npos)
+        {
+            *errorLog = fileName + " does not start with a #version directive.";
+            return nullptr;
+        }
+        source.insert(versionLineEnd + 1, variant.getShaderDefinitions() + "#line 2\n");
+
+        // The generated source has its own key in the shader binary cache.
+        return compileShaderWithSource(fileName + "[" + variant.getName() + "]", source.data(), source.size(), AGPU_FRAGMENT_SHADER, nullptr, errorLog);
+    }
+
+    void discardNoiseVariants()
+    {
+        if(noiseVariantBuildThread.joinable())
+            noiseVariantBuildThread.join();
+        builtNoiseVariantPipeline.reset();
+
+        // The frames in flight may still be using them.
+        for(auto &variantPipeline : noiseVariantPipelines)
+        {
+            if(variantPipeline.second)
+                retiredPipelines.push_back(RetiredPipeline{variantPipeline.second, framesInFlightCount});
+        }
+        noiseVariantPipelines.clear();
+    }
+
+    // The startup shaders come from the asset bundle when it holds them.
+    agpu_shader_ref compileShaderAsset(const std::string &sourceFileName, agpu_shader_type type, bool *loadedFromCache = nullptr, std::string *errorLog = nullptr)
+    {
+        const uint8_t *source = nullptr;
+        size_t sourceSize = 0;
+        if(assetBundle.isOpen() && assetBundle.findAsset(sourceFileName, AssetKind::File, source, sourceSize))
+            return compileShaderWithSource(sourceFileName, reinterpret_cast<const char*> (source), sourceSize, type, loadedFromCache, errorLog);
+        return compileShaderWithSourceFile(sourceFileName, type, loadedFromCache, errorLog);
+    }
+
+    agpu_shader_ref compileShaderWithSourceFile(const std::string &sourceFileName, agpu_shader_type type, bool *loadedFromCache = nullptr, std::string *errorLog = nullptr)
+    {
+        // The source is given to the compiler straight from the mapped file.
+        MappedFile sourceFile;
+        if(!sourceFile.open(sourceFileName))
+        {
+            if(errorLog)
+                *errorLog = "Failed to read " + sourceFileName;
+            return nullptr;
+        }
+
+        return compileShaderWithSource(sourceFileName, sourceFile.chars(), sourceFile.size(), type, loadedFromCache, errorLog);
+    }
+
+    agpu_shader_ref compileShaderWithSource(const std::string &name, const char *source, size_t sourceSize, agpu_shader_type type, bool *loadedFromCache = nullptr, std::string *errorLog = nullptr)
+    {
+        if(sourceSize == 0)
+            return nullptr;
+
+        // Look for the device shader in the asset bundle, and then in the binary cache.
+        auto cacheKey = shaderBinaryCache.computeKey(source, sourceSize, type);
+        const uint8_t *bundledBinary = nullptr;
+        size_t bundledBinarySize = 0;
+        if(assetBundle.isOpen() && assetBundle.findAsset(getShaderBinaryAssetName(cacheKey), AssetKind::ShaderBinary, bundledBinary, bundledBinarySize))
+        {
+            auto shader = createShaderWithBinary(bundledBinary, bundledBinarySize, type);
+            if(shader)
+            {
+                if(loadedFromCache)
+                    *loadedFromCache = true;
+                return shader;
+            }
+
+            fprintf(stderr, "The bundled binary of '%s' was rejected by the device, compiling it again.\n", name.c_str());
+        }
+
+        if(shaderBinaryCache.isEnabled())
+        {
+            std::vector<uint8_t> binary;
+            if(shaderBinaryCache.load(cacheKey, binary))
+            {
+                auto shader = createShaderWithBinary(binary.data(), binary.size(), type);
+                if(shader)
+                {
+                    if(loadedFromCache)
+                        *loadedFromCache = true;
+                    return shader;
+                }
+
+                fprintf(stderr, "The cached binary of '%s' was rejected by the device, compiling it again.\n", name.c_str());
+            }
+        }
+
+        auto shaderCompiler = runOfflineShaderCompiler(name, source, sourceSize, type, errorLog);
+        if(!shaderCompiler)
+            return nullptr;
+
+        if(shaderBinaryCache.isEnabled())
+        {
+            std::vector<uint8_t> binary(shaderCompiler->getCompilationResultLength());
+            if(!binary.empty() && !shaderCompiler->getCompilationResult(binary.size(), binary.data()))
+                shaderBinaryCache.store(cacheKey, binary);
+        }
+
+        // Create the shader and compile it.
+        return shaderCompiler->getResultAsShader();
+    }
+
+    agpu_offline_shader_compiler_ref runOfflineShaderCompiler(const std::string &name, const char *source, size_t sourceSize, agpu_shader_type type, std::string *errorLog = nullptr)
+    {
         agpu_offline_shader_compiler_ref shaderCompiler = device->createOfflineShaderCompiler();
-        shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, type, source.c_str(), (agpu_string_length)source.size());
+        shaderCompiler->setShaderSource(AGPU_SHADER_LANGUAGE_VGLSL, type, source, (agpu_string_length)sourceSize);
         auto errorCode = agpuCompileOfflineShader(shaderCompiler.get(), AGPU_SHADER_LANGUAGE_DEVICE_SHADER, nullptr);
         if(errorCode)
         {
@@ -397,43 +2026,127 @@ public:
             std::unique_ptr<char[]> logBuffer(new char[logLength+1]);
             shaderCompiler->getCompilationLog(logLength+1, logBuffer.get());
             fprintf(stderr, "Compilation error of '%s':%s\n", name.c_str(), logBuffer.get());
+            if(errorLog)
+                *errorLog = "Compilation error of '" + name + "':" + logBuffer.get();
+            return nullptr;
+        }
+
+        return shaderCompiler;
+    }
+
+    static std::string getShaderBinaryAssetName(uint64_t cacheKey)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx", (unsigned long long)cacheKey);
+        return name;
+    }
+
+    // The offline compiler produces the preferred shader language of the
+    // device, so a cached result is given back to the device in that language.
+    agpu_shader_ref createShaderWithBinary(const uint8_t *binary, size_t binarySize, agpu_shader_type type)
+    {
+        auto shader = device->createShader(type);
+        if(!shader)
+            return nullptr;
+
+        shader->setShaderSource(device->getPreferredShaderLanguage(), reinterpret_cast<const char*> (binary), agpu_string_length(binarySize));
+        if(shader->compileShader(""))
             return nullptr;
+        return shader;
+    }
+
+    void setShaderCacheDeviceIdentity(agpu_platform *platform, agpu_uint gpuIndex)
+    {
+        char identity[256];
+        snprintf(identity, sizeof(identity), "%s/gpu%u/lang%d", agpuGetPlatformName(platform), unsigned(gpuIndex), int(device->getPreferredShaderLanguage()));
+        shaderBinaryCache.setDeviceIdentity(identity);
+    }
+
+    static double secondsSince(uint64_t startCounter)
+    {
+        return double(SDL_GetPerformanceCounter() - startCounter) / double(SDL_GetPerformanceFrequency());
+    }
+
+    void markStartupStage(const char *name)
+    {
+        auto counter = SDL_GetPerformanceCounter();
+        startupStages.push_back(std::make_pair(name, double(counter - lastStartupStageCounter) / double(SDL_GetPerformanceFrequency())));
+        lastStartupStageCounter = counter;
+    }
+
+    void reportStartupTimes()
+    {
+        printf("Startup time: %.3f ms\n", secondsSince(startupStartCounter) * 1000.0);
+        for(auto &stage : startupStages)
+            printf("    %s: %.3f ms\n", stage.first, stage.second * 1000.0);
+
+        // The jobs overlap with the stages above.
+        for(auto &job : shaderCompileJobs)
+            printf("    Shader %s: %.3f ms (%s)\n", job.fileName, job.seconds * 1000.0, job.isCached ? "cached" : "compiled");
+        for(auto &job : pipelineBuildJobs)
+        {
+            if(!job.isEnabled)
+                continue;
+            printf("    %s pipeline: built in %.3f ms, ready at %.3f ms\n", job.name, job.buildSeconds * 1000.0, job.readySeconds * 1000.0);
+        }
+
+        auto statistics = shaderBinaryCache.getStatistics();
+        if(shaderBinaryCache.isEnabled())
+        {
+            printf("Shader cache: %u hits, %u misses, %u stores, %u rejected entries\n",
+                statistics.hits, statistics.misses, statistics.stores, statistics.rejectedEntries);
+        }
+        else
+        {
+            printf("Shader cache: disabled\n");
         }
+    }
 
-        // Create the shader and compile it.
-        return shaderCompiler->getResultAsShader();
+    static size_t alignedRingSize(size_t size)
+    {
+        return (size + PersistentRingBuffer::DefaultAlignment - 1) & ~(PersistentRingBuffer::DefaultAlignment - 1);
     }
 
-    agpu_pipeline_state_ref finishBuildingPipeline(const agpu_pipeline_builder_ref &builder)
+    // The graphics and compute pipeline builders have the same building interface.
+    template<typename Builder>
+    agpu_pipeline_state_ref finishBuildingPipeline(const Builder &builder, std::string *errorLog = nullptr)
     {
         auto pipeline = builder->build();
         if(!pipeline)
         {
-            fprintf(stderr, "Failed to build pipeline.\n");
+            auto logLength = builder->getBuildingLogLength();
+            std::unique_ptr<char[]> logBuffer(new char[logLength+1]);
+            builder->getBuildingLog(logLength+1, logBuffer.get());
+            fprintf(stderr, "Failed to build pipeline.%s\n", logBuffer.get());
+            if(errorLog)
+                *errorLog = std::string("Failed to build pipeline.\n") + logBuffer.get();
         }
         return pipeline;
     }
 
-    void processEvents()
+    // Waits up to timeoutMilliseconds for the first event when it is not zero.
+    void processEvents(int timeoutMilliseconds)
     {
+        SHADER_VIS_PROFILE_ZONE("Process events");
         // Reset the event data.
-        hasWheelEvent = false;
-        hasHandledWheelEvent = false;
-        wheelDelta = 0;
-
-        hasLeftDragEvent = false;
-        hasHandledLeftDragEvent = false;
-        leftDragStartX = 0;
-        leftDragStartY = 0;
-        leftDragDeltaX = 0;
-        leftDragDeltaY = 0;
+        ui.getInput().reset();
 
         // Poll and process the SDL events.
         SDL_Event event;
+        if(timeoutMilliseconds > 0 && SDL_WaitEventTimeout(&event, timeoutMilliseconds))
+            processEvent(event);
         while(SDL_PollEvent(&event))
             processEvent(event);
     }
 
+    // Whether the next frame may differ from the last one that was drawn.
+    bool needsRedraw() const
+    {
+        return continuousRedrawEnabled || redrawRequested || !arePipelinesReady || isTimelinePlaying || isNoiseStatisticsReadbackPending() ||
+            memcmp(&screenAndUIState, &lastDrawnState, sizeof(ScreenAndUIState)) != 0 ||
+            (isNoiseTileCacheActive() && !noiseTileCache.isComplete());
+    }
+
     void processEvent(const SDL_Event &event)
     {
         switch(event.type)
@@ -443,12 +2156,14 @@ public:
             break;
         case SDL_KEYDOWN:
             onKeyDown(event.key);
+            redrawRequested = true;
             break;
         case SDL_MOUSEMOTION:
             onMouseMotion(event.motion);
             break;
         case SDL_MOUSEWHEEL:
             onMouseWheel(event.wheel);
+            redrawRequested = true;
             break;
         case SDL_WINDOWEVENT:
             {
@@ -457,6 +2172,10 @@ public:
                 case SDL_WINDOWEVENT_RESIZED:
                 case SDL_WINDOWEVENT_SIZE_CHANGED:
                     recreateSwapChain();
+                    redrawRequested = true;
+                    break;
+                case SDL_WINDOWEVENT_EXPOSED:
+                    redrawRequested = true;
                     break;
                 default:
                     break;
@@ -480,12 +2199,21 @@ public:
         newSwapChainCreateInfo.width = w;
         newSwapChainCreateInfo.height = h;
         newSwapChainCreateInfo.old_swap_chain = swapChain.get();
-        swapChain = device->createSwapChain(commandQueue, &newSwapChainCreateInfo);
+        auto newSwapChain = device->createSwapChain(commandQueue, &newSwapChainCreateInfo);
+        if(!newSwapChain)
+        {
+            // Keep the previous swap chain, and try again when it is presented.
+            fprintf(stderr, "Failed to recreate the swap chain.\n");
+            return;
+        }
 
+        swapChain = newSwapChain;
+        currentSwapChainCreateInfo = newSwapChainCreateInfo;
         displayWidth = swapChain->getWidth();
-        displayWidth = swapChain->getHeight();
-        if(swapChain)
-            currentSwapChainCreateInfo = newSwapChainCreateInfo;
+        displayHeight = swapChain->getHeight();
+
+        // The scaled noise target has the display size.
+        updateScaledNoiseTarget();
     }
 
     void onKeyDown(const SDL_KeyboardEvent &event)
@@ -495,6 +2223,21 @@ public:
         case SDLK_ESCAPE:
             isQuitting = true;
             break;
+        case SDLK_F3:
+            frameTimeGraphVisible = !frameTimeGraphVisible;
+            if(frameTimeGraphVisible)
+                FrameProfiler::get().setEnabled(true);
+            break;
+        case SDLK_F5:
+            isTimelinePlaying = !isTimelinePlaying && !timeline.isEmpty();
+            break;
+        case SDLK_F6:
+            autoRangeEnabled = !autoRangeEnabled;
+            hasNoiseStatisticsState = false;
+            break;
+        case SDLK_F7:
+            noiseCellTableEnabled = !noiseCellTableEnabled;
+            break;
         default:
             break;
         }
@@ -504,212 +2247,683 @@ public:
     {
         if(event.state & SDL_BUTTON_LMASK)
         {
-            hasLeftDragEvent = true;
-            leftDragStartX = event.x;
-            leftDragStartY = event.y;
-            leftDragDeltaX = event.xrel;
-            leftDragDeltaY = event.yrel;
+            auto &input = ui.getInput();
+            input.hasLeftDragEvent = true;
+            input.leftDragStartX = event.x;
+            input.leftDragStartY = event.y;
+            input.leftDragDeltaX = event.xrel;
+            input.leftDragDeltaY = event.yrel;
+            redrawRequested = true;
         }
     }
 
     void onMouseWheel(const SDL_MouseWheelEvent &event)
     {
-        hasWheelEvent = true;
-        wheelDelta = event.y;
+        auto &input = ui.getInput();
+        input.hasWheelEvent = true;
+        input.wheelDelta = event.y;
+    }
+
+    // Writes the state uniforms into the ring buffer, and brings the UI data
+    // buffer of this frame up to date with the retained UI quads.
+    void finishFrameData(FrameResources &frame, size_t frameSlot)
+    {
+        auto stateAllocation = frameDataRingBuffer.allocate(sizeof(ScreenAndUIState));
+        if(stateAllocation.pointer)
+        {
+            memcpy(stateAllocation.pointer, &screenAndUIState, sizeof(ScreenAndUIState));
+            if(isDynamicResolutionActive())
+                reinterpret_cast<ScreenAndUIState*> (stateAllocation.pointer)->resolutionScale = dynamicResolution.getScale();
+        }
+        frame.dataBinding->bindUniformBufferRange(0, stateAllocation.buffer, stateAllocation.offset, stateAllocation.size);
+
+        // The quads are uploaded in their packed encoding, unless the full one was requested.
+        auto &quadCache = ui.getQuadCache();
+        auto quadCount = quadCache.getQuadCount();
+        auto quadStride = packedUIQuadsEnabled ? sizeof(PackedUIElementQuad) : sizeof(UIElementQuad);
+        auto quadData = packedUIQuadsEnabled ? reinterpret_cast<const uint8_t*> (quadCache.getPackedQuads().data()) : reinterpret_cast<const uint8_t*> (quadCache.getQuads().data());
+        if(!frame.uiDataBuffer || quadCount > frame.uiDataBufferCapacity)
+        {
+            auto newCapacity = std::max(std::max(quadCount, frame.uiDataBufferCapacity*2), UIElementQuadBufferInitialCapacity);
+            agpu_buffer_description desc = {};
+            desc.size = (quadStride*newCapacity + 255) & (-256);
+            desc.heap_type = AGPU_MEMORY_HEAP_TYPE_HOST_TO_DEVICE;
+            desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_DESTINATION_BUFFER | AGPU_STORAGE_BUFFER);
+            desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+            desc.mapping_flags = AGPU_MAP_DYNAMIC_STORAGE_BIT;
+            auto newBuffer = device->createBuffer(&desc, nullptr);
+            if(!newBuffer)
+            {
+                fprintf(stderr, "Failed to create the UI data buffer.\n");
+                return;
+            }
+
+            // The previous buffer is released once the binding no longer references it.
+            frame.uiDataBuffer = newBuffer;
+            frame.uiDataBufferCapacity = newCapacity;
+            frame.dataBinding->bindStorageBuffer(1, frame.uiDataBuffer);
+            quadCache.markFrameSlotFullyDirty(frameSlot);
+        }
+
+        // Only upload the quads that changed since this frame slot was last used.
+        for(auto &range : quadCache.getDirtyRanges(frameSlot))
+        {
+            auto end = std::min(range.end, quadCount);
+            if(range.begin >= end)
+                continue;
+
+            auto size = (end - range.begin)*quadStride;
+            frame.uiDataBuffer->uploadBufferData(agpu_size(range.begin*quadStride), agpu_size(size), const_cast<uint8_t*> (quadData + range.begin*quadStride));
+            uiUploadedBytes += size;
+        }
+        quadCache.clearDirtyRanges(frameSlot);
+
+        frame.noiseTileBakeJobCount = 0;
+        if(isNoiseTileCacheActive() && updateNoiseTileAtlas())
+        {
+            auto &jobs = noiseTileCache.update(screenAndUIState);
+            noiseTileBakedOctaveCount += noiseTileCache.getBakedTileOctaveCount();
+            if(!jobs.empty())
+            {
+                auto jobsSize = jobs.size()*sizeof(NoiseTileBakeJob);
+                auto jobsAllocation = frameDataRingBuffer.allocate(jobsSize);
+                if(jobsAllocation.pointer)
+                {
+                    memcpy(jobsAllocation.pointer, jobs.data(), jobsSize);
+                    frame.dataBinding->bindStorageBufferRange(4, jobsAllocation.buffer, jobsAllocation.offset, jobsAllocation.size);
+                    frame.noiseTileBakeJobCount = jobs.size();
+                }
+                else
+                {
+                    // Bake the tiles again once there is memory for the jobs.
+                    noiseTileCache.invalidate();
+                }
+            }
+        }
+
+        // The tile cache bakes with its own shader, so the table is only
+        // used by the noise pass that draws the screen directly.
+        frame.isNoiseCellTableUsed = false;
+        frame.isNoiseCellTableFillRequested = false;
+        if(isNoiseCellTableActive() && !isNoiseTileCacheActive())
+            frame.isNoiseCellTableUsed = updateNoiseCellTable(frame);
+    }
+
+    bool isNoiseCellTableActive() const
+    {
+        return noiseCellTableEnabled && noiseCellTablePipeline;
+    }
+
+    // Lays out the cell table of the view, and requests the fill of the
+    // points of this frame slot when they were filled for another layout.
+    bool updateNoiseCellTable(FrameResources &frame)
+    {
+        if(!createNoiseCellTableBuffer(frame))
+        {
+            fprintf(stderr, "Failed to create the noise cell table buffer, disabling the cell table.\n");
+            noiseCellTableEnabled = false;
+            return false;
+        }
+
+        VoronoiNoiseCellTableHeader header;
+        layoutVoronoiNoiseCellTable(screenAndUIState, header);
+        auto headerAllocation = frameDataRingBuffer.allocate(sizeof(header));
+        if(!headerAllocation.pointer)
+            return false;
+
+        memcpy(headerAllocation.pointer, &header, sizeof(header));
+        frame.dataBinding->bindStorageBufferRange(10, headerAllocation.buffer, headerAllocation.offset, headerAllocation.size);
+        if(memcmp(&header, &frame.noiseCellTableHeader, sizeof(header)) != 0)
+        {
+            frame.noiseCellTableHeader = header;
+            frame.isNoiseCellTableFillRequested = header.pointCount > 0;
+        }
+        return true;
     }
 
-    void drawRectangle(float x, float y, float w, float h, float r, float g, float b, float a)
+    bool createNoiseCellTableBuffer(FrameResources &frame)
     {
-        UIElementQuad quad = {};
-        quad.x = x;
-        quad.y = y;
-        quad.width = w;
-        quad.height = h;
-        
-        quad.r = r;
-        quad.g = g;
-        quad.b = b;
-        quad.a = a;
+        if(frame.noiseCellTablePointsBuffer)
+            return true;
+
+        agpu_buffer_description desc = {};
+        desc.size = agpu_size(VoronoiNoiseCellTableDefaultMaxPointCount*2*sizeof(float));
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        desc.usage_modes = agpu_buffer_usage_mask(AGPU_STORAGE_BUFFER);
+        desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+        frame.noiseCellTablePointsBuffer = device->createBuffer(&desc, nullptr);
+        if(!frame.noiseCellTablePointsBuffer)
+            return false;
 
-        uiElementQuadBuffer.push_back(quad);
+        frame.dataBinding->bindStorageBuffer(11, frame.noiseCellTablePointsBuffer);
+        return true;
     }
 
-    float drawGlyph(char c, float x, float y, float r, float g, float b, float a)
+    bool isNoiseTileCacheActive() const
     {
-        if(c < ' ')
-            return bitmapFontGlyphWidth*bitmapFontScale;
+        return noiseTileCacheEnabled && noiseBakePipeline && cachedScreenQuadPipeline;
+    }
 
-        UIElementQuad quad = {};
-        quad.x = x;
-        quad.y = y;
-        quad.width = bitmapFontGlyphWidth*bitmapFontScale;
-        quad.height = bitmapFontGlyphHeight*bitmapFontScale;
-        
-        quad.r = r;
-        quad.g = g;
-        quad.b = b;
-        quad.a = a;
+    bool isDynamicResolutionActive() const
+    {
+        return dynamicResolution.isEnabled() && upscalePipeline && scaledNoiseFramebuffer;
+    }
 
-        if (' ' <= c && c <= 127)
+    bool isNoiseStatisticsReadbackPending() const
+    {
+        for(size_t i = 0; i < framesInFlightCount; ++i)
         {
-            int index = c - ' ';
-            int column = index % bitmapFontColumns;
-            int row = index / bitmapFontColumns;
-            quad.isGlyph = true;
-            quad.fontX = column * bitmapFontGlyphWidth * bitmapFontInverseWidth;
-            quad.fontY = row * bitmapFontGlyphHeight * bitmapFontInverseHeight;
-            quad.fontWidth = bitmapFontGlyphWidth * bitmapFontInverseWidth;
-            quad.fontHeight = bitmapFontGlyphHeight * bitmapFontInverseHeight;
+            if(frames[i].isNoiseStatisticsPending)
+                return true;
         }
+        return false;
+    }
 
-        uiElementQuadBuffer.push_back(quad);
-        return bitmapFontGlyphWidth*bitmapFontScale;
+    // Whether the view or the noise parameters changed since the statistics
+    // were requested. The thresholds and the colors do not change the noise value.
+    bool isNoiseStatisticsStale() const
+    {
+        auto &current = screenAndUIState;
+        auto &requested = noiseStatisticsState;
+        return !hasNoiseStatisticsState ||
+            current.screenWidth != requested.screenWidth || current.screenHeight != requested.screenHeight ||
+            current.flipVertically != requested.flipVertically || current.screenScale != requested.screenScale ||
+            current.screenOffsetX != requested.screenOffsetX || current.screenOffsetY != requested.screenOffsetY ||
+            current.amplitude != requested.amplitude || current.octaves != requested.octaves || current.lacunarity != requested.lacunarity ||
+            current.voronoiF1 != requested.voronoiF1 || current.voronoiF2 != requested.voronoiF2 ||
+            current.voronoiF3 != requested.voronoiF3 || current.voronoiF4 != requested.voronoiF4;
     }
 
-    float drawString(const std::string &string, float x, float y, float r, float g, float b, float a)
+    // Requests the statistics of the noise value for the auto range, when
+    // they are stale. They are reduced on the GPU and read back once the
+    // frame slot is reused, so the thresholds follow the view a few frames
+    // later without waiting for the GPU. Without compute shaders, they are
+    // computed on the CPU right away.
+    void updateNoiseStatistics(FrameResources &frame)
     {
-        auto sx = x;
-        for(auto c : string)
-            x += drawGlyph(c, x, y, r, g, b, a);
-        return x - sx;
+        frame.isNoiseStatisticsRequested = false;
+        if(!autoRangeEnabled || !arePipelinesReady || !isNoiseStatisticsStale())
+            return;
+
+        noiseStatisticsState = screenAndUIState;
+        hasNoiseStatisticsState = true;
+        if(!noiseStatisticsPipeline || !noiseStatisticsResolvePipeline)
+        {
+            applyAutoRangeWithCPU();
+            return;
+        }
+
+        if(!createNoiseStatisticsBuffers(frame))
+        {
+            fprintf(stderr, "Failed to create the noise statistics buffers, disabling the auto range.\n");
+            autoRangeEnabled = false;
+            return;
+        }
+        frame.isNoiseStatisticsRequested = true;
     }
 
-    float currentLayoutRowX = 0;
-    float currentLayoutRowY = 0;
-    float currentLayoutX = 0;
-    float currentLayoutY = 0;
-    
-    void beginLayout(float x = 5, float y = 5)
+    void readNoiseStatistics(FrameResources &frame)
     {
-        currentLayoutX = currentLayoutRowX = x;
-        currentLayoutY = currentLayoutRowY = y;
+        if(!frame.isNoiseStatisticsPending)
+            return;
+
+        // The fence of the frame has been waited, so this does not stall.
+        frame.isNoiseStatisticsPending = false;
+        frame.noiseStatisticsBuffer->readBufferData(0, sizeof(VoronoiNoiseStatistics), &noiseStatistics);
+        if(autoRangeEnabled)
+            applyVoronoiNoiseAutoRange(noiseStatistics, screenAndUIState);
     }
 
-    void advanceLayoutRow()
+    void applyAutoRangeWithCPU()
     {
-        currentLayoutRowY += bitmapFontGlyphHeight * bitmapFontScale + 5;
-        currentLayoutX = currentLayoutRowX;
-        currentLayoutY = currentLayoutRowY;
+        SHADER_VIS_PROFILE_ZONE("Noise statistics");
+        auto step = getVoronoiNoiseStatisticsSampleStep(screenAndUIState.screenWidth, screenAndUIState.screenHeight);
+        computeVoronoiNoiseStatistics(screenAndUIState, step, noiseStatistics);
+        applyVoronoiNoiseAutoRange(noiseStatistics, screenAndUIState);
     }
 
-    void sliderForFloat(const std::string &label, float minValue, float maxValue, float &value)
+    bool createNoiseStatisticsBuffers(FrameResources &frame)
     {
-        currentLayoutX += drawString(label, currentLayoutX, currentLayoutY, 1.0, 1.0, 1.0, 0.6);
+        if(frame.noiseStatisticsBuffer)
+            return true;
+
+        // A partial result per workgroup, of which there are at most 16x16.
+        auto workgroupsPerSide = VoronoiNoiseStatisticsMaxGridSize / NoiseStatisticsWorkgroupSide;
+        agpu_buffer_description desc = {};
+        desc.size = agpu_size(workgroupsPerSide*workgroupsPerSide*sizeof(VoronoiNoiseStatistics));
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        desc.usage_modes = agpu_buffer_usage_mask(AGPU_STORAGE_BUFFER);
+        desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+        frame.noiseStatisticsPartialBuffer = device->createBuffer(&desc, nullptr);
+
+        desc.size = agpu_size((sizeof(VoronoiNoiseStatistics) + 255) & (-256));
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_TO_HOST;
+        desc.usage_modes = agpu_buffer_usage_mask(AGPU_COPY_SOURCE_BUFFER | AGPU_STORAGE_BUFFER);
+        desc.main_usage_mode = AGPU_STORAGE_BUFFER;
+        desc.mapping_flags = AGPU_MAP_READ_BIT;
+        frame.noiseStatisticsBuffer = device->createBuffer(&desc, nullptr);
+        if(!frame.noiseStatisticsPartialBuffer || !frame.noiseStatisticsBuffer)
+        {
+            frame.noiseStatisticsPartialBuffer.reset();
+            frame.noiseStatisticsBuffer.reset();
+            return false;
+        }
 
-        float sliderHeight = bitmapFontGlyphHeight * bitmapFontScale;
-        float sliderWidth = 80;
+        frame.dataBinding->bindStorageBuffer(8, frame.noiseStatisticsPartialBuffer);
+        frame.dataBinding->bindStorageBuffer(9, frame.noiseStatisticsBuffer);
+        return true;
+    }
 
-        float alpha = (std::min(std::max(value, minValue), maxValue) - minValue) / (maxValue - minValue);
+    // Creates the color buffer of the noise pass with the display size. The
+    // noise is drawn into its top left part, at the scale of the frame.
+    bool updateScaledNoiseTarget()
+    {
+        if(!dynamicResolution.isEnabled())
+            return false;
+        if(scaledNoiseFramebuffer && scaledNoiseWidth == displayWidth && scaledNoiseHeight == displayHeight)
+            return true;
 
-        drawRectangle(currentLayoutX, currentLayoutY, sliderWidth, sliderHeight, 1.0, 1.0, 1.0, 0.6);
+        // The frames in flight may still read the previous color buffer. This
+        // only happens when the window is resized.
+        if(scaledNoiseFramebuffer)
+            commandQueue->finishExecution();
+        scaledNoiseFramebuffer.reset();
 
-        if(hasLeftDragEvent && !hasHandledLeftDragEvent &&
-            currentLayoutY <= leftDragStartY && leftDragStartY <= currentLayoutY + sliderHeight &&
-            currentLayoutX <= leftDragStartX && leftDragStartX <= currentLayoutX + sliderWidth)
+        agpu_texture_description desc = {};
+        desc.type = AGPU_TEXTURE_2D;
+        desc.format = colorBufferFormat;
+        desc.width = displayWidth;
+        desc.height = displayHeight;
+        desc.depth = 1;
+        desc.layers = 1;
+        desc.miplevels = 1;
+        desc.sample_count = 1;
+        desc.sample_quality = 0;
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        desc.usage_modes = agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_COLOR_ATTACHMENT | AGPU_TEXTURE_USAGE_SAMPLED);
+        desc.main_usage_mode = AGPU_TEXTURE_USAGE_SAMPLED;
+        scaledNoiseColorBuffer = device->createTexture(&desc);
+        if(!scaledNoiseColorBuffer)
         {
-            if(leftDragDeltaX != 0)
-            {
-                float deltaAlpha = leftDragDeltaX / sliderWidth;
-                alpha = std::min(std::max(alpha + deltaAlpha, 0.0f), 1.0f);
-                value = minValue + (maxValue - minValue)*alpha;
-            }
+            fprintf(stderr, "Failed to create the scaled noise color buffer, drawing the noise at the full resolution.\n");
+            dynamicResolution.setTargetSeconds(0);
+            return false;
+        }
 
-            hasHandledLeftDragEvent = true;
+        auto colorBufferView = scaledNoiseColorBuffer->getOrCreateFullView();
+        scaledNoiseFramebuffer = device->createFrameBuffer(displayWidth, displayHeight, 1, &colorBufferView, nullptr);
+        if(!scaledNoiseFramebuffer)
+        {
+            fprintf(stderr, "Failed to create the scaled noise framebuffer, drawing the noise at the full resolution.\n");
+            dynamicResolution.setTargetSeconds(0);
+            return false;
         }
 
-        float sliderBarWidth = 4;
-        drawRectangle(currentLayoutX + (sliderWidth - sliderBarWidth)*alpha, currentLayoutY, sliderBarWidth, sliderHeight, 0.0, 1.0, 0.0, 1.0);
+        scaledNoiseWidth = displayWidth;
+        scaledNoiseHeight = displayHeight;
+        for(auto &frame : frames)
+            frame.dataBinding->bindSampledTextureView(5, colorBufferView);
+        return true;
+    }
+
+    // Creates the atlas texture with the size that is needed by the viewport.
+    bool updateNoiseTileAtlas()
+    {
+        if(!noiseTileCache.setViewportSize(screenAndUIState.screenWidth, screenAndUIState.screenHeight) && noiseTileAtlas)
+            return true;
+
+        // The frames in flight may still read the previous atlas. This only
+        // happens when the window is resized.
+        if(noiseTileAtlas)
+            commandQueue->finishExecution();
+
+        agpu_texture_description desc = {};
+        desc.type = AGPU_TEXTURE_2D;
+        desc.format = AGPU_TEXTURE_FORMAT_R16G16B16A16_FLOAT;
+        desc.width = noiseTileCache.getAtlasWidth();
+        desc.height = noiseTileCache.getAtlasHeight();
+        desc.depth = 1;
+        desc.layers = 1;
+        desc.miplevels = 1;
+        desc.sample_count = 1;
+        desc.sample_quality = 0;
+        desc.heap_type = AGPU_MEMORY_HEAP_TYPE_DEVICE_LOCAL;
+        desc.usage_modes = agpu_texture_usage_mode_mask(AGPU_TEXTURE_USAGE_STORAGE);
+        desc.main_usage_mode = AGPU_TEXTURE_USAGE_STORAGE;
+        noiseTileAtlas = device->createTexture(&desc);
+        if(!noiseTileAtlas)
+        {
+            fprintf(stderr, "Failed to create the noise tile atlas, drawing the noise directly.\n");
+            noiseTileCacheEnabled = false;
+            return false;
+        }
 
-        currentLayoutX += sliderWidth;
-        currentLayoutX += 5;
+        auto atlasView = noiseTileAtlas->getOrCreateFullView();
+        for(auto &frame : frames)
+            frame.dataBinding->bindStorageImageView(3, atlasView);
+        return true;
     }
 
-    void updateAndRender(float delta)
+    // Immediate UI, backed by the retained quad cache.
+    void updateUI()
     {
-        uiElementQuadBuffer.clear();
+        SHADER_VIS_PROFILE_ZONE("UI");
+        ui.beginFrame();
+        parameterPanel(ui, screenAndUIState);
+
+        for(auto &errorLog : shaderReloadErrorLogs)
+        {
+            if(!errorLog.empty())
+                ui.textOverlay(errorLog, 5, displayHeight - 5, 1.0, 0.3, 0.3, 1.0);
+        }
+        if(denseTextBenchmarkEnabled)
+            denseTextOverlay(ui, float(displayWidth), float(displayHeight), benchmarkFrameIndex);
+        if(isDynamicResolutionActive())
+            dynamicResolutionOverlay();
+        if(autoRangeEnabled)
+            autoRangeOverlay();
+        if(frameTimeGraphVisible)
+            frameTimeGraph(displayWidth - FrameTimeHistorySize*FrameTimeGraphBarWidth - 5, displayHeight - FrameTimeGraphHeight - 5);
+        ui.endFrame();
+        uiRegeneratedWidgetCount += ui.getQuadCache().getRegeneratedWidgetCount();
+    }
 
-        // Immediate UI
-        beginLayout(5, 5);
-        sliderForFloat("F1", -1, 1, screenAndUIState.voronoiF1);
-        sliderForFloat("F2", -1, 1, screenAndUIState.voronoiF2);
-        sliderForFloat("F3", -1, 1, screenAndUIState.voronoiF3);
-        sliderForFloat("F4", -1, 1, screenAndUIState.voronoiF4);
+    void dynamicResolutionOverlay()
+    {
+        auto scale = dynamicResolution.getScale();
+        char text[128];
+        snprintf(text, sizeof(text), "Noise resolution %d%% (%ux%u), target %.1f ms",
+            int(scale*100.0f + 0.5f), DynamicResolutionController::getScaledSize(displayWidth, scale), DynamicResolutionController::getScaledSize(displayHeight, scale),
+            dynamicResolution.getTargetSeconds()*1000.0f);
+        auto &fontMetrics = ui.getFontMetrics();
+        ui.textOverlay(text, displayWidth - fontMetrics.measureString(text, strlen(text)) - 5, 5 + fontMetrics.getLineHeight(), 1.0, 1.0, 1.0, 0.9);
+    }
 
-        advanceLayoutRow();
-        sliderForFloat("Amplitude", 0, 2, screenAndUIState.amplitude);
-        sliderForFloat("Lacunarity", 0, 5, screenAndUIState.lacunarity);
-        sliderForFloat("Octaves", 1, 8, screenAndUIState.octaves);
+    void autoRangeOverlay()
+    {
+        char text[128];
+        snprintf(text, sizeof(text), "Auto range %.3f to %.3f, noise %.3f to %.3f, mean %.3f",
+            screenAndUIState.startThreshold, screenAndUIState.endThreshold, noiseStatistics.minimum, noiseStatistics.maximum, noiseStatistics.mean);
+        auto &fontMetrics = ui.getFontMetrics();
+        ui.textOverlay(text, displayWidth - fontMetrics.measureString(text, strlen(text)) - 5, 5 + 2*fontMetrics.getLineHeight(), 1.0, 1.0, 1.0, 0.9);
+    }
 
-        advanceLayoutRow();
-        sliderForFloat("S", -1, 1, screenAndUIState.startThreshold);
-        sliderForFloat("R", 0, 1, screenAndUIState.startColorRed);
-        sliderForFloat("G", 0, 1, screenAndUIState.startColorGreen);
-        sliderForFloat("B", 0, 1, screenAndUIState.startColorBlue);
+    void updateAndRender(float delta)
+    {
+        SHADER_VIS_PROFILE_ZONE("Update and render");
+        // Wait for the GPU to release the resources of this frame, instead
+        // of waiting for the whole queue.
+        auto &frame = frames[currentFrameIndex];
+        waitForFrame(frame);
+        frameDataRingBuffer.beginFrame(currentFrameIndex);
+        releaseRetiredPipelines();
+        readNoiseStatistics(frame);
+
+        // The timeline loops, and the sliders show the animated values.
+        if(isTimelinePlaying)
+        {
+            auto duration = timeline.getDuration();
+            timelineTime += delta;
+            if(timelineTime > duration)
+                timelineTime = duration > 0 ? fmodf(timelineTime, duration) : 0;
+            timeline.evaluate(timelineTime, screenAndUIState);
+        }
 
-        advanceLayoutRow();
-        sliderForFloat("E", -1, 1, screenAndUIState.endThreshold);
-        sliderForFloat("R", 0, 1, screenAndUIState.endColorRed);
-        sliderForFloat("G", 0, 1, screenAndUIState.endColorGreen);
-        sliderForFloat("B", 0, 1, screenAndUIState.endColorBlue);
+        updateUI();
 
         // Left drag.
-        if(hasLeftDragEvent && !hasHandledLeftDragEvent)
+        auto &input = ui.getInput();
+        if(input.hasLeftDragEvent && !input.hasHandledLeftDragEvent)
         {
             float scaleFactor = screenAndUIState.screenScale;
-            screenAndUIState.screenOffsetX += leftDragDeltaX/float(screenAndUIState.screenWidth)*scaleFactor;
-            screenAndUIState.screenOffsetY -= leftDragDeltaY/float(screenAndUIState.screenHeight)*scaleFactor;
+            screenAndUIState.screenOffsetX += input.leftDragDeltaX/float(screenAndUIState.screenWidth)*scaleFactor;
+            screenAndUIState.screenOffsetY -= input.leftDragDeltaY/float(screenAndUIState.screenHeight)*scaleFactor;
         }
 
         // Mouse wheel.
-        if(hasWheelEvent && !hasHandledWheelEvent)
+        if(input.hasWheelEvent && !input.hasHandledWheelEvent)
         {
-            if(wheelDelta > 0)
+            if(input.wheelDelta > 0)
                 screenAndUIState.screenScale /= 1.1;
-            else if(wheelDelta < 0)
+            else if(input.wheelDelta < 0)
                 screenAndUIState.screenScale *= 1.1;
         }
 
-        // Upload the data buffers.
-        screenAndUIStateUniformBuffer->uploadBufferData(0, sizeof(screenAndUIState), &screenAndUIState);
-        uiDataBuffer->uploadBufferData(0, uiElementQuadBuffer.size() * sizeof(UIElementQuad), uiElementQuadBuffer.data());
+        updateNoiseStatistics(frame);
+
+        {
+            SHADER_VIS_PROFILE_ZONE("Upload frame data");
+            updateScaledNoiseTarget();
+            finishFrameData(frame, currentFrameIndex);
+            frameDataRingBuffer.endFrame(currentFrameIndex);
+        }
 
         // Build the command list
+        recordRenderCommands(frame, swapChain->getCurrentBackBuffer());
+
+        // Queue the command list
+        {
+            SHADER_VIS_PROFILE_ZONE("Submit");
+            commandQueue->addCommandList(frame.commandList);
+            commandQueue->signalFence(frame.fence);
+            frame.isInFlight = true;
+        }
+
+        swapBuffers();
+        currentFrameIndex = (currentFrameIndex + 1) % framesInFlightCount;
+    }
+
+    void waitForFrame(FrameResources &frame)
+    {
+        if(!frame.isInFlight)
+            return;
+
+        // agpu has no timestamp queries, so the time blocked on the fence is
+        // what shows when the GPU is the bottleneck.
+        SHADER_VIS_PROFILE_ZONE("Wait for frame");
+        auto startCounter = SDL_GetPerformanceCounter();
+        frame.fence->waitOnClient();
+        frame.isInFlight = false;
+        lastFrameWaitSeconds = float(secondsSince(startCounter));
+    }
+
+    void recordFrameTime(float frameSeconds)
+    {
+        frameTimeHistory[frameTimeHistoryIndex] = frameSeconds;
+        frameWaitTimeHistory[frameTimeHistoryIndex] = lastFrameWaitSeconds;
+        frameTimeHistoryIndex = (frameTimeHistoryIndex + 1) % FrameTimeHistorySize;
+        lastFrameWaitSeconds = 0;
+    }
+
+    // Rolling graph of the latest frame times, where the part of each frame
+    // that was spent waiting for the GPU is drawn in red.
+    void frameTimeGraph(float x, float y)
+    {
+        UIWidgetKey key;
+        key.label = "Frame time graph";
+        key.x = x;
+        key.y = y;
+        key.value = float(frameTimeHistoryIndex);
+        if(!ui.getQuadCache().beginWidget(key))
+            return;
+
+        static constexpr float GraphMaxMilliseconds = 50.0f;
+        auto graphWidth = FrameTimeHistorySize*FrameTimeGraphBarWidth;
+        ui.drawRectangle(x, y, graphWidth, FrameTimeGraphHeight, 0.0, 0.0, 0.0, 0.6);
+
+        float frameTimeSum = 0;
+        float maxFrameTime = 0;
+        for(size_t i = 0; i < FrameTimeHistorySize; ++i)
+        {
+            auto historyIndex = (frameTimeHistoryIndex + i) % FrameTimeHistorySize;
+            auto frameMilliseconds = frameTimeHistory[historyIndex] * 1000.0f;
+            auto waitMilliseconds = std::min(frameWaitTimeHistory[historyIndex] * 1000.0f, frameMilliseconds);
+            frameTimeSum += frameMilliseconds;
+            maxFrameTime = std::max(maxFrameTime, frameMilliseconds);
+
+            auto barHeight = std::min(frameMilliseconds / GraphMaxMilliseconds, 1.0f) * FrameTimeGraphHeight;
+            auto waitHeight = std::min(waitMilliseconds / GraphMaxMilliseconds, 1.0f) * FrameTimeGraphHeight;
+            auto barX = x + i*FrameTimeGraphBarWidth;
+            auto barBottom = y + FrameTimeGraphHeight;
+            ui.drawRectangle(barX, barBottom - barHeight, FrameTimeGraphBarWidth, barHeight - waitHeight, 0.2, 0.9, 0.2, 0.9);
+            if(waitHeight > 0)
+                ui.drawRectangle(barX, barBottom - waitHeight, FrameTimeGraphBarWidth, waitHeight, 0.9, 0.2, 0.2, 0.9);
+        }
+
+        // Reference lines at 60 and 30 FPS.
+        auto sixtyFPSY = y + FrameTimeGraphHeight*(1.0f - 1000.0f/60.0f/GraphMaxMilliseconds);
+        auto thirtyFPSY = y + FrameTimeGraphHeight*(1.0f - 1000.0f/30.0f/GraphMaxMilliseconds);
+        ui.drawRectangle(x, sixtyFPSY, graphWidth, 1, 1.0, 1.0, 1.0, 0.5);
+        ui.drawRectangle(x, thirtyFPSY, graphWidth, 1, 1.0, 1.0, 0.0, 0.5);
+
+        char text[64];
+        snprintf(text, sizeof(text), "%.2f ms avg %.2f ms max", frameTimeSum / FrameTimeHistorySize, maxFrameTime);
+        ui.drawString(text, x, y - ui.getFontMetrics().getLineHeight(), 1.0, 1.0, 1.0, 0.9);
+        ui.getQuadCache().endWidget();
+    }
+
+    void reportFrameTime(bool hasDrawnFrame)
+    {
+        if(hasDrawnFrame)
+            ++frameTimeReportFrameCount;
+        auto counter = SDL_GetPerformanceCounter();
+        double elapsedSeconds = double(counter - frameTimeReportStartCounter) / double(SDL_GetPerformanceFrequency());
+        if(elapsedSeconds < 1.0)
+            return;
+
+        // Includes the shader compilation and hot reload threads.
+        auto cpuSeconds = FrameProfiler::getProcessCPUSeconds();
+        printf("CPU usage: %.1f%% of a core, %u frames drawn\n",
+            (cpuSeconds - frameTimeReportStartCPUSeconds) * 100.0 / elapsedSeconds, frameTimeReportFrameCount);
+        frameTimeReportStartCPUSeconds = cpuSeconds;
+        if(frameTimeReportFrameCount == 0)
+        {
+            frameTimeReportStartCounter = counter;
+            return;
+        }
+
+        printf("Frame time: %.3f ms (%.1f FPS, %d frames in flight) UI: %.1f widgets regenerated, %.0f bytes uploaded per frame\n",
+            elapsedSeconds * 1000.0 / frameTimeReportFrameCount, frameTimeReportFrameCount / elapsedSeconds,
+            int(framesInFlightCount),
+            double(uiRegeneratedWidgetCount) / frameTimeReportFrameCount, double(uiUploadedBytes) / frameTimeReportFrameCount);
+        if(isNoiseTileCacheActive())
+        {
+            printf("Noise tile cache: %.1f tile octaves baked per frame, %u of %d octaves refined\n",
+                double(noiseTileBakedOctaveCount) / frameTimeReportFrameCount,
+                noiseTileCache.getRefinedOctaves(), std::max(1, int(screenAndUIState.octaves)));
+        }
+        frameTimeReportFrameCount = 0;
+        noiseTileBakedOctaveCount = 0;
+        uiRegeneratedWidgetCount = 0;
+        uiUploadedBytes = 0;
+        frameTimeReportStartCounter = counter;
+    }
+
+    void recordRenderCommands(FrameResources &frame, const agpu_framebuffer_ref &framebuffer)
+    {
+        SHADER_VIS_PROFILE_ZONE("Record commands");
+        auto &commandAllocator = frame.commandAllocator;
+        auto &commandList = frame.commandList;
         commandAllocator->reset();
         commandList->reset(commandAllocator, nullptr);
 
-        auto backBuffer = swapChain->getCurrentBackBuffer();
-
         commandList->setShaderSignature(shaderSignature);
-        commandList->beginRenderPass(mainRenderPass, backBuffer, false);
+
+        // Reduce the statistics of the noise value in two passes, so that
+        // only the final ones are read back.
+        if(frame.isNoiseStatisticsRequested)
+        {
+            auto step = getVoronoiNoiseStatisticsSampleStep(screenAndUIState.screenWidth, screenAndUIState.screenHeight);
+            auto gridWidth = std::max(screenAndUIState.screenWidth / step, 1u);
+            auto gridHeight = std::max(screenAndUIState.screenHeight / step, 1u);
+            commandList->usePipelineState(noiseStatisticsPipeline);
+            commandList->useComputeShaderResources(frame.dataBinding);
+            commandList->dispatchCompute((gridWidth + NoiseStatisticsWorkgroupSide - 1) / NoiseStatisticsWorkgroupSide, (gridHeight + NoiseStatisticsWorkgroupSide - 1) / NoiseStatisticsWorkgroupSide, 1);
+            commandList->memoryBarrier(AGPU_PIPELINE_STAGE_COMPUTE_SHADER, AGPU_PIPELINE_STAGE_COMPUTE_SHADER, AGPU_ACCESS_SHADER_WRITE, AGPU_ACCESS_SHADER_READ);
+            commandList->usePipelineState(noiseStatisticsResolvePipeline);
+            commandList->dispatchCompute(1, 1, 1);
+            frame.isNoiseStatisticsPending = true;
+        }
+
+        // Hash the feature points of the cells of the view, when they are not
+        // the ones that this frame slot already has.
+        if(frame.isNoiseCellTableFillRequested)
+        {
+            auto pointCount = frame.noiseCellTableHeader.pointCount;
+            commandList->usePipelineState(noiseCellTablePipeline);
+            commandList->useComputeShaderResources(frame.dataBinding);
+            commandList->dispatchCompute((pointCount + NoiseCellTableWorkgroupSize - 1) / NoiseCellTableWorkgroupSize, 1, 1);
+            commandList->memoryBarrier(AGPU_PIPELINE_STAGE_COMPUTE_SHADER, AGPU_PIPELINE_STAGE_FRAGMENT_SHADER, AGPU_ACCESS_SHADER_WRITE, AGPU_ACCESS_SHADER_READ);
+        }
+
+        // Bake the noise tiles that are missing or not fully refined.
+        bool isNoiseTileCacheUsed = isNoiseTileCacheActive() && noiseTileAtlas;
+        if(isNoiseTileCacheUsed && frame.noiseTileBakeJobCount > 0)
+        {
+            // The previous frame may still be sampling the atlas.
+            commandList->memoryBarrier(AGPU_PIPELINE_STAGE_FRAGMENT_SHADER, AGPU_PIPELINE_STAGE_COMPUTE_SHADER, AGPU_ACCESS_SHADER_READ, AGPU_ACCESS_SHADER_WRITE);
+            commandList->usePipelineState(noiseBakePipeline);
+            commandList->useComputeShaderResources(frame.dataBinding);
+            commandList->dispatchCompute(NoiseTileCache::TileSize / 8, NoiseTileCache::TileSize / 8, agpu_uint(frame.noiseTileBakeJobCount));
+            commandList->memoryBarrier(AGPU_PIPELINE_STAGE_COMPUTE_SHADER, AGPU_PIPELINE_STAGE_FRAGMENT_SHADER, AGPU_ACCESS_SHADER_WRITE, AGPU_ACCESS_SHADER_READ);
+        }
+
+        // Draw the screen quad. It is missing while the pipelines are still compiling.
+        // With dynamic resolution, it is drawn into the top left part of the
+        // scaled noise color buffer, which is then stretched over the screen.
+        auto &noisePipeline = isNoiseTileCacheUsed ? cachedScreenQuadPipeline : getNoisePipeline(screenAndUIState, frame.isNoiseCellTableUsed);
+        bool isNoiseScaled = isDynamicResolutionActive() && noisePipeline;
+        if(isNoiseScaled)
+        {
+            auto scale = dynamicResolution.getScale();
+            auto scaledWidth = DynamicResolutionController::getScaledSize(displayWidth, scale);
+            auto scaledHeight = DynamicResolutionController::getScaledSize(displayHeight, scale);
+            commandList->beginRenderPass(mainRenderPass, scaledNoiseFramebuffer, false);
+            commandList->setViewport(0, 0, scaledWidth, scaledHeight);
+            commandList->setScissor(0, 0, scaledWidth, scaledHeight);
+            commandList->useShaderResources(samplersBinding);
+            commandList->useShaderResources(frame.dataBinding);
+            commandList->usePipelineState(noisePipeline);
+            commandList->drawArrays(3, 1, 0, 0);
+
+            // The render pass returns the color buffer to its main usage, for sampling.
+            commandList->endRenderPass();
+        }
+
+        commandList->beginRenderPass(mainRenderPass, framebuffer, false);
 
         commandList->setViewport(0, 0, displayWidth, displayHeight);
         commandList->setScissor(0, 0, displayWidth, displayHeight);
 
-        // Draw the screen quad.
-        commandList->usePipelineState(screenQuadPipeline);
         commandList->useShaderResources(samplersBinding);
-        commandList->useShaderResources(dataBinding);
+        commandList->useShaderResources(frame.dataBinding);
 
-        // Draw the objects
-        commandList->drawArrays(3, 1, 0, 0);
+        if(isNoiseScaled)
+        {
+            commandList->usePipelineState(upscalePipeline);
+            commandList->drawArrays(3, 1, 0, 0);
+        }
+        else if(noisePipeline)
+        {
+            commandList->usePipelineState(noisePipeline);
+            commandList->drawArrays(3, 1, 0, 0);
+        }
 
         // UI element pipeline
-        commandList->usePipelineState(uiPipeline);
-        commandList->drawArrays(4, uiElementQuadBuffer.size(), 0, 0);
+        if(uiPipeline && ui.getQuadCache().getQuadCount() > 0)
+        {
+            commandList->usePipelineState(uiPipeline);
+            commandList->drawArrays(4, agpu_uint(ui.getQuadCache().getQuadCount()), 0, 0);
+        }
 
         // Finish the command list
         commandList->endRenderPass();
         commandList->close();
-
-        // Queue the command list
-        commandQueue->addCommandList(commandList);
-
-        swapBuffers();
-        commandQueue->finishExecution();
     }
 
     void swapBuffers()
     {
+        SHADER_VIS_PROFILE_ZONE("Swap buffers");
         auto errorCode = agpuSwapBuffers(swapChain.get());
         if(!errorCode)
             return;
@@ -719,6 +2933,35 @@ public:
     }
 
     agpu_texture_ref loadTexture(const char *fileName, bool nonColorData)
+    {
+        // The pre-converted texture is uploaded straight from its mapping.
+        const uint8_t *bundledTexture = nullptr;
+        size_t bundledTextureSize = 0;
+        RawTextureView rawTexture;
+        if(assetBundle.isOpen() && assetBundle.findAsset(fileName, AssetKind::RawTexture, bundledTexture, bundledTextureSize) &&
+            parseRawTexture(bundledTexture, bundledTextureSize, rawTexture))
+            return createTextureWithBGRA8Pixels(rawTexture.width, rawTexture.height, rawTexture.pitch, rawTexture.pixels, nonColorData);
+
+        MappedFile rawTextureFile;
+        auto rawTextureFileName = getRawTextureFileName(fileName);
+        if(MappedFile::exists(rawTextureFileName) && rawTextureFile.open(rawTextureFileName))
+        {
+            if(parseRawTexture(rawTextureFile.data(), rawTextureFile.size(), rawTexture))
+                return createTextureWithBGRA8Pixels(rawTexture.width, rawTexture.height, rawTexture.pitch, rawTexture.pixels, nonColorData);
+
+            fprintf(stderr, "Invalid raw texture %s, decoding %s instead.\n", rawTextureFileName.c_str(), fileName);
+        }
+
+        auto convertedSurface = loadBMPWithBGRA8Pixels(fileName);
+        if (!convertedSurface)
+            return nullptr;
+
+        auto texture = createTextureWithBGRA8Pixels(convertedSurface->w, convertedSurface->h, convertedSurface->pitch, convertedSurface->pixels, nonColorData);
+        SDL_FreeSurface(convertedSurface);
+        return texture;
+    }
+
+    SDL_Surface *loadBMPWithBGRA8Pixels(const char *fileName)
     {
         auto surface = SDL_LoadBMP(fileName);
         if (!surface)
@@ -726,15 +2969,17 @@ public:
 
         auto convertedSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
         SDL_FreeSurface(surface);
-        if (!convertedSurface)
-            return nullptr;
+        return convertedSurface;
+    }
 
+    agpu_texture_ref createTextureWithBGRA8Pixels(uint32_t width, uint32_t height, uint32_t pitch, const void *pixels, bool nonColorData)
+    {
         auto format = nonColorData ? AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM : AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM_SRGB;
         agpu_texture_description desc = {};
         desc.type = AGPU_TEXTURE_2D;
         desc.format = format;
-        desc.width = convertedSurface->w;
-        desc.height = convertedSurface->h;
+        desc.width = width;
+        desc.height = height;
         desc.depth = 1;
         desc.layers = 1;
         desc.miplevels = 1;
@@ -746,27 +2991,106 @@ public:
 
         agpu_texture_ref texture = device->createTexture(&desc);
         if (!texture)
-        {
-            SDL_FreeSurface(convertedSurface);
             return nullptr;
-        }
 
-        texture->uploadTextureData(0, 0, convertedSurface->pitch, convertedSurface->pitch*convertedSurface->h, convertedSurface->pixels);
-        SDL_FreeSurface(convertedSurface);
+        texture->uploadTextureData(0, 0, pitch, pitch*height, const_cast<void*> (pixels));
         return texture;
     }
 
+    // Converts an image into a raw texture that is loaded without decoding.
+    int convertTextureMain(const std::string &inputFileName, const std::string &outputFileName)
+    {
+        auto surface = loadBMPWithBGRA8Pixels(inputFileName.c_str());
+        if(!surface)
+        {
+            fprintf(stderr, "Failed to load the image %s.\n", inputFileName.c_str());
+            return 1;
+        }
+
+        bool succeeded = writeRawTexture(outputFileName, RawTextureFormat::BGRA8, surface->w, surface->h, surface->pitch, surface->pixels);
+        SDL_FreeSurface(surface);
+        return succeeded ? 0 : 1;
+    }
+
+    // Packs the given asset files into one bundle. The images are stored as
+    // raw textures, and with -pack-shader-binaries the startup shaders are
+    // also compiled for the selected device and stored next to their sources.
+    int packAssetsMain(agpu_uint platformIndex, agpu_uint gpuIndex, bool debugLayerEnabled)
+    {
+        isHeadless = true;
+        bool shaderBinariesEnabled = packedShaderBinariesEnabled && openHeadlessDevice(platformIndex, gpuIndex, debugLayerEnabled);
+        if(packedShaderBinariesEnabled && !shaderBinariesEnabled)
+            fprintf(stderr, "The shader binaries are not packed without a device.\n");
+        createShaderCompileJobs();
+
+        AssetBundleWriter writer;
+        for(auto &fileName : packedAssetFileNames)
+        {
+            if(fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".bmp") == 0)
+            {
+                auto surface = loadBMPWithBGRA8Pixels(fileName.c_str());
+                std::vector<uint8_t> encodedTexture;
+                bool isEncoded = surface && encodeRawTexture(RawTextureFormat::BGRA8, surface->w, surface->h, surface->pitch, surface->pixels, encodedTexture);
+                if(surface)
+                    SDL_FreeSurface(surface);
+                if(!isEncoded)
+                {
+                    fprintf(stderr, "Failed to convert the image %s.\n", fileName.c_str());
+                    return 1;
+                }
+
+                writer.addAsset(fileName, AssetKind::RawTexture, encodedTexture.data(), encodedTexture.size());
+                continue;
+            }
+
+            MappedFile file;
+            if(!file.open(fileName))
+                return 1;
+            writer.addAsset(fileName, AssetKind::File, file.data(), file.size());
+            if(!shaderBinariesEnabled)
+                continue;
+
+            for(auto &job : shaderCompileJobs)
+            {
+                if(fileName != job.fileName)
+                    continue;
+
+                auto shaderCompiler = runOfflineShaderCompiler(fileName, file.chars(), file.size(), job.type);
+                if(!shaderCompiler)
+                    return 1;
+
+                std::vector<uint8_t> binary(shaderCompiler->getCompilationResultLength());
+                if(binary.empty() || shaderCompiler->getCompilationResult(binary.size(), binary.data()))
+                {
+                    fprintf(stderr, "Failed to get the binary of %s.\n", fileName.c_str());
+                    return 1;
+                }
+
+                auto cacheKey = shaderBinaryCache.computeKey(file.chars(), file.size(), job.type);
+                writer.addAsset(getShaderBinaryAssetName(cacheKey), AssetKind::ShaderBinary, binary.data(), binary.size());
+                break;
+            }
+        }
+
+        if(!writer.write(packedAssetBundleFileName))
+            return 1;
+        printf("Packed %zu assets into %s\n", writer.getAssetCount(), packedAssetBundleFileName.c_str());
+        return 0;
+    }
+
     SDL_Window *window = nullptr;
     bool isQuitting = false;
 
+    bool isHeadless = false;
+    bool cpuRenderingForced = false;
+    std::string headlessOutputFileName;
+
     agpu_texture_format colorBufferFormat = AGPU_TEXTURE_FORMAT_B8G8R8A8_UNORM;
 
     agpu_device_ref device;
     agpu_command_queue_ref commandQueue;
     agpu_renderpass_ref mainRenderPass;
     agpu_shader_signature_ref shaderSignature;
-    agpu_command_allocator_ref commandAllocator;
-    agpu_command_list_ref commandList;
     agpu_swap_chain_create_info currentSwapChainCreateInfo;
     agpu_swap_chain_ref swapChain;
 
@@ -778,36 +3102,159 @@ public:
     agpu_shader_ref uiElementFragment;
     agpu_pipeline_state_ref uiPipeline;
 
+    agpu_shader_ref noiseBakeShader;
+    agpu_pipeline_state_ref noiseBakePipeline;
+
+    agpu_shader_ref noiseSweepShader;
+    agpu_pipeline_state_ref noiseSweepPipeline;
+
+    agpu_shader_ref noiseStatisticsShader;
+    agpu_pipeline_state_ref noiseStatisticsPipeline;
+    agpu_shader_ref noiseStatisticsResolveShader;
+    agpu_pipeline_state_ref noiseStatisticsResolvePipeline;
+
+    agpu_shader_ref noiseCellTableShader;
+    agpu_pipeline_state_ref noiseCellTablePipeline;
+
+    agpu_shader_ref cachedScreenQuadVertex;
+    agpu_shader_ref cachedScreenQuadFragment;
+    agpu_pipeline_state_ref cachedScreenQuadPipeline;
+
+    agpu_shader_ref upscaleVertex;
+    agpu_shader_ref upscaleFragment;
+    agpu_pipeline_state_ref upscalePipeline;
+
+    // The specialized noise pipelines, by variant key.
+    bool noiseVariantsEnabled = true;
+    bool noiseVariantBenchmarkEnabled = false;
+
+    // The feature points are fetched from a cell table that is filled per frame slot.
+    bool noiseCellTableEnabled = false;
+    bool noiseCellTableBenchmarkEnabled = false;
+    bool isNoiseShaderSourceReloaded = false;
+    std::unordered_map<uint32_t, agpu_pipeline_state_ref> noiseVariantPipelines;
+    std::thread noiseVariantBuildThread;
+    std::atomic<bool> isNoiseVariantBuildRunning{false};
+    VoronoiNoiseVariant buildingNoiseVariant;
+    agpu_pipeline_state_ref builtNoiseVariantPipeline;
+
+    // The cached noise is sampled on a fixed view space grid and stored as
+    // half floats, so it is only used when requested, and the screen matches
+    // the headless and CPU images otherwise.
+    bool noiseTileCacheEnabled = false;
+    NoiseTileCache noiseTileCache;
+    agpu_texture_ref noiseTileAtlas;
+    size_t noiseTileBakedOctaveCount = 0;
+
+    DynamicResolutionController dynamicResolution;
+    agpu_texture_ref scaledNoiseColorBuffer;
+    agpu_framebuffer_ref scaledNoiseFramebuffer;
+    int scaledNoiseWidth = 0;
+    int scaledNoiseHeight = 0;
+
+    // The thresholds follow the percentiles of the noise value on the screen.
+    bool autoRangeEnabled = false;
+    bool hasNoiseStatisticsState = false;
+    ScreenAndUIState noiseStatisticsState;
+    VoronoiNoiseStatistics noiseStatistics = {};
+
+    // A shorter wait is the cost of checking a fence that was already signaled.
+    static constexpr float GPUBoundWaitSeconds = 0.0002f;
+
     agpu_sampler_ref sampler;
     agpu_shader_resource_binding_ref samplersBinding;
 
-    agpu_buffer_ref screenAndUIStateUniformBuffer;
-    agpu_buffer_ref uiDataBuffer;
-    agpu_shader_resource_binding_ref dataBinding;
+    PersistentRingBuffer frameDataRingBuffer;
+
+    FrameResources frames[MaxFramesInFlight];
+    size_t framesInFlightCount = 2;
+    size_t currentFrameIndex = 0;
+
+    ShaderBinaryCache shaderBinaryCache;
+    AssetBundle assetBundle;
+    std::string assetBundleFileName = "assets.svab";
+    std::string packedAssetBundleFileName;
+    std::vector<std::string> packedAssetFileNames;
+    bool packedShaderBinariesEnabled = false;
+    std::vector<ShaderCompileJob> shaderCompileJobs;
+    PipelineBuildJob pipelineBuildJobs[PipelineBuildJobCount];
+    std::thread pipelineCompilationThread;
+    bool arePipelinesReady = false;
+
+    bool hotReloadEnabled = true;
+    ShaderFileWatcher shaderFileWatcher;
+    bool pendingShaderReloads[PipelineBuildJobCount] = {};
+    uint32_t lastShaderChangeTicks = 0;
+    std::thread shaderReloadThread;
+    std::atomic<bool> isShaderReloadRunning{false};
+    std::vector<ShaderReloadResult> shaderReloadResults;
+    std::string shaderReloadErrorLogs[PipelineBuildJobCount];
+    std::vector<RetiredPipeline> retiredPipelines;
+    bool hasPresentedFirstFrame = false;
+
+    bool startupReportEnabled = false;
+    uint64_t startupStartCounter = 0;
+    uint64_t lastStartupStageCounter = 0;
+    std::vector<std::pair<const char*, double>> startupStages;
+
+    std::string exportFileName;
+    NoiseMapChannels exportChannels = NoiseMapChannels::Color;
+    uint32_t exportTileSize = NoiseMapExporter::DefaultTileSize;
+    agpu_texture_ref exportColorBuffers[MaxFramesInFlight];
+    agpu_framebuffer_ref exportFramebuffers[MaxFramesInFlight];
+
+    std::string sweepFileName;
+    std::string sweepOutputFileName = "sweep.csv";
+    std::string sweepImagesFileName;
+    uint32_t sweepSampleWidth = NoiseParameterSweep::DefaultSampleSize;
+    uint32_t sweepSampleHeight = NoiseParameterSweep::DefaultSampleSize;
+
+    ParameterTimeline timeline;
+    std::string timelineOutputFileName;
+    uint32_t timelineFramesPerSecond = 30;
+    size_t timelineFramesPerSubmit = 4;
+    std::vector<TimelineFrameTarget> timelineTargets[MaxFramesInFlight];
+    bool isTimelinePlaying = false;
+    float timelineTime = 0;
+
+    size_t benchmarkFrameCount = 0;
+    size_t benchmarkFrameIndex = 0;
+    std::string benchmarkJSONFileName;
+
+    bool frameTimeGraphVisible = false;
+    std::string traceOutputFileName;
+    float frameTimeHistory[FrameTimeHistorySize] = {};
+    float frameWaitTimeHistory[FrameTimeHistorySize] = {};
+    size_t frameTimeHistoryIndex = 0;
+    float lastFrameWaitSeconds = 0;
+    static constexpr float FrameTimeGraphBarWidth = 1.5f;
+    static constexpr float FrameTimeGraphHeight = 100.0f;
+
+    bool continuousRedrawEnabled = false;
+    bool redrawRequested = true;
+    ScreenAndUIState lastDrawnState;
+    static constexpr int IdleEventTimeoutMilliseconds = 100;
+
+    bool frameTimeReportEnabled = false;
+    uint64_t frameTimeReportStartCounter = 0;
+    double frameTimeReportStartCPUSeconds = 0;
+    uint32_t frameTimeReportFrameCount = 0;
 
     agpu_texture_ref bitmapFont;
     float bitmapFontScale = 1.5;
-    float bitmapFontInverseWidth = 0;
-    float bitmapFontInverseHeight = 0;
     int bitmapFontGlyphWidth = 7;
     int bitmapFontGlyphHeight = 9;
     int bitmapFontColumns = 16;
 
     ScreenAndUIState screenAndUIState;
 
-    size_t UIElementQuadBufferMaxCapacity = 4192;
-    std::vector<UIElementQuad> uiElementQuadBuffer;
-
-    bool hasWheelEvent = false;
-    bool hasHandledWheelEvent = false;
-    int wheelDelta = 0;
+    size_t UIElementQuadBufferInitialCapacity = 4192;
+    bool packedUIQuadsEnabled = true;
+    bool denseTextBenchmarkEnabled = false;
+    ImmediateUI ui;
+    size_t uiRegeneratedWidgetCount = 0;
+    size_t uiUploadedBytes = 0;
 
-    bool hasLeftDragEvent = false;
-    bool hasHandledLeftDragEvent = false;
-    int leftDragStartX = 0;
-    int leftDragStartY = 0;
-    int leftDragDeltaX = 0;
-    int leftDragDeltaY = 0;
     int displayWidth = 640;
     int displayHeight = 480;
 };
@@ -0,0 +1,301 @@
+#include "BenchmarkReport.hpp"
+#include "DenseTextOverlay.hpp"
+#include "ParameterPanel.hpp"
+#include "TiledNoiseRasterizer.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Deterministic micro and macro benchmarks of the CPU side of ShaderVis: the
+ * noise kernels, the generation and upload of the UI quads, and the headless
+ * CPU frame. Every benchmark uses fixed inputs, so the results of different
+ * versions can be compared. The GPU frame loop is measured by ShaderVis itself,
+ * with -headless and -bench-frames. The SSE2 packing of the UI quads is also
+ * checked against the scalar packing, and a mismatch fails the run.
+ */
+
+// The size of the bitmap font texture that is shipped with the sample.
+static constexpr uint32_t FontTextureWidth = 112;
+static constexpr uint32_t FontTextureHeight = 54;
+
+static void initializeUI(ImmediateUI &ui)
+{
+    ui.getFontMetrics().build(FontTextureWidth, FontTextureHeight, 7, 9, 16, 1.5f);
+}
+
+// Emits panelCount copies of the parameter panel, one below the other.
+static void generatePanels(ImmediateUI &ui, std::vector<ScreenAndUIState> &states)
+{
+    ui.beginFrame();
+    for(size_t i = 0; i < states.size(); ++i)
+        parameterPanel(ui, states[i], 5, 5 + float(i)*60);
+    ui.endFrame();
+}
+
+static volatile uint32_t benchmarkSink;
+
+int main(int argc, const char *argv[])
+{
+    size_t iterations = 50;
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::string jsonFileName;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-iterations" && i + 1 < argc)
+        {
+            iterations = size_t(std::max(1, atoi(argv[++i])));
+        }
+        else if (arg == "-threads" && i + 1 < argc)
+        {
+            threadCount = size_t(std::max(1, atoi(argv[++i])));
+        }
+        else if (arg == "-json" && i + 1 < argc)
+        {
+            jsonFileName = argv[++i];
+        }
+    }
+
+    size_t warmupIterations = std::max(size_t(1), iterations / 10);
+    int exitCode = 0;
+    BenchmarkReport report("ShaderVisBench");
+    report.setContext("best_simd_level", getVoronoiNoiseSIMDLevelName(getBestVoronoiNoiseSIMDLevel()));
+    report.setContext("threads", std::to_string(threadCount));
+
+    // Hash.
+    {
+        static constexpr uint32_t HashCount = 1 << 20;
+        report.addSamples("lowbias32", sampleBenchmark(warmupIterations, iterations, [&]() {
+            uint32_t accumulator = 0;
+            for(uint32_t i = 0; i < HashCount; ++i)
+                accumulator ^= uint32_t(voronoiLowbias32(int32_t(i)));
+            benchmarkSink = accumulator;
+        }), HashCount);
+    }
+
+    // Single octave components, through the scalar reference function.
+    {
+        static constexpr int GridSize = 256;
+        report.addSamples("voronoiNoiseComponents", sampleBenchmark(warmupIterations, iterations, [&]() {
+            float components[4];
+            float accumulator = 0;
+            for(int y = 0; y < GridSize; ++y)
+            {
+                for(int x = 0; x < GridSize; ++x)
+                {
+                    voronoiNoiseComponents(x*0.173f, y*0.173f, components);
+                    accumulator += components[0];
+                }
+            }
+            benchmarkSink = uint32_t(accumulator);
+        }), GridSize*GridSize);
+    }
+
+    // Noise kernels across octave counts.
+    {
+        static constexpr uint32_t RegionSize = 256;
+        std::vector<uint32_t> pixels(RegionSize*RegionSize);
+        const VoronoiNoiseSIMDLevel levels[] = {
+            VoronoiNoiseSIMDLevel::Scalar,
+            VoronoiNoiseSIMDLevel::SSE4,
+            VoronoiNoiseSIMDLevel::AVX2,
+        };
+        for(auto level : levels)
+        {
+            if(!isVoronoiNoiseSIMDLevelSupported(level))
+                continue;
+
+            for(int octaves : {1, 2, 4, 8})
+            {
+                ScreenAndUIState state;
+                state.screenWidth = RegionSize;
+                state.screenHeight = RegionSize;
+                state.octaves = float(octaves);
+                auto name = std::string("noise/") + getVoronoiNoiseSIMDLevelName(level) + "/octaves=" + std::to_string(octaves);
+                report.addSamples(name, sampleBenchmark(warmupIterations, iterations, [&]() {
+                    renderVoronoiNoiseRegion(state, 0, 0, RegionSize, RegionSize, pixels.data(), RegionSize, level);
+                }), RegionSize*RegionSize);
+            }
+        }
+    }
+
+    // UI quad generation and upload, with the parameter panel repeated up to thousands of widgets.
+    for(size_t panelCount : {1, 16, 64, 256})
+    {
+        auto widgetCount = panelCount*ParameterPanelWidgetCount;
+        auto suffix = "/widgets=" + std::to_string(widgetCount);
+        std::vector<ScreenAndUIState> states(panelCount);
+
+        // Every widget generates its quads, as in the first frame.
+        report.addSamples("ui/generate-all" + suffix, sampleBenchmark(warmupIterations, iterations, [&]() {
+            std::unique_ptr<ImmediateUI> ui(new ImmediateUI());
+            initializeUI(*ui);
+            generatePanels(*ui, states);
+            benchmarkSink = uint32_t(ui->getQuadCache().getQuadCount());
+        }), widgetCount);
+
+        ImmediateUI ui;
+        initializeUI(ui);
+        generatePanels(ui, states);
+        ui.getQuadCache().clearDirtyRanges(0);
+
+        // Nothing changes, which is the common case.
+        report.addSamples("ui/retained-idle" + suffix, sampleBenchmark(warmupIterations, iterations, [&]() {
+            generatePanels(ui, states);
+        }), widgetCount);
+
+        // One slider is dragged, and the changed quads are copied into the
+        // staging memory of the UI data buffer, as done by uploadBufferData.
+        auto &quadCache = ui.getQuadCache();
+        std::vector<UIElementQuad> uploadBuffer(quadCache.getQuadCount());
+        size_t frameIndex = 0;
+        size_t uploadedBytes = 0;
+        report.addSamples("ui/retained-drag-and-upload" + suffix, sampleBenchmark(warmupIterations, iterations, [&]() {
+            auto &state = states[frameIndex % panelCount];
+            state.amplitude = float(frameIndex % 100) * 0.02f;
+            ++frameIndex;
+            generatePanels(ui, states);
+
+            auto &quads = quadCache.getQuads();
+            for(auto &range : quadCache.getDirtyRanges(0))
+            {
+                auto end = std::min(range.end, quads.size());
+                if(range.begin >= end)
+                    continue;
+                memcpy(&uploadBuffer[range.begin], &quads[range.begin], (end - range.begin)*sizeof(UIElementQuad));
+                uploadedBytes += (end - range.begin)*sizeof(UIElementQuad);
+            }
+            quadCache.clearDirtyRanges(0);
+        }), widgetCount);
+        benchmarkSink = uint32_t(uploadedBytes);
+    }
+
+    // The SSE2 and the scalar quad packers must produce the same bits, also
+    // for the halfway, negative and out of range values.
+    {
+        std::vector<UIElementQuad> quads;
+        for(int i = -1024; i <= 1024; ++i)
+        {
+            UIElementQuad quad = {};
+            quad.x = float(i)*0.125f;
+            quad.y = -float(i)*0.375f;
+            quad.width = float(i)*0.125f;
+            quad.height = float(i)*16.125f;
+            quad.r = (float(i) + 0.5f) / 255.0f;
+            quad.g = (float(i)*0.5f) / 255.0f;
+            quad.b = float(i)*0.001f;
+            quad.a = 1.0f - float(i)*0.01f;
+            quad.isGlyph = i % 2 != 0;
+            quad.fontX = (float(i) + 0.5f) / 65535.0f;
+            quad.fontY = (float(i)*64.5f) / 65535.0f;
+            quad.fontWidth = float(i) / 2048.0f;
+            quad.fontHeight = (float(i) - 0.5f) / 65535.0f;
+            quads.push_back(quad);
+        }
+
+        UIElementQuad extremeQuad = {};
+        extremeQuad.x = NAN;
+        extremeQuad.y = INFINITY;
+        extremeQuad.width = -INFINITY;
+        extremeQuad.height = 1e30f;
+        extremeQuad.r = NAN;
+        extremeQuad.g = -1e30f;
+        extremeQuad.b = 1e30f;
+        extremeQuad.isGlyph = 1;
+        extremeQuad.fontX = NAN;
+        extremeQuad.fontWidth = -1.0f;
+        extremeQuad.fontHeight = INFINITY;
+        quads.push_back(extremeQuad);
+
+        std::vector<PackedUIElementQuad> packedQuads(quads.size());
+        packUIElementQuads(quads.data(), quads.size(), packedQuads.data());
+        size_t mismatchCount = 0;
+        for(size_t i = 0; i < quads.size(); ++i)
+        {
+            auto reference = packUIElementQuad(quads[i]);
+            if(memcmp(&reference, &packedQuads[i], sizeof(reference)) != 0)
+                ++mismatchCount;
+        }
+
+        if(mismatchCount > 0)
+            exitCode = 1;
+        printf("ui/pack-quads: %zu quads  %s\n", quads.size(), mismatchCount == 0 ? "matches scalar" : "MISMATCH");
+    }
+
+    // A full HD text overlay that changes every frame, in the full and in the
+    // packed quad encodings. The GPU side of the comparison is measured by
+    // ShaderVis -headless -bench-dense-text, with and without -full-ui-quads.
+    for(bool packed : {false, true})
+    {
+        static constexpr float OverlayWidth = 1920;
+        static constexpr float OverlayHeight = 1080;
+        ImmediateUI ui;
+        initializeUI(ui);
+        auto &quadCache = ui.getQuadCache();
+        quadCache.setPackedQuadsEnabled(packed);
+
+        size_t frameIndex = 0;
+        auto generateOverlay = [&]() {
+            ui.beginFrame();
+            denseTextOverlay(ui, OverlayWidth, OverlayHeight, frameIndex++);
+            ui.endFrame();
+        };
+        generateOverlay();
+        quadCache.clearDirtyRanges(0);
+
+        auto quadCount = quadCache.getQuadCount();
+        auto quadStride = packed ? sizeof(PackedUIElementQuad) : sizeof(UIElementQuad);
+        std::vector<uint8_t> uploadBuffer(quadCount*quadStride);
+        size_t uploadedBytes = 0;
+        auto samples = sampleBenchmark(warmupIterations, iterations, [&]() {
+            generateOverlay();
+            auto quadData = packed ? reinterpret_cast<const uint8_t*> (quadCache.getPackedQuads().data()) : reinterpret_cast<const uint8_t*> (quadCache.getQuads().data());
+            for(auto &range : quadCache.getDirtyRanges(0))
+            {
+                auto end = std::min(range.end, quadCache.getQuadCount());
+                if(range.begin >= end)
+                    continue;
+                memcpy(&uploadBuffer[range.begin*quadStride], quadData + range.begin*quadStride, (end - range.begin)*quadStride);
+                uploadedBytes += (end - range.begin)*quadStride;
+            }
+            quadCache.clearDirtyRanges(0);
+        });
+
+        std::string name = std::string("ui/dense-text-upload/format=") + (packed ? "packed" : "full");
+        auto bytesPerFrame = uploadedBytes / (warmupIterations + iterations);
+        report.addSamples(name, samples, double(quadCount));
+        report.setContext(name + "/bytes-per-frame", std::to_string(bytesPerFrame));
+        printf("%s: %zu quads, %zu bytes per frame\n", name.c_str(), quadCount, bytesPerFrame);
+    }
+
+    // The headless CPU frame, at a fixed resolution.
+    {
+        static constexpr uint32_t FrameWidth = 1280;
+        static constexpr uint32_t FrameHeight = 720;
+        WorkStealingThreadPool threadPool(threadCount);
+        TiledNoiseRasterizer rasterizer(threadPool);
+        ScreenAndUIState state;
+        state.screenWidth = FrameWidth;
+        state.screenHeight = FrameHeight;
+        state.octaves = 4;
+        std::vector<uint32_t> pixels(FrameWidth*FrameHeight);
+        size_t frameIndex = 0;
+        report.addSamples("frame/cpu-headless/1280x720/octaves=4", sampleBenchmark(std::min(warmupIterations, size_t(2)), std::max(iterations / 5, size_t(5)), [&]() {
+            // Pan deterministically, as an interactive session would.
+            state.screenOffsetX = float(frameIndex++) * 0.01f;
+            rasterizer.render(state, pixels.data(), FrameWidth);
+        }), FrameWidth*FrameHeight);
+    }
+
+    report.printTable();
+    report.setContext("matches", exitCode == 0 ? "true" : "false");
+    if(!jsonFileName.empty() && !report.writeJSON(jsonFileName))
+        return 1;
+    return exitCode;
+}
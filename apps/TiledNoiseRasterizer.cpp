@@ -0,0 +1,50 @@
+#include "TiledNoiseRasterizer.hpp"
+#include <algorithm>
+
+TiledNoiseRasterizer::TiledNoiseRasterizer(WorkStealingThreadPool &threadPool, uint32_t tileSize)
+    : threadPool(threadPool), tileSize(std::max(tileSize, VoronoiNoiseLaneGroupSize))
+{
+}
+
+std::vector<NoiseTile> TiledNoiseRasterizer::computeTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const
+{
+    std::vector<NoiseTile> tiles;
+    for(uint32_t tileY = 0; tileY < height; tileY += tileSize)
+    {
+        for(uint32_t tileX = 0; tileX < width; tileX += tileSize)
+        {
+            NoiseTile tile;
+            tile.x = x + tileX;
+            tile.y = y + tileY;
+            tile.width = std::min(tileSize, width - tileX);
+            tile.height = std::min(tileSize, height - tileY);
+            tiles.push_back(tile);
+        }
+    }
+
+    return tiles;
+}
+
+void TiledNoiseRasterizer::render(const ScreenAndUIState &state, uint32_t *destination, size_t destinationPitch)
+{
+    renderRegion(state, 0, 0, state.screenWidth, state.screenHeight, destination, destinationPitch);
+}
+
+void TiledNoiseRasterizer::renderRegion(const ScreenAndUIState &state, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    uint32_t *destination, size_t destinationPitch)
+{
+    auto tiles = computeTiles(x, y, width, height);
+    auto level = simdLevel;
+    const VoronoiNoiseCellTable *tileCellTable = nullptr;
+    if(cellTableEnabled)
+    {
+        cellTable.build(state);
+        tileCellTable = &cellTable;
+    }
+
+    threadPool.parallelFor(tiles.size(), [&](size_t tileIndex) {
+        const auto &tile = tiles[tileIndex];
+        auto tileDestination = destination + (tile.y - y)*destinationPitch + (tile.x - x);
+        renderVoronoiNoiseRegion(state, tile.x, tile.y, tile.width, tile.height, tileDestination, destinationPitch, level, true, tileCellTable);
+    });
+}
@@ -0,0 +1,73 @@
+#ifndef SHADER_VIS_TILED_NOISE_RASTERIZER_HPP
+#define SHADER_VIS_TILED_NOISE_RASTERIZER_HPP
+
+#include "VoronoiNoiseCPU.hpp"
+#include "VoronoiNoiseCellTable.hpp"
+#include "WorkStealingThreadPool.hpp"
+
+/**
+ * A rectangle of pixels of the viewport that is rendered as a unit.
+ */
+struct NoiseTile
+{
+    uint32_t x, y;
+    uint32_t width, height;
+};
+
+/**
+ * Multithreaded CPU rasterizer for the noise field. The viewport described by
+ * a ScreenAndUIState is split in cache sized tiles that are distributed over
+ * a work stealing thread pool, which balances the varying cost per tile. Each
+ * tile writes a disjoint part of the destination and every pixel only depends
+ * on its own coordinate, so the output is identical for any thread count and
+ * scheduling order.
+ */
+class TiledNoiseRasterizer
+{
+public:
+    // A 64x64 B8G8R8A8 tile is 16 KB, which keeps a tile in the L1/L2 cache.
+    static constexpr uint32_t DefaultTileSize = 64;
+
+    explicit TiledNoiseRasterizer(WorkStealingThreadPool &threadPool, uint32_t tileSize = DefaultTileSize);
+
+    WorkStealingThreadPool &getThreadPool()
+    {
+        return threadPool;
+    }
+
+    uint32_t getTileSize() const
+    {
+        return tileSize;
+    }
+
+    void setSIMDLevel(VoronoiNoiseSIMDLevel newLevel)
+    {
+        simdLevel = newLevel;
+    }
+
+    // When enabled, the feature points of the cells of the viewport are
+    // hashed once per render into a cell table that the tiles share.
+    void setCellTableEnabled(bool enabled)
+    {
+        cellTableEnabled = enabled;
+    }
+
+    // Splits a region of the viewport in tiles, in row major order.
+    std::vector<NoiseTile> computeTiles(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    // Renders the whole viewport. The destination pitch is expressed in pixels.
+    void render(const ScreenAndUIState &state, uint32_t *destination, size_t destinationPitch);
+
+    // Renders a region of the viewport into a destination image with the size of the region.
+    void renderRegion(const ScreenAndUIState &state, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+        uint32_t *destination, size_t destinationPitch);
+
+private:
+    WorkStealingThreadPool &threadPool;
+    uint32_t tileSize;
+    VoronoiNoiseSIMDLevel simdLevel = getBestVoronoiNoiseSIMDLevel();
+    bool cellTableEnabled = false;
+    VoronoiNoiseCellTable cellTable;
+};
+
+#endif //SHADER_VIS_TILED_NOISE_RASTERIZER_HPP
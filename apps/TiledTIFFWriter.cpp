@@ -0,0 +1,198 @@
+#include "TiledTIFFWriter.hpp"
+#include <string.h>
+#include <algorithm>
+#include <initializer_list>
+
+// The TIFF 6.0 tags and the BigTIFF extension.
+enum TIFFTag : uint16_t
+{
+    TIFFTagImageWidth = 256,
+    TIFFTagImageLength = 257,
+    TIFFTagBitsPerSample = 258,
+    TIFFTagCompression = 259,
+    TIFFTagPhotometricInterpretation = 262,
+    TIFFTagSamplesPerPixel = 277,
+    TIFFTagPlanarConfiguration = 284,
+    TIFFTagTileWidth = 322,
+    TIFFTagTileLength = 323,
+    TIFFTagTileOffsets = 324,
+    TIFFTagTileByteCounts = 325,
+    TIFFTagExtraSamples = 338,
+    TIFFTagSampleFormat = 339,
+};
+
+enum TIFFFieldType : uint16_t
+{
+    TIFFFieldShort = 3,
+    TIFFFieldLong = 4,
+    TIFFFieldLong8 = 16,
+};
+
+static constexpr uint64_t MissingTileOffset = ~uint64_t(0);
+
+/**
+ * A BigTIFF directory entry, with the value stored in place when it fits in 8 bytes.
+ */
+struct TIFFDirectoryEntry
+{
+    uint16_t tag;
+    uint16_t type;
+    uint64_t count;
+    uint8_t value[8];
+};
+
+static TIFFDirectoryEntry makeShortEntry(uint16_t tag, std::initializer_list<uint16_t> values)
+{
+    TIFFDirectoryEntry entry = {tag, TIFFFieldShort, values.size(), {}};
+    size_t i = 0;
+    for(auto value : values)
+        memcpy(entry.value + 2*i++, &value, 2);
+    return entry;
+}
+
+static TIFFDirectoryEntry makeLongEntry(uint16_t tag, uint32_t value)
+{
+    TIFFDirectoryEntry entry = {tag, TIFFFieldLong, 1, {}};
+    memcpy(entry.value, &value, 4);
+    return entry;
+}
+
+static TIFFDirectoryEntry makeLong8ArrayEntry(uint16_t tag, uint64_t count, uint64_t offset)
+{
+    TIFFDirectoryEntry entry = {tag, TIFFFieldLong8, count, {}};
+    memcpy(entry.value, &offset, 8);
+    return entry;
+}
+
+TiledTIFFWriter::~TiledTIFFWriter()
+{
+    if(file)
+        fclose(file);
+}
+
+bool TiledTIFFWriter::open(const std::string &newFileName, uint32_t newWidth, uint32_t newHeight, uint32_t newTileSize, TIFFPixelFormat newFormat)
+{
+    // The tile dimensions of a TIFF must be multiples of 16.
+    if(newWidth == 0 || newHeight == 0 || newTileSize == 0 || newTileSize % 16 != 0)
+    {
+        fprintf(stderr, "Invalid tiled TIFF layout %ux%u with %u pixel tiles.\n", newWidth, newHeight, newTileSize);
+        return false;
+    }
+
+    fileName = newFileName;
+    file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s\n", fileName.c_str());
+        return false;
+    }
+
+    width = newWidth;
+    height = newHeight;
+    tileSize = newTileSize;
+    format = newFormat;
+    tileCountX = (width + tileSize - 1) / tileSize;
+    tileCountY = (height + tileSize - 1) / tileSize;
+    tileByteSize = size_t(tileSize)*tileSize*getPixelByteSize(format);
+    tileOffsets.assign(size_t(tileCountX)*tileCountY, MissingTileOffset);
+    fileSize = 0;
+
+    // Little endian BigTIFF header. The directory offset is patched by close.
+    const uint8_t header[16] = {'I', 'I', 43, 0, 8, 0, 0, 0};
+    return writeBytes(header, sizeof(header));
+}
+
+bool TiledTIFFWriter::writeBytes(const void *data, size_t size)
+{
+    if(fwrite(data, 1, size, file) != size)
+    {
+        fprintf(stderr, "Failed to write file %s\n", fileName.c_str());
+        return false;
+    }
+
+    fileSize += size;
+    return true;
+}
+
+bool TiledTIFFWriter::padToAlignment(size_t alignment)
+{
+    static const uint8_t zeros[16] = {};
+    auto padding = size_t((alignment - fileSize % alignment) % alignment);
+    return writeBytes(zeros, padding);
+}
+
+bool TiledTIFFWriter::writeTile(size_t tileIndex, const void *pixels)
+{
+    if(!file || tileIndex >= tileOffsets.size())
+        return false;
+
+    tileOffsets[tileIndex] = fileSize;
+    return writeBytes(pixels, tileByteSize);
+}
+
+bool TiledTIFFWriter::close()
+{
+    if(!file)
+        return false;
+
+    if(std::find(tileOffsets.begin(), tileOffsets.end(), MissingTileOffset) != tileOffsets.end())
+    {
+        fprintf(stderr, "Not every tile of %s was written.\n", fileName.c_str());
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    bool succeeded = padToAlignment(8);
+    auto tileOffsetsOffset = fileSize;
+    succeeded = succeeded && writeBytes(tileOffsets.data(), tileOffsets.size()*sizeof(uint64_t));
+
+    auto tileByteCountsOffset = fileSize;
+    std::vector<uint64_t> tileByteCounts(tileOffsets.size(), tileByteSize);
+    succeeded = succeeded && writeBytes(tileByteCounts.data(), tileByteCounts.size()*sizeof(uint64_t));
+
+    // A single tile has its offset and size stored in the entries.
+    if(tileOffsets.size() == 1)
+    {
+        tileOffsetsOffset = tileOffsets[0];
+        tileByteCountsOffset = tileByteSize;
+    }
+
+    bool isColor = format == TIFFPixelFormat::RGBA8;
+    uint16_t bitsPerSample = isColor ? 8 : 32;
+    uint16_t sampleFormat = isColor ? 1 : 3;
+    const TIFFDirectoryEntry entries[] = {
+        makeLongEntry(TIFFTagImageWidth, width),
+        makeLongEntry(TIFFTagImageLength, height),
+        makeShortEntry(TIFFTagBitsPerSample, {bitsPerSample, bitsPerSample, bitsPerSample, bitsPerSample}),
+        makeShortEntry(TIFFTagCompression, {1}),
+        makeShortEntry(TIFFTagPhotometricInterpretation, {uint16_t(isColor ? 2 : 1)}),
+        makeShortEntry(TIFFTagSamplesPerPixel, {4}),
+        makeShortEntry(TIFFTagPlanarConfiguration, {1}),
+        makeLongEntry(TIFFTagTileWidth, tileSize),
+        makeLongEntry(TIFFTagTileLength, tileSize),
+        makeLong8ArrayEntry(TIFFTagTileOffsets, tileOffsets.size(), tileOffsetsOffset),
+        makeLong8ArrayEntry(TIFFTagTileByteCounts, tileOffsets.size(), tileByteCountsOffset),
+        isColor ? makeShortEntry(TIFFTagExtraSamples, {2}) : makeShortEntry(TIFFTagExtraSamples, {0, 0, 0}),
+        makeShortEntry(TIFFTagSampleFormat, {sampleFormat, sampleFormat, sampleFormat, sampleFormat}),
+    };
+
+    auto directoryOffset = fileSize;
+    uint64_t entryCount = sizeof(entries) / sizeof(entries[0]);
+    succeeded = succeeded && writeBytes(&entryCount, 8);
+    for(auto &entry : entries)
+    {
+        succeeded = succeeded && writeBytes(&entry.tag, 2) && writeBytes(&entry.type, 2) &&
+            writeBytes(&entry.count, 8) && writeBytes(entry.value, 8);
+    }
+    uint64_t nextDirectoryOffset = 0;
+    succeeded = succeeded && writeBytes(&nextDirectoryOffset, 8);
+
+    // The first directory offset of the header.
+    succeeded = succeeded && fseek(file, 8, SEEK_SET) == 0 && fwrite(&directoryOffset, 8, 1, file) == 1;
+    succeeded = fclose(file) == 0 && succeeded;
+    file = nullptr;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write file %s\n", fileName.c_str());
+    return succeeded;
+}
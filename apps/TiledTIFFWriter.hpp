@@ -0,0 +1,81 @@
+#ifndef SHADER_VIS_TILED_TIFF_WRITER_HPP
+#define SHADER_VIS_TILED_TIFF_WRITER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * The sample layout of the pixels of a tiled TIFF image.
+ */
+enum class TIFFPixelFormat
+{
+    // R, G, B and unassociated alpha, 8 bits each.
+    RGBA8 = 0,
+
+    // Four 32 bit floats, the first one as gray and three unspecified extra samples.
+    Float32x4,
+};
+
+/**
+ * Streaming writer of uncompressed, tiled BigTIFF images, whose size is not
+ * limited to 4 GB. The tiles are appended to the file in any order as they
+ * are written, and only their offsets are kept in memory. The directory with
+ * the tile offsets is written by close, after the last tile. The samples are
+ * written in the byte order of the host, which must be little endian.
+ */
+class TiledTIFFWriter
+{
+public:
+    ~TiledTIFFWriter();
+
+    bool open(const std::string &fileName, uint32_t width, uint32_t height, uint32_t tileSize, TIFFPixelFormat format);
+
+    uint32_t getTileCountX() const
+    {
+        return tileCountX;
+    }
+
+    uint32_t getTileCountY() const
+    {
+        return tileCountY;
+    }
+
+    size_t getTileByteSize() const
+    {
+        return tileByteSize;
+    }
+
+    static size_t getPixelByteSize(TIFFPixelFormat format)
+    {
+        return format == TIFFPixelFormat::RGBA8 ? 4 : 16;
+    }
+
+    // Writes the tileSize x tileSize pixels of the tile, in rows from top to bottom.
+    // The tiles are numbered in row major order.
+    bool writeTile(size_t tileIndex, const void *pixels);
+
+    // Writes the image directory. Every tile must have been written.
+    bool close();
+
+private:
+    bool writeBytes(const void *data, size_t size);
+    bool padToAlignment(size_t alignment);
+
+    FILE *file = nullptr;
+    std::string fileName;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t tileSize = 0;
+    uint32_t tileCountX = 0;
+    uint32_t tileCountY = 0;
+    size_t tileByteSize = 0;
+    TIFFPixelFormat format = TIFFPixelFormat::RGBA8;
+
+    uint64_t fileSize = 0;
+    std::vector<uint64_t> tileOffsets;
+};
+
+#endif //SHADER_VIS_TILED_TIFF_WRITER_HPP
@@ -0,0 +1,208 @@
+#include "TimelineRenderer.hpp"
+#include "ImageWriter.hpp"
+#include "Y4MWriter.hpp"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+TimelineRenderer::TimelineRenderer(const ParameterTimeline &timeline, const ScreenAndUIState &baseState, uint32_t framesPerSecond)
+    : timeline(timeline), baseState(baseState), framesPerSecond(framesPerSecond > 0 ? framesPerSecond : 1)
+{
+}
+
+size_t TimelineRenderer::getFrameCount() const
+{
+    return size_t(timeline.getDuration()*framesPerSecond + 0.5f) + 1;
+}
+
+ScreenAndUIState TimelineRenderer::getFrameState(size_t frameIndex) const
+{
+    auto state = baseState;
+    timeline.evaluate(float(double(frameIndex) / framesPerSecond), state);
+    return state;
+}
+
+// Accepts exactly one integer conversion, %d or %0Nd, and %% as the only other
+// escape, since the pattern is passed to snprintf with a single int.
+static bool isValidFrameFileNamePattern(const std::string &pattern)
+{
+    size_t conversionCount = 0;
+    for(size_t i = 0; i < pattern.size(); ++i)
+    {
+        if(pattern[i] != '%')
+            continue;
+
+        ++i;
+        if(i < pattern.size() && pattern[i] == '%')
+            continue;
+
+        if(i < pattern.size() && pattern[i] == '0')
+        {
+            ++i;
+            if(i >= pattern.size() || !isdigit((unsigned char)pattern[i]))
+                return false;
+            while(i < pattern.size() && isdigit((unsigned char)pattern[i]))
+                ++i;
+        }
+
+        if(i >= pattern.size() || pattern[i] != 'd')
+            return false;
+        ++conversionCount;
+    }
+
+    return conversionCount == 1;
+}
+
+bool TimelineRenderer::getFrameFileNamePattern(const std::string &outputFileName, std::string &pattern)
+{
+    if(outputFileName.find('%') != std::string::npos)
+    {
+        if(!isValidFrameFileNamePattern(outputFileName))
+        {
+            fprintf(stderr, "The output name %s must contain exactly one %%d or %%0Nd for the frame index, and %%%% for a literal %%.\n", outputFileName.c_str());
+            return false;
+        }
+
+        pattern = outputFileName;
+        return true;
+    }
+
+    auto dotPosition = outputFileName.rfind('.');
+    auto separatorPosition = outputFileName.find_last_of("/\\");
+    if(dotPosition == std::string::npos || (separatorPosition != std::string::npos && dotPosition < separatorPosition))
+        pattern = outputFileName + "%05d.png";
+    else
+        pattern = outputFileName.substr(0, dotPosition) + "%05d" + outputFileName.substr(dotPosition);
+    return true;
+}
+
+static bool hasExtension(const std::string &fileName, const char *extension)
+{
+    auto extensionLength = strlen(extension);
+    if(fileName.size() < extensionLength)
+        return false;
+
+    for(size_t i = 0; i < extensionLength; ++i)
+    {
+        if(tolower(fileName[fileName.size() - extensionLength + i]) != extension[i])
+            return false;
+    }
+    return true;
+}
+
+bool TimelineRenderer::render(const std::string &outputFileName, const TimelineFrameBatchRenderer &renderer)
+{
+    auto width = baseState.screenWidth;
+    auto height = baseState.screenHeight;
+    auto frameCount = getFrameCount();
+    auto frameSize = size_t(width)*height;
+    auto batchFrameCount = std::min(batchSize, frameCount);
+
+    Y4MWriter videoWriter;
+    std::string frameFileNamePattern;
+    bool isVideo = hasExtension(outputFileName, ".y4m");
+    if(isVideo)
+    {
+        if(!videoWriter.open(outputFileName, width, height, framesPerSecond))
+            return false;
+    }
+    else
+    {
+        if(!getFrameFileNamePattern(outputFileName, frameFileNamePattern))
+            return false;
+    }
+
+    printf("Rendering %zu frames of %ux%u pixels at %u frames per second, in batches of %zu frames.\n",
+        frameCount, width, height, framesPerSecond, batchFrameCount);
+
+    std::vector<uint32_t> batchStorage[2];
+    std::vector<ScreenAndUIState> batchStates[2];
+    std::vector<uint32_t*> batchDestinations[2];
+    size_t batchFirstFrame[2] = {};
+    std::thread writerThread;
+    bool writerSucceeded = true;
+    bool succeeded = true;
+
+    auto writeBatch = [&](size_t bufferIndex) {
+        auto &destinations = batchDestinations[bufferIndex];
+        for(size_t i = 0; i < destinations.size() && writerSucceeded; ++i)
+        {
+            if(isVideo)
+            {
+                writerSucceeded = videoWriter.writeFrame(destinations[i], width);
+                continue;
+            }
+
+            char frameFileName[1024];
+            snprintf(frameFileName, sizeof(frameFileName), frameFileNamePattern.c_str(), int(batchFirstFrame[bufferIndex] + i));
+            writerSucceeded = writeImage(frameFileName, width, height, destinations[i], width);
+        }
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastProgressTime = startTime;
+    size_t nextFrameIndex = 0;
+    for(size_t batchIndex = 0; nextFrameIndex < frameCount; ++batchIndex)
+    {
+        // The other buffer may still be encoded by the writer thread.
+        auto bufferIndex = batchIndex % 2;
+        auto &storage = batchStorage[bufferIndex];
+        auto &states = batchStates[bufferIndex];
+        auto &destinations = batchDestinations[bufferIndex];
+        storage.resize(batchFrameCount*frameSize);
+        states.clear();
+        destinations.clear();
+        batchFirstFrame[bufferIndex] = nextFrameIndex;
+        for(; states.size() < batchFrameCount && nextFrameIndex < frameCount; ++nextFrameIndex)
+        {
+            destinations.push_back(storage.data() + states.size()*frameSize);
+            states.push_back(getFrameState(nextFrameIndex));
+        }
+
+        if(!renderer(states, destinations))
+        {
+            fprintf(stderr, "Failed to render the frames of the timeline.\n");
+            succeeded = false;
+            break;
+        }
+
+        if(writerThread.joinable())
+        {
+            writerThread.join();
+            if(!writerSucceeded)
+            {
+                succeeded = false;
+                break;
+            }
+        }
+
+        writerThread = std::thread(writeBatch, bufferIndex);
+
+        auto now = std::chrono::steady_clock::now();
+        if(now - lastProgressTime >= std::chrono::seconds(1) || nextFrameIndex == frameCount)
+        {
+            double elapsedSeconds = std::chrono::duration<double> (now - startTime).count();
+            printf("Rendered %zu/%zu frames (%.1f%%), %.1f frames/s\n", nextFrameIndex, frameCount,
+                nextFrameIndex*100.0 / frameCount, nextFrameIndex / elapsedSeconds);
+            lastProgressTime = now;
+        }
+    }
+
+    if(writerThread.joinable())
+        writerThread.join();
+    succeeded = succeeded && writerSucceeded;
+    if(isVideo)
+        succeeded = videoWriter.close() && succeeded;
+    return succeeded;
+}
+
+bool TimelineRenderer::renderBatchWithCPU(TiledNoiseRasterizer &rasterizer, const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations)
+{
+    // Each frame is already split in tiles over the whole thread pool.
+    for(size_t i = 0; i < states.size(); ++i)
+        rasterizer.render(states[i], destinations[i], states[i].screenWidth);
+    return true;
+}
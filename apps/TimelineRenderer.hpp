@@ -0,0 +1,52 @@
+#ifndef SHADER_VIS_TIMELINE_RENDERER_HPP
+#define SHADER_VIS_TIMELINE_RENDERER_HPP
+
+#include "ParameterTimeline.hpp"
+#include "TiledNoiseRasterizer.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Renders a batch of frames. Each B8G8R8A8 frame is written to its destination,
+// with a pitch of the screen width of the states.
+typedef std::function<bool (const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations)> TimelineFrameBatchRenderer;
+
+/**
+ * Renders every frame of a parameter timeline offline, at a fixed frame rate,
+ * into a Y4M video or a numbered image sequence. The frames are rendered in
+ * batches into one of two buffers, while a writer thread encodes the previous
+ * batch, so the rendering and the encoding overlap.
+ */
+class TimelineRenderer
+{
+public:
+    TimelineRenderer(const ParameterTimeline &timeline, const ScreenAndUIState &baseState, uint32_t framesPerSecond);
+
+    // The frames from the time zero to the last keyframe, both included.
+    size_t getFrameCount() const;
+
+    ScreenAndUIState getFrameState(size_t frameIndex) const;
+
+    void setBatchSize(size_t newBatchSize)
+    {
+        batchSize = newBatchSize > 0 ? newBatchSize : 1;
+    }
+
+    // A name ending with .y4m writes a video. Otherwise, the name is a printf
+    // pattern for the frame index, e.g. frame%04d.png, or %05d is inserted
+    // before its extension. The pattern must contain exactly one %d or %0Nd,
+    // and %% for a literal %.
+    bool render(const std::string &outputFileName, const TimelineFrameBatchRenderer &renderer);
+
+    static bool renderBatchWithCPU(TiledNoiseRasterizer &rasterizer, const std::vector<ScreenAndUIState> &states, const std::vector<uint32_t*> &destinations);
+
+    static bool getFrameFileNamePattern(const std::string &outputFileName, std::string &pattern);
+
+private:
+    const ParameterTimeline &timeline;
+    ScreenAndUIState baseState;
+    uint32_t framesPerSecond;
+    size_t batchSize = 8;
+};
+
+#endif //SHADER_VIS_TIMELINE_RENDERER_HPP
@@ -0,0 +1,54 @@
+#include "UIElementQuad.hpp"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHADER_VIS_UI_QUAD_PACKING_SSE2
+#endif
+
+void packUIElementQuads(const UIElementQuad *quads, size_t count, PackedUIElementQuad *dest)
+{
+#ifdef SHADER_VIS_UI_QUAD_PACKING_SSE2
+    // The four components of each group are converted at once. The saturating
+    // packs clamp the values, and SSE2 only has a signed 32 to 16 bit pack, so
+    // the unsigned fields are biased into the signed range and back.
+    const __m128 conversionMinimum = _mm_set1_ps(-1048576.0f);
+    const __m128 conversionMaximum = _mm_set1_ps(1048576.0f);
+    auto convert = [&](const float *components, __m128 scale) {
+        // Out of range floats would convert into the integer minimum.
+        auto scaled = _mm_mul_ps(_mm_loadu_ps(components), scale);
+        return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(scaled, conversionMinimum), conversionMaximum));
+    };
+    const __m128 rectangleScale = _mm_set1_ps(4.0f);
+    const __m128 colorScale = _mm_set1_ps(255.0f);
+    const __m128 fontScale = _mm_set1_ps(65535.0f);
+    const __m128i unsignedBias = _mm_set1_epi32(32768);
+    const __m128i unsignedBiasSign = _mm_set1_epi16(int16_t(0x8000));
+    const __m128i extentMask = _mm_set_epi16(0, 0, 0, 0, -1, -1, 0, 0);
+    for(size_t i = 0; i < count; ++i)
+    {
+        auto &quad = quads[i];
+        auto &packed = dest[i];
+
+        auto rectangle = convert(&quad.x, rectangleScale);
+        auto signedRectangle = _mm_packs_epi32(rectangle, rectangle);
+        auto unsignedRectangle = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(rectangle, unsignedBias), rectangle), unsignedBiasSign);
+        auto packedRectangle = _mm_or_si128(_mm_andnot_si128(extentMask, signedRectangle), _mm_and_si128(extentMask, unsignedRectangle));
+        _mm_storel_epi64(reinterpret_cast<__m128i*> (&packed.x), packedRectangle);
+
+        auto color = convert(&quad.r, colorScale);
+        color = _mm_packs_epi32(color, color);
+        packed.color = uint32_t(_mm_cvtsi128_si32(_mm_packus_epi16(color, color)));
+
+        auto glyphMask = _mm_set1_epi32(quad.isGlyph ? -1 : 0);
+        auto font = convert(&quad.fontX, fontScale);
+        font = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(font, unsignedBias), font), unsignedBiasSign);
+        _mm_storel_epi64(reinterpret_cast<__m128i*> (&packed.fontX), _mm_and_si128(font, glyphMask));
+        if(quad.isGlyph && packed.fontWidth == 0)
+            packed.fontWidth = 1;
+    }
+#else
+    for(size_t i = 0; i < count; ++i)
+        dest[i] = packUIElementQuad(quads[i]);
+#endif
+}
@@ -0,0 +1,108 @@
+#ifndef SHADER_VIS_UI_ELEMENT_QUAD_HPP
+#define SHADER_VIS_UI_ELEMENT_QUAD_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+/**
+ * An instance of the UI pipeline. The layout must match the std430
+ * UIElementQuad structure that is declared in uiElementVertex.glsl.
+ */
+struct UIElementQuad
+{
+    float x, y;
+    float width, height;
+
+    float r, g, b, a;
+
+    uint32_t isGlyph;
+    uint32_t reserved[3];
+
+    float fontX, fontY;
+    float fontWidth, fontHeight;
+};
+
+/**
+ * The compact encoding of a UIElementQuad, which is decoded by the std430
+ * PackedUIElementQuad structure of uiElementVertex.glsl. The positions and
+ * sizes are in quarter pixels, the color is RGBA8 with red in the lowest
+ * byte, and the font rectangle is in 16-bit normalized texture coordinates.
+ * A zero font width marks a plain rectangle.
+ */
+struct PackedUIElementQuad
+{
+    int16_t x, y;
+    uint16_t width, height;
+
+    uint32_t color;
+
+    uint16_t fontX, fontY;
+    uint16_t fontWidth, fontHeight;
+};
+
+static_assert(sizeof(PackedUIElementQuad) == 20, "PackedUIElementQuad must match its shader layout");
+
+// The conversions round half to even, like the SSE2 conversion of
+// packUIElementQuads in the default rounding mode, so that both packers
+// produce the same bits. The values are clamped to the same range as there,
+// and NaN maps to its minimum.
+inline int32_t roundUIElementValue(float value)
+{
+    value = value > -1048576.0f ? std::min(value, 1048576.0f) : -1048576.0f;
+    return int32_t(lrintf(value));
+}
+
+inline int32_t clampUIElementInteger(int32_t value, int32_t minValue, int32_t maxValue)
+{
+    return std::min(std::max(value, minValue), maxValue);
+}
+
+inline int16_t packUIElementCoordinate(float value)
+{
+    return int16_t(clampUIElementInteger(roundUIElementValue(value*4.0f), -32768, 32767));
+}
+
+inline uint16_t packUIElementExtent(float value)
+{
+    return uint16_t(clampUIElementInteger(roundUIElementValue(value*4.0f), 0, 65535));
+}
+
+inline uint32_t packUIElementUnorm8(float value)
+{
+    return uint32_t(clampUIElementInteger(roundUIElementValue(value*255.0f), 0, 255));
+}
+
+inline uint16_t packUIElementUnorm16(float value)
+{
+    return uint16_t(clampUIElementInteger(roundUIElementValue(value*65535.0f), 0, 65535));
+}
+
+inline PackedUIElementQuad packUIElementQuad(const UIElementQuad &quad)
+{
+    PackedUIElementQuad packed;
+    packed.x = packUIElementCoordinate(quad.x);
+    packed.y = packUIElementCoordinate(quad.y);
+    packed.width = packUIElementExtent(quad.width);
+    packed.height = packUIElementExtent(quad.height);
+    packed.color = packUIElementUnorm8(quad.r) | (packUIElementUnorm8(quad.g) << 8) |
+        (packUIElementUnorm8(quad.b) << 16) | (packUIElementUnorm8(quad.a) << 24);
+    if(quad.isGlyph)
+    {
+        packed.fontX = packUIElementUnorm16(quad.fontX);
+        packed.fontY = packUIElementUnorm16(quad.fontY);
+        packed.fontWidth = std::max(packUIElementUnorm16(quad.fontWidth), uint16_t(1));
+        packed.fontHeight = packUIElementUnorm16(quad.fontHeight);
+    }
+    else
+    {
+        packed.fontX = packed.fontY = packed.fontWidth = packed.fontHeight = 0;
+    }
+    return packed;
+}
+
+// Packs consecutive quads, with SSE2 where it is available.
+void packUIElementQuads(const UIElementQuad *quads, size_t count, PackedUIElementQuad *dest);
+
+#endif //SHADER_VIS_UI_ELEMENT_QUAD_HPP
@@ -0,0 +1,260 @@
+#include "BenchmarkReport.hpp"
+#include "TiledNoiseRasterizer.hpp"
+#include "VoronoiNoiseStatistics.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * Measures the throughput of the CPU Voronoi noise paths, and checks that
+ * every SIMD level produces the same pixels as the scalar path. The
+ * evaluation that only tracks the needed nearest distances is compared with
+ * the generic one for each set of Voronoi factors, the viewport statistics of
+ * the auto range are compared between the levels, the cell table of the
+ * feature points is compared with their hashing across zoom levels, and the
+ * tiled rasterizer is then measured with an increasing number of threads.
+ */
+// Adds the iteration times to the report, and returns the best one in seconds.
+template<typename FT>
+static double measureBestSeconds(BenchmarkReport &report, const std::string &name, double itemsPerIteration, int iterations, const FT &function)
+{
+    report.addSamples(name, sampleBenchmark(0, size_t(iterations), function), itemsPerIteration);
+    return report.getResults().back().minimum * 1e-9;
+}
+
+int main(int argc, const char *argv[])
+{
+    ScreenAndUIState state;
+    state.screenWidth = 1024;
+    state.screenHeight = 1024;
+    int iterations = 3;
+    size_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::string jsonFileName;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-size" && i + 1 < argc)
+        {
+            unsigned int width = 0, height = 0;
+            if(sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+            {
+                state.screenWidth = width;
+                state.screenHeight = height;
+            }
+        }
+        else if (arg == "-octaves" && i + 1 < argc)
+        {
+            state.octaves = float(atof(argv[++i]));
+        }
+        else if (arg == "-iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (arg == "-threads" && i + 1 < argc)
+        {
+            maxThreadCount = size_t(std::max(1, atoi(argv[++i])));
+        }
+        else if (arg == "-json" && i + 1 < argc)
+        {
+            jsonFileName = argv[++i];
+        }
+    }
+
+    size_t pixelCount = size_t(state.screenWidth) * state.screenHeight;
+    printf("Voronoi noise %ux%u, %d octaves, %d iterations\n", state.screenWidth, state.screenHeight, int(state.octaves), iterations);
+
+    std::vector<uint32_t> reference;
+    const VoronoiNoiseSIMDLevel levels[] = {
+        VoronoiNoiseSIMDLevel::Scalar,
+        VoronoiNoiseSIMDLevel::SSE4,
+        VoronoiNoiseSIMDLevel::AVX2,
+    };
+
+    BenchmarkReport report("VoronoiNoiseBench");
+    report.setContext("resolution", std::to_string(state.screenWidth) + "x" + std::to_string(state.screenHeight));
+    report.setContext("octaves", std::to_string(int(state.octaves)));
+
+    int exitCode = 0;
+    for(auto level : levels)
+    {
+        auto levelName = getVoronoiNoiseSIMDLevelName(level);
+        if(!isVoronoiNoiseSIMDLevelSupported(level))
+        {
+            printf("%-8s not supported\n", levelName);
+            continue;
+        }
+
+        std::vector<uint32_t> pixels(pixelCount);
+        double bestSeconds = measureBestSeconds(report, std::string("noise/") + levelName, double(pixelCount), iterations, [&]() {
+            renderVoronoiNoiseRegion(state, 0, 0, state.screenWidth, state.screenHeight, pixels.data(), state.screenWidth, level);
+        });
+
+        const char *matchStatus = "reference";
+        if(reference.empty())
+        {
+            reference = pixels;
+        }
+        else if(memcmp(reference.data(), pixels.data(), pixelCount*sizeof(uint32_t)) != 0)
+        {
+            matchStatus = "MISMATCH";
+            exitCode = 1;
+        }
+        else
+        {
+            matchStatus = "matches scalar";
+        }
+
+        printf("%-8s %10.3f Mpixels/s  %s\n", levelName, pixelCount / bestSeconds * 1e-6, matchStatus);
+    }
+
+    // Specialization by the nearest distances that have a nonzero factor.
+    struct FactorSet
+    {
+        const char *name;
+        float factors[4];
+    };
+    const FactorSet factorSets[] = {
+        {"F1", {1, 0, 0, 0}},
+        {"F2-F1", {-1, 1, 0, 0}},
+        {"F1+F3", {0.5f, 0, 0.5f, 0}},
+        {"F1..F4", {0.25f, 0.25f, 0.25f, 0.25f}},
+    };
+    auto bestLevel = getBestVoronoiNoiseSIMDLevel();
+    for(auto &factorSet : factorSets)
+    {
+        auto factorState = state;
+        factorState.voronoiF1 = factorSet.factors[0];
+        factorState.voronoiF2 = factorSet.factors[1];
+        factorState.voronoiF3 = factorSet.factors[2];
+        factorState.voronoiF4 = factorSet.factors[3];
+
+        std::vector<uint32_t> genericPixels(pixelCount);
+        std::vector<uint32_t> specializedPixels(pixelCount);
+        auto factorName = std::string("factors/") + getVoronoiNoiseSIMDLevelName(bestLevel) + "/" + factorSet.name;
+        double genericSeconds = measureBestSeconds(report, factorName + "/generic", double(pixelCount), iterations, [&]() {
+            renderVoronoiNoiseRegion(factorState, 0, 0, state.screenWidth, state.screenHeight, genericPixels.data(), state.screenWidth, bestLevel, false);
+        });
+        double specializedSeconds = measureBestSeconds(report, factorName + "/specialized", double(pixelCount), iterations, [&]() {
+            renderVoronoiNoiseRegion(factorState, 0, 0, state.screenWidth, state.screenHeight, specializedPixels.data(), state.screenWidth, bestLevel, true);
+        });
+
+        bool matches = genericPixels == specializedPixels;
+        if(!matches)
+            exitCode = 1;
+
+        printf("%-8s %-8s %10.3f Mpixels/s  generic %10.3f Mpixels/s  speedup %5.2fx  %s\n",
+            getVoronoiNoiseSIMDLevelName(bestLevel), factorSet.name,
+            pixelCount / specializedSeconds * 1e-6, pixelCount / genericSeconds * 1e-6, genericSeconds / specializedSeconds,
+            matches ? "matches generic" : "MISMATCH");
+    }
+
+    // Statistics of the noise value over the sample grid of the viewport.
+    auto statisticsStep = getVoronoiNoiseStatisticsSampleStep(state.screenWidth, state.screenHeight);
+    VoronoiNoiseStatistics referenceStatistics = {};
+    for(auto level : levels)
+    {
+        if(!isVoronoiNoiseSIMDLevelSupported(level))
+            continue;
+
+        VoronoiNoiseStatistics statistics;
+        double bestSeconds = measureBestSeconds(report, std::string("statistics/") + getVoronoiNoiseSIMDLevelName(level), 1.0, iterations, [&]() {
+            computeVoronoiNoiseStatistics(state, statisticsStep, statistics, level);
+        });
+
+        const char *matchStatus = "reference";
+        if(level == VoronoiNoiseSIMDLevel::Scalar)
+        {
+            referenceStatistics = statistics;
+        }
+        else if(memcmp(&referenceStatistics, &statistics, sizeof(statistics)) != 0)
+        {
+            matchStatus = "MISMATCH";
+            exitCode = 1;
+        }
+        else
+        {
+            matchStatus = "matches scalar";
+        }
+
+        printf("%-8s statistics %u samples %8.3f ms  p1 %.4f p99 %.4f  %s\n", getVoronoiNoiseSIMDLevelName(level), statistics.sampleCount, bestSeconds*1000.0,
+            getVoronoiNoiseStatisticsPercentile(statistics, 0.01f), getVoronoiNoiseStatisticsPercentile(statistics, 0.99f), matchStatus);
+    }
+
+    // Cell table of the feature points across zoom levels. The table is
+    // rebuilt in each iteration, as it would be in each frame, and its cost is
+    // included. The zoomed out views have more cells than the table budget,
+    // so their later octaves are hashed.
+    const float screenScales[] = {1.0f, 10.0f, 100.0f, 400.0f, 1000.0f};
+    for(auto screenScale : screenScales)
+    {
+        auto zoomState = state;
+        zoomState.screenScale = screenScale;
+        for(auto level : levels)
+        {
+            if(!isVoronoiNoiseSIMDLevelSupported(level))
+                continue;
+
+            std::vector<uint32_t> hashedPixels(pixelCount);
+            std::vector<uint32_t> tablePixels(pixelCount);
+            VoronoiNoiseCellTable cellTable;
+            auto zoomName = std::string("cell-table/") + getVoronoiNoiseSIMDLevelName(level) + "/scale=" + std::to_string(int(screenScale));
+            double hashedSeconds = measureBestSeconds(report, zoomName + "/hashed", double(pixelCount), iterations, [&]() {
+                renderVoronoiNoiseRegion(zoomState, 0, 0, state.screenWidth, state.screenHeight, hashedPixels.data(), state.screenWidth, level);
+            });
+            double tableSeconds = measureBestSeconds(report, zoomName + "/table", double(pixelCount), iterations, [&]() {
+                cellTable.build(zoomState);
+                renderVoronoiNoiseRegion(zoomState, 0, 0, state.screenWidth, state.screenHeight, tablePixels.data(), state.screenWidth, level, true, &cellTable);
+            });
+
+            uint32_t tableOctaveCount = 0;
+            for(uint32_t octave = 0; octave < cellTable.header.octaveCount; ++octave)
+                tableOctaveCount += cellTable.header.octaves[octave].width > 0 ? 1 : 0;
+
+            bool matches = hashedPixels == tablePixels;
+            if(!matches)
+                exitCode = 1;
+
+            printf("%-8s scale %6.0f  table %10.3f Mpixels/s  hashed %10.3f Mpixels/s  speedup %5.2fx  %7u points %d/%d octaves  %s\n",
+                getVoronoiNoiseSIMDLevelName(level), screenScale,
+                pixelCount / tableSeconds * 1e-6, pixelCount / hashedSeconds * 1e-6, hashedSeconds / tableSeconds,
+                cellTable.header.pointCount, int(tableOctaveCount), int(zoomState.octaves),
+                matches ? "matches hashed" : "MISMATCH");
+        }
+    }
+
+    // Thread scaling of the tiled rasterizer.
+    double singleThreadSeconds = 0;
+    for(size_t threadCount = 1; ; threadCount = std::min(threadCount*2, maxThreadCount))
+    {
+        WorkStealingThreadPool threadPool(threadCount);
+        TiledNoiseRasterizer rasterizer(threadPool);
+        std::vector<uint32_t> pixels(pixelCount);
+        double bestSeconds = measureBestSeconds(report, "tiled/threads=" + std::to_string(threadCount), double(pixelCount), iterations, [&]() {
+            rasterizer.render(state, pixels.data(), state.screenWidth);
+        });
+        if(threadCount == 1)
+            singleThreadSeconds = bestSeconds;
+
+        bool matches = memcmp(reference.data(), pixels.data(), pixelCount*sizeof(uint32_t)) == 0;
+        if(!matches)
+            exitCode = 1;
+
+        double speedup = singleThreadSeconds / bestSeconds;
+        printf("tiled %2d threads %10.3f Mpixels/s  speedup %5.2fx  efficiency %3d%%  %s\n",
+            int(threadCount), pixelCount / bestSeconds * 1e-6, speedup, int(speedup / threadCount * 100.0 + 0.5),
+            matches ? "matches scalar" : "MISMATCH");
+
+        if(threadCount == maxThreadCount)
+            break;
+    }
+
+    // The JSON results record whether every path matched its reference.
+    report.setContext("matches", exitCode == 0 ? "true" : "false");
+    if(!jsonFileName.empty() && !report.writeJSON(jsonFileName))
+        return 1;
+    return exitCode;
+}
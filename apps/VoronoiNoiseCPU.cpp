@@ -0,0 +1,394 @@
+#include "VoronoiNoiseCPU.hpp"
+#include "VoronoiNoiseCPUKernels.hpp"
+#include "VoronoiNoiseVariant.hpp"
+#include <math.h>
+
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static bool cpuSupportsSSE4()
+{
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD)
+#   if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#   else
+    return __builtin_cpu_supports("sse4.1");
+#   endif
+#else
+    return false;
+#endif
+}
+
+static bool cpuSupportsAVX2()
+{
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD)
+#   if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7)
+        return false;
+
+    // The OS must also save the YMM registers.
+    __cpuid(info, 1);
+    bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+    bool hasAVX = (info[2] & (1 << 28)) != 0;
+    if(!hasOSXSave || !hasAVX || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#   else
+    return __builtin_cpu_supports("avx2");
+#   endif
+#else
+    return false;
+#endif
+}
+
+bool isVoronoiNoiseSIMDLevelSupported(VoronoiNoiseSIMDLevel level)
+{
+    switch(level)
+    {
+    case VoronoiNoiseSIMDLevel::Scalar:
+        return true;
+    case VoronoiNoiseSIMDLevel::SSE4:
+        return cpuSupportsSSE4();
+    case VoronoiNoiseSIMDLevel::AVX2:
+        return cpuSupportsAVX2();
+    default:
+        return false;
+    }
+}
+
+VoronoiNoiseSIMDLevel getBestVoronoiNoiseSIMDLevel()
+{
+    static VoronoiNoiseSIMDLevel bestLevel = []() {
+        if(cpuSupportsAVX2())
+            return VoronoiNoiseSIMDLevel::AVX2;
+        if(cpuSupportsSSE4())
+            return VoronoiNoiseSIMDLevel::SSE4;
+        return VoronoiNoiseSIMDLevel::Scalar;
+    } ();
+    return bestLevel;
+}
+
+const char *getVoronoiNoiseSIMDLevelName(VoronoiNoiseSIMDLevel level)
+{
+    switch(level)
+    {
+    case VoronoiNoiseSIMDLevel::Scalar: return "scalar";
+    case VoronoiNoiseSIMDLevel::SSE4: return "sse4";
+    case VoronoiNoiseSIMDLevel::AVX2: return "avx2";
+    default: return "unknown";
+    }
+}
+
+/**
+ * Hash function from: https://nullprogram.com/blog/2018/07/31/ and https://github.com/skeeto/hash-prospector .
+ * Released by the original author on the public domain.
+ *
+ * GLSL integer multiplication wraps around, and >> on an int is an arithmetic shift.
+ */
+int32_t voronoiLowbias32(int32_t x)
+{
+    x ^= x >> 16;
+    x = int32_t(uint32_t(x) * 0x7feb352du);
+    x ^= x >> 15;
+    x = int32_t(uint32_t(x) * 0x846ca68bu);
+    x ^= x >> 16;
+    return x;
+}
+
+static inline int32_t wrappingMultiplyAdd(int32_t a, int32_t b, int32_t c, int32_t d)
+{
+    return int32_t(uint32_t(a)*uint32_t(b) + uint32_t(c)*uint32_t(d));
+}
+
+void voronoiRandomNoiseVector2(float x, float y, float result[2])
+{
+    int32_t fx = int32_t(floorf(x));
+    int32_t fy = int32_t(floorf(y));
+    int32_t fhx = voronoiLowbias32(fx);
+    int32_t fhy = voronoiLowbias32(fy);
+    result[0] = float(voronoiLowbias32(wrappingMultiplyAdd(fhx, 27901, fhy, 8537))) / 4294967295.0f;
+    result[1] = float(voronoiLowbias32(wrappingMultiplyAdd(fhx, 6581, fhy, 21881))) / 4294967295.0f;
+}
+
+// These follow the SSE min/max semantics, so that NaN propagates equally in all the paths.
+static inline float minFloat(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+static inline float maxFloat(float a, float b)
+{
+    return a > b ? a : b;
+}
+
+// Only the ComponentCount nearest distances are tracked, and the other ones are
+// zero. The feature points are fetched from the cell table when it has all
+// the neighbor cells, and hashed otherwise.
+template<int ComponentCount>
+static inline void evaluateVoronoiNoiseComponents(float x, float y, float result[4],
+    const VoronoiNoiseCellTableOctave *tableOctave = nullptr, const float *tablePoints = nullptr)
+{
+    float r[4] = {1.0e10f, 1.0e10f, 1.0e10f, 1.0e10f};
+    float startCellX = floorf(x);
+    float startCellY = floorf(y);
+    float fx = x - startCellX;
+    float fy = y - startCellY;
+
+    const float *tableCell = nullptr;
+    int32_t tableWidth = 0;
+    if(tableOctave && isVoronoiNoiseCellInTable(*tableOctave, startCellX, startCellY))
+    {
+        tableWidth = int32_t(tableOctave->width);
+        auto cellIndex = (int32_t(startCellY) - tableOctave->originY)*tableWidth + int32_t(startCellX) - tableOctave->originX;
+        tableCell = tablePoints + (size_t(tableOctave->offset) + size_t(cellIndex))*2;
+    }
+
+    for(int cy = -1; cy <= 1; ++cy)
+    {
+        for(int cx = -1; cx <= 1; ++cx)
+        {
+            float cellDeltaX = float(cx);
+            float cellDeltaY = float(cy);
+            float hashedPoint[2];
+            const float *point = hashedPoint;
+            if(tableCell)
+                point = tableCell + ptrdiff_t(cy*tableWidth + cx)*2;
+            else
+                voronoiRandomNoiseVector2(startCellX + cellDeltaX, startCellY + cellDeltaY, hashedPoint);
+
+            float deltaX = fx - (point[0] + cellDeltaX);
+            float deltaY = fy - (point[1] + cellDeltaY);
+            float dist2 = deltaX*deltaX + deltaY*deltaY;
+            if(ComponentCount == 1)
+            {
+                r[0] = minFloat(dist2, r[0]);
+            }
+            else if(dist2 < r[0])
+            {
+                r[3] = r[2]; r[2] = r[1]; r[1] = r[0]; r[0] = dist2;
+            }
+            else if(dist2 < r[1])
+            {
+                r[3] = r[2]; r[2] = r[1]; r[1] = dist2;
+            }
+            else if(ComponentCount > 2 && dist2 < r[2])
+            {
+                r[3] = r[2]; r[2] = dist2;
+            }
+            else if(ComponentCount > 3 && dist2 < r[3])
+            {
+                r[3] = dist2;
+            }
+        }
+    }
+
+    for(int i = 0; i < 4; ++i)
+        result[i] = i < ComponentCount ? minFloat(sqrtf(r[i]), 1.0f) : 0.0f;
+}
+
+void voronoiNoiseComponents(float x, float y, float result[4])
+{
+    evaluateVoronoiNoiseComponents<4> (x, y, result);
+}
+
+void prepareVoronoiNoiseKernelParameters(const ScreenAndUIState &state, VoronoiNoiseKernelParameters &parameters)
+{
+    parameters.screenWidth = float(state.screenWidth);
+    parameters.screenHeight = float(state.screenHeight);
+    parameters.screenAspect = parameters.screenHeight / parameters.screenWidth;
+    parameters.screenScale = state.screenScale;
+    parameters.screenOffsetX = state.screenOffsetX;
+    parameters.screenOffsetY = state.screenOffsetY;
+    parameters.flipVertically = state.flipVertically != 0;
+
+    parameters.octaves = int32_t(state.octaves);
+    parameters.componentCount = int32_t(getVoronoiNoiseComponentCount(state));
+    parameters.amplitude = state.amplitude;
+    parameters.lacunarity = state.lacunarity;
+    parameters.factors[0] = state.voronoiF1;
+    parameters.factors[1] = state.voronoiF2;
+    parameters.factors[2] = state.voronoiF3;
+    parameters.factors[3] = state.voronoiF4;
+
+    if(state.startThreshold <= state.endThreshold)
+    {
+        parameters.thresholdLow = state.startThreshold;
+        parameters.thresholdRange = state.endThreshold - state.startThreshold;
+    }
+    else
+    {
+        parameters.thresholdLow = state.endThreshold;
+        parameters.thresholdRange = state.startThreshold - state.endThreshold;
+    }
+
+    parameters.startColor[0] = state.startColorRed;
+    parameters.startColor[1] = state.startColorGreen;
+    parameters.startColor[2] = state.startColorBlue;
+    parameters.startColor[3] = state.startColorAlpha;
+    parameters.endColor[0] = state.endColorRed;
+    parameters.endColor[1] = state.endColorGreen;
+    parameters.endColor[2] = state.endColorBlue;
+    parameters.endColor[3] = state.endColorAlpha;
+
+    parameters.cellTable = nullptr;
+    parameters.cellTablePoints = nullptr;
+}
+
+static inline uint32_t encodeUnorm8(float value)
+{
+    return uint32_t(minFloat(maxFloat(value, 0.0f), 1.0f)*255.0f + 0.5f);
+}
+
+// The amplitude normalized sum of the octaves, before the Voronoi factors are applied.
+template<int ComponentCount>
+static inline void evaluateVoronoiNoiseOctaves(const VoronoiNoiseKernelParameters &parameters, float noiseCoordinateX, float noiseCoordinateY, float noiseComponents[4])
+{
+    float noiseGain = 1.0f;
+    float totalGain = 0.0f;
+
+    for(int c = 0; c < 4; ++c)
+        noiseComponents[c] = 0.0f;
+    for(int32_t octave = 0; octave < parameters.octaves; ++octave)
+    {
+        float components[4];
+        auto tableOctave = getVoronoiNoiseCellTableOctave(parameters, octave);
+        evaluateVoronoiNoiseComponents<ComponentCount> (noiseCoordinateX, noiseCoordinateY, components, tableOctave, parameters.cellTablePoints);
+        for(int c = 0; c < 4; ++c)
+            noiseComponents[c] += components[c]*noiseGain;
+        totalGain += noiseGain;
+
+        noiseCoordinateX *= parameters.lacunarity;
+        noiseCoordinateY *= parameters.lacunarity;
+        noiseGain /= parameters.lacunarity;
+    }
+
+    float normalization = parameters.amplitude / totalGain;
+    for(int c = 0; c < 4; ++c)
+        noiseComponents[c] *= normalization;
+}
+
+static inline float computeViewPositionY(const VoronoiNoiseKernelParameters &parameters, uint32_t y)
+{
+    float screenCoordY = (float(int32_t(y)) + 0.5f) / parameters.screenHeight;
+    if(!parameters.flipVertically)
+        screenCoordY = -screenCoordY;
+    return (screenCoordY - 0.5f)*parameters.screenScale*parameters.screenAspect - parameters.screenOffsetY;
+}
+
+static inline float computeViewPositionX(const VoronoiNoiseKernelParameters &parameters, uint32_t x)
+{
+    float screenCoordX = (float(int32_t(x)) + 0.5f) / parameters.screenWidth;
+    return (screenCoordX - 0.5f)*parameters.screenScale - parameters.screenOffsetX;
+}
+
+// The noise value before the thresholds are applied.
+template<int ComponentCount>
+static inline float evaluateVoronoiNoiseValue(const VoronoiNoiseKernelParameters &parameters, uint32_t x, float viewPositionY)
+{
+    float noiseComponents[4];
+    evaluateVoronoiNoiseOctaves<ComponentCount> (parameters, computeViewPositionX(parameters, x), viewPositionY, noiseComponents);
+    return noiseComponents[0]*parameters.factors[0] + noiseComponents[1]*parameters.factors[1] +
+        noiseComponents[2]*parameters.factors[2] + noiseComponents[3]*parameters.factors[3];
+}
+
+template<int ComponentCount>
+static void renderVoronoiNoiseRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    float viewPositionY = computeViewPositionY(parameters, y);
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        float noiseValue = evaluateVoronoiNoiseValue<ComponentCount> (parameters, x + i, viewPositionY);
+        noiseValue = minFloat(maxFloat((noiseValue - parameters.thresholdLow) / parameters.thresholdRange, 0.0f), 1.0f);
+
+        uint32_t encoded[4];
+        for(int c = 0; c < 4; ++c)
+            encoded[c] = encodeUnorm8(parameters.startColor[c]*(1.0f - noiseValue) + parameters.endColor[c]*noiseValue);
+
+        // B8G8R8A8
+        destination[i] = encoded[2] | (encoded[1] << 8) | (encoded[0] << 16) | (encoded[3] << 24);
+    }
+}
+
+void renderVoronoiNoiseRowScalar(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: renderVoronoiNoiseRow<1> (parameters, x, y, count, destination); break;
+    case 2: renderVoronoiNoiseRow<2> (parameters, x, y, count, destination); break;
+    case 3: renderVoronoiNoiseRow<3> (parameters, x, y, count, destination); break;
+    default: renderVoronoiNoiseRow<4> (parameters, x, y, count, destination); break;
+    }
+}
+
+template<int ComponentCount>
+static void evaluateVoronoiNoiseValueRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    float viewPositionY = computeViewPositionY(parameters, y);
+    for(uint32_t i = 0; i < count; ++i)
+        destination[i] = evaluateVoronoiNoiseValue<ComponentCount> (parameters, x + i, viewPositionY);
+}
+
+void evaluateVoronoiNoiseValueRowScalar(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: evaluateVoronoiNoiseValueRow<1> (parameters, x, y, count, destination); break;
+    case 2: evaluateVoronoiNoiseValueRow<2> (parameters, x, y, count, destination); break;
+    case 3: evaluateVoronoiNoiseValueRow<3> (parameters, x, y, count, destination); break;
+    default: evaluateVoronoiNoiseValueRow<4> (parameters, x, y, count, destination); break;
+    }
+}
+
+void renderVoronoiNoiseRegion(const ScreenAndUIState &state,
+    uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    uint32_t *destination, size_t destinationPitch,
+    VoronoiNoiseSIMDLevel level, bool specialized,
+    const VoronoiNoiseCellTable *cellTable)
+{
+    if(!isVoronoiNoiseSIMDLevelSupported(level))
+        level = getBestVoronoiNoiseSIMDLevel();
+
+    VoronoiNoiseKernelParameters parameters;
+    prepareVoronoiNoiseKernelParameters(state, parameters);
+    if(!specialized)
+        parameters.componentCount = 4;
+    if(cellTable)
+    {
+        parameters.cellTable = &cellTable->header;
+        parameters.cellTablePoints = cellTable->points.data();
+    }
+
+    auto rowFunction = &renderVoronoiNoiseRowScalar;
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD)
+    if(level == VoronoiNoiseSIMDLevel::AVX2)
+        rowFunction = &renderVoronoiNoiseRowAVX2;
+    else if(level == VoronoiNoiseSIMDLevel::SSE4)
+        rowFunction = &renderVoronoiNoiseRowSSE4;
+#endif
+
+    for(uint32_t row = 0; row < height; ++row)
+        rowFunction(parameters, x, y + row, width, destination + row*destinationPitch);
+}
+
+void renderVoronoiNoiseComponentsRegion(const ScreenAndUIState &state,
+    uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    float *destination, size_t destinationPitch)
+{
+    VoronoiNoiseKernelParameters parameters;
+    prepareVoronoiNoiseKernelParameters(state, parameters);
+
+    for(uint32_t row = 0; row < height; ++row)
+    {
+        float viewPositionY = computeViewPositionY(parameters, y + row);
+        auto destinationRow = destination + (row*destinationPitch)*4;
+        for(uint32_t i = 0; i < width; ++i)
+            evaluateVoronoiNoiseOctaves<4> (parameters, computeViewPositionX(parameters, x + i), viewPositionY, destinationRow + i*4);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_CPU_HPP
+#define SHADER_VIS_VORONOI_NOISE_CPU_HPP
+
+#include "ScreenAndUIState.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+struct VoronoiNoiseCellTable;
+
+/**
+ * CPU implementation of assets/shaders/voronoiNoise.glsl.
+ *
+ * Every instruction set level performs exactly the same sequence of IEEE
+ * single precision operations as the shader (no fused multiply-add, no
+ * reciprocal approximations), so the scalar, SSE4 and AVX2 paths produce
+ * identical bits. The pixel (x, y) is evaluated at the interpolated screen
+ * coordinate of its center, with the rows stored from top to bottom as in a
+ * swap chain back buffer of a device with a top left NDC origin.
+ */
+enum class VoronoiNoiseSIMDLevel
+{
+    Scalar = 0,
+    SSE4,
+    AVX2,
+};
+
+/// The number of pixels that are processed together by the SIMD paths.
+static constexpr uint32_t VoronoiNoiseLaneGroupSize = 8;
+
+VoronoiNoiseSIMDLevel getBestVoronoiNoiseSIMDLevel();
+bool isVoronoiNoiseSIMDLevelSupported(VoronoiNoiseSIMDLevel level);
+const char *getVoronoiNoiseSIMDLevelName(VoronoiNoiseSIMDLevel level);
+
+// Scalar versions of the shader functions.
+int32_t voronoiLowbias32(int32_t x);
+void voronoiRandomNoiseVector2(float x, float y, float result[2]);
+void voronoiNoiseComponents(float x, float y, float result[4]);
+
+/**
+ * Evaluates the fragment shader for the pixels in the given region of the
+ * screen described by state, and writes them as B8G8R8A8_UNORM pixels. The
+ * destination pitch is expressed in pixels. Unless specialized is false, only
+ * the nearest distances that have a nonzero Voronoi factor are tracked, which
+ * gives the same pixels as the generic evaluation. The feature points are
+ * fetched from the cell table when one that was built for the same state is
+ * given, instead of being hashed, which also gives the same pixels.
+ */
+void renderVoronoiNoiseRegion(const ScreenAndUIState &state,
+    uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    uint32_t *destination, size_t destinationPitch,
+    VoronoiNoiseSIMDLevel level = getBestVoronoiNoiseSIMDLevel(),
+    bool specialized = true,
+    const VoronoiNoiseCellTable *cellTable = nullptr);
+
+/**
+ * Evaluates the amplitude normalized F1 to F4 distances of the same pixels,
+ * before the Voronoi factors, the thresholds and the colors are applied. Each
+ * pixel is written as four floats, and the pitch is expressed in pixels. Only
+ * the scalar path is available.
+ */
+void renderVoronoiNoiseComponentsRegion(const ScreenAndUIState &state,
+    uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+    float *destination, size_t destinationPitch);
+
+#endif //SHADER_VIS_VORONOI_NOISE_CPU_HPP
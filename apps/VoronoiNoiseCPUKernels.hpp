@@ -0,0 +1,73 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_CPU_KERNELS_HPP
+#define SHADER_VIS_VORONOI_NOISE_CPU_KERNELS_HPP
+
+#include "ScreenAndUIState.hpp"
+#include "VoronoiNoiseCellTable.hpp"
+#include <stdint.h>
+
+/**
+ * The shader uniforms unpacked for the row kernels. Each instruction set
+ * level lives in its own translation unit, because they are compiled with
+ * different code generation flags.
+ */
+struct VoronoiNoiseKernelParameters
+{
+    float screenWidth;
+    float screenHeight;
+    float screenAspect;
+    float screenScale;
+    float screenOffsetX;
+    float screenOffsetY;
+    bool flipVertically;
+
+    int32_t octaves;
+
+    // The nearest distances that are tracked, only the ones with a nonzero factor.
+    int32_t componentCount;
+    float amplitude;
+    float lacunarity;
+    float factors[4];
+
+    float thresholdLow;
+    float thresholdRange;
+
+    float startColor[4];
+    float endColor[4];
+
+    // The feature points of the cell table, or null when they are hashed.
+    const VoronoiNoiseCellTableHeader *cellTable;
+    const float *cellTablePoints;
+};
+
+// The cells of the octave in the cell table, or null when its feature points
+// are hashed. This is static, so that each translation unit keeps the code
+// that is generated with its own flags.
+static inline const VoronoiNoiseCellTableOctave *getVoronoiNoiseCellTableOctave(const VoronoiNoiseKernelParameters &parameters, int32_t octave)
+{
+    if(!parameters.cellTable || uint32_t(octave) >= parameters.cellTable->octaveCount)
+        return nullptr;
+
+    auto &tableOctave = parameters.cellTable->octaves[octave];
+    return tableOctave.width > 0 ? &tableOctave : nullptr;
+}
+
+// Whether the neighbor cells of a start cell are all in the table. The
+// coordinates of the table are exact in single precision.
+static inline bool isVoronoiNoiseCellInTable(const VoronoiNoiseCellTableOctave &tableOctave, float startCellX, float startCellY)
+{
+    return startCellX >= float(tableOctave.originX + 1) && startCellX < float(tableOctave.originX + int32_t(tableOctave.width) - 1) &&
+        startCellY >= float(tableOctave.originY + 1) && startCellY < float(tableOctave.originY + int32_t(tableOctave.height) - 1);
+}
+
+void prepareVoronoiNoiseKernelParameters(const ScreenAndUIState &state, VoronoiNoiseKernelParameters &parameters);
+
+void renderVoronoiNoiseRowScalar(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination);
+void renderVoronoiNoiseRowSSE4(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination);
+void renderVoronoiNoiseRowAVX2(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination);
+
+// The noise value of each pixel before the thresholds are applied, for the statistics.
+void evaluateVoronoiNoiseValueRowScalar(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination);
+void evaluateVoronoiNoiseValueRowSSE4(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination);
+void evaluateVoronoiNoiseValueRowAVX2(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination);
+
+#endif //SHADER_VIS_VORONOI_NOISE_CPU_KERNELS_HPP
@@ -0,0 +1,271 @@
+#include "VoronoiNoiseCPU.hpp"
+#include "VoronoiNoiseCPUKernels.hpp"
+#include <immintrin.h>
+#include <string.h>
+
+// This translation unit is compiled with AVX2 code generation enabled.
+// A lane group of 8 pixels fits exactly in one vector.
+
+static inline __m256i lowbias32(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(int32_t(0x846ca68bu)));
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 16));
+    return x;
+}
+
+// Only the ComponentCount nearest distances are tracked, and the other ones are
+// zero. The feature points are fetched from the cell table when it has the
+// neighbor cells of every lane, and hashed otherwise.
+template<int ComponentCount>
+static inline void voronoiNoiseComponents8(__m256 x, __m256 y, __m256 result[4],
+    const VoronoiNoiseCellTableOctave *tableOctave = nullptr, const float *tablePoints = nullptr)
+{
+    const __m256 hashRange = _mm256_set1_ps(4294967295.0f);
+    __m256 r0 = _mm256_set1_ps(1.0e10f);
+    __m256 r1 = r0;
+    __m256 r2 = r0;
+    __m256 r3 = r0;
+
+    __m256 startCellX = _mm256_floor_ps(x);
+    __m256 startCellY = _mm256_floor_ps(y);
+    __m256 fx = _mm256_sub_ps(x, startCellX);
+    __m256 fy = _mm256_sub_ps(y, startCellY);
+
+    // The table indices of the cells of the lanes are relative to the cell of
+    // the first lane, so that the points are broadcast when they are all zero.
+    const float *tableCell = nullptr;
+    int32_t tableWidth = 0;
+    __m256i tableIndices = _mm256_setzero_si256();
+    bool isSameTableCell = false;
+    if(tableOctave)
+    {
+        __m256 isInTable = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(startCellX, _mm256_set1_ps(float(tableOctave->originX + 1)), _CMP_GE_OQ),
+                _mm256_cmp_ps(startCellX, _mm256_set1_ps(float(tableOctave->originX + int32_t(tableOctave->width) - 1)), _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(startCellY, _mm256_set1_ps(float(tableOctave->originY + 1)), _CMP_GE_OQ),
+                _mm256_cmp_ps(startCellY, _mm256_set1_ps(float(tableOctave->originY + int32_t(tableOctave->height) - 1)), _CMP_LT_OQ)));
+        if(_mm256_movemask_ps(isInTable) == 0xFF)
+        {
+            tableWidth = int32_t(tableOctave->width);
+            __m256i cellIndices = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_cvttps_epi32(startCellY), _mm256_set1_epi32(tableOctave->originY)), _mm256_set1_epi32(tableWidth)),
+                _mm256_sub_epi32(_mm256_cvttps_epi32(startCellX), _mm256_set1_epi32(tableOctave->originX)));
+            int32_t firstCellIndex = _mm256_cvtsi256_si32(cellIndices);
+            tableCell = tablePoints + (size_t(tableOctave->offset) + size_t(firstCellIndex))*2;
+            tableIndices = _mm256_slli_epi32(_mm256_sub_epi32(cellIndices, _mm256_set1_epi32(firstCellIndex)), 1);
+            isSameTableCell = _mm256_testz_si256(tableIndices, tableIndices) != 0;
+        }
+    }
+
+    for(int cy = -1; cy <= 1; ++cy)
+    {
+        __m256 cellDeltaY = _mm256_set1_ps(float(cy));
+        __m256i fhy = _mm256_setzero_si256();
+        if(!tableCell)
+            fhy = lowbias32(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(startCellY, cellDeltaY))));
+        for(int cx = -1; cx <= 1; ++cx)
+        {
+            __m256 cellDeltaX = _mm256_set1_ps(float(cx));
+            __m256 pointX;
+            __m256 pointY;
+            if(tableCell)
+            {
+                auto neighborPoint = tableCell + ptrdiff_t(cy*tableWidth + cx)*2;
+                if(isSameTableCell)
+                {
+                    pointX = _mm256_set1_ps(neighborPoint[0]);
+                    pointY = _mm256_set1_ps(neighborPoint[1]);
+                }
+                else
+                {
+                    pointX = _mm256_i32gather_ps(neighborPoint, tableIndices, 4);
+                    pointY = _mm256_i32gather_ps(neighborPoint + 1, tableIndices, 4);
+                }
+            }
+            else
+            {
+                __m256i fhx = lowbias32(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(startCellX, cellDeltaX))));
+                __m256i hashX = _mm256_add_epi32(_mm256_mullo_epi32(fhx, _mm256_set1_epi32(27901)), _mm256_mullo_epi32(fhy, _mm256_set1_epi32(8537)));
+                __m256i hashY = _mm256_add_epi32(_mm256_mullo_epi32(fhx, _mm256_set1_epi32(6581)), _mm256_mullo_epi32(fhy, _mm256_set1_epi32(21881)));
+                pointX = _mm256_div_ps(_mm256_cvtepi32_ps(lowbias32(hashX)), hashRange);
+                pointY = _mm256_div_ps(_mm256_cvtepi32_ps(lowbias32(hashY)), hashRange);
+            }
+
+            __m256 deltaX = _mm256_sub_ps(fx, _mm256_add_ps(pointX, cellDeltaX));
+            __m256 deltaY = _mm256_sub_ps(fy, _mm256_add_ps(pointY, cellDeltaY));
+            __m256 dist2 = _mm256_add_ps(_mm256_mul_ps(deltaX, deltaX), _mm256_mul_ps(deltaY, deltaY));
+
+            // Branchless version of the insertion chain. The components
+            // are kept sorted, so each comparison implies the next ones.
+            if(ComponentCount == 1)
+            {
+                r0 = _mm256_min_ps(dist2, r0);
+                continue;
+            }
+
+            __m256 less0 = _mm256_cmp_ps(dist2, r0, _CMP_LT_OQ);
+            __m256 less1 = _mm256_cmp_ps(dist2, r1, _CMP_LT_OQ);
+            if(ComponentCount > 3)
+                r3 = _mm256_blendv_ps(_mm256_blendv_ps(r3, dist2, _mm256_cmp_ps(dist2, r3, _CMP_LT_OQ)), r2, _mm256_cmp_ps(dist2, r2, _CMP_LT_OQ));
+            if(ComponentCount > 2)
+                r2 = _mm256_blendv_ps(_mm256_blendv_ps(r2, dist2, _mm256_cmp_ps(dist2, r2, _CMP_LT_OQ)), r1, less1);
+            r1 = _mm256_blendv_ps(_mm256_blendv_ps(r1, dist2, less1), r0, less0);
+            r0 = _mm256_blendv_ps(r0, dist2, less0);
+        }
+    }
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    result[0] = _mm256_min_ps(_mm256_sqrt_ps(r0), one);
+    result[1] = ComponentCount > 1 ? _mm256_min_ps(_mm256_sqrt_ps(r1), one) : _mm256_setzero_ps();
+    result[2] = ComponentCount > 2 ? _mm256_min_ps(_mm256_sqrt_ps(r2), one) : _mm256_setzero_ps();
+    result[3] = ComponentCount > 3 ? _mm256_min_ps(_mm256_sqrt_ps(r3), one) : _mm256_setzero_ps();
+}
+
+static inline __m256i encodeUnorm8(__m256 value)
+{
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+// The noise value before the thresholds are applied.
+template<int ComponentCount>
+static inline __m256 evaluateNoiseValue(const VoronoiNoiseKernelParameters &parameters, __m256i pixelX, __m256 viewPositionY)
+{
+    __m256 screenCoordX = _mm256_div_ps(_mm256_add_ps(_mm256_cvtepi32_ps(pixelX), _mm256_set1_ps(0.5f)), _mm256_set1_ps(parameters.screenWidth));
+    __m256 noiseCoordinateX = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(screenCoordX, _mm256_set1_ps(0.5f)), _mm256_set1_ps(parameters.screenScale)), _mm256_set1_ps(parameters.screenOffsetX));
+    __m256 noiseCoordinateY = viewPositionY;
+    __m256 noiseGain = _mm256_set1_ps(1.0f);
+    __m256 totalGain = _mm256_setzero_ps();
+    __m256 lacunarity = _mm256_set1_ps(parameters.lacunarity);
+
+    __m256 noiseComponents[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+    for(int32_t octave = 0; octave < parameters.octaves; ++octave)
+    {
+        __m256 components[4];
+        auto tableOctave = getVoronoiNoiseCellTableOctave(parameters, octave);
+        voronoiNoiseComponents8<ComponentCount> (noiseCoordinateX, noiseCoordinateY, components, tableOctave, parameters.cellTablePoints);
+        for(int c = 0; c < ComponentCount; ++c)
+            noiseComponents[c] = _mm256_add_ps(noiseComponents[c], _mm256_mul_ps(components[c], noiseGain));
+        totalGain = _mm256_add_ps(totalGain, noiseGain);
+
+        noiseCoordinateX = _mm256_mul_ps(noiseCoordinateX, lacunarity);
+        noiseCoordinateY = _mm256_mul_ps(noiseCoordinateY, lacunarity);
+        noiseGain = _mm256_div_ps(noiseGain, lacunarity);
+    }
+
+    __m256 normalization = _mm256_div_ps(_mm256_set1_ps(parameters.amplitude), totalGain);
+    __m256 noiseValue = _mm256_mul_ps(_mm256_mul_ps(noiseComponents[0], normalization), _mm256_set1_ps(parameters.factors[0]));
+    for(int c = 1; c < ComponentCount; ++c)
+        noiseValue = _mm256_add_ps(noiseValue, _mm256_mul_ps(_mm256_mul_ps(noiseComponents[c], normalization), _mm256_set1_ps(parameters.factors[c])));
+    return noiseValue;
+}
+
+template<int ComponentCount>
+static inline __m256i renderPixels(const VoronoiNoiseKernelParameters &parameters, __m256i pixelX, __m256 viewPositionY)
+{
+    __m256 noiseValue = evaluateNoiseValue<ComponentCount> (parameters, pixelX, viewPositionY);
+    noiseValue = _mm256_div_ps(_mm256_sub_ps(noiseValue, _mm256_set1_ps(parameters.thresholdLow)), _mm256_set1_ps(parameters.thresholdRange));
+    noiseValue = _mm256_min_ps(_mm256_max_ps(noiseValue, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    __m256 inverseNoiseValue = _mm256_sub_ps(_mm256_set1_ps(1.0f), noiseValue);
+
+    __m256i encoded[4];
+    for(int c = 0; c < 4; ++c)
+    {
+        __m256 color = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(parameters.startColor[c]), inverseNoiseValue), _mm256_mul_ps(_mm256_set1_ps(parameters.endColor[c]), noiseValue));
+        encoded[c] = encodeUnorm8(color);
+    }
+
+    // B8G8R8A8
+    return _mm256_or_si256(
+        _mm256_or_si256(encoded[2], _mm256_slli_epi32(encoded[1], 8)),
+        _mm256_or_si256(_mm256_slli_epi32(encoded[0], 16), _mm256_slli_epi32(encoded[3], 24)));
+}
+
+static inline float computeViewPositionY(const VoronoiNoiseKernelParameters &parameters, uint32_t y)
+{
+    float screenCoordY = (float(int32_t(y)) + 0.5f) / parameters.screenHeight;
+    if(!parameters.flipVertically)
+        screenCoordY = -screenCoordY;
+    return (screenCoordY - 0.5f)*parameters.screenScale*parameters.screenAspect - parameters.screenOffsetY;
+}
+
+template<int ComponentCount>
+static void renderVoronoiNoiseRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    __m256 viewPositionY = _mm256_set1_ps(computeViewPositionY(parameters, y));
+
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for(uint32_t i = 0; i < count; i += VoronoiNoiseLaneGroupSize)
+    {
+        __m256i pixelX = _mm256_add_epi32(_mm256_set1_epi32(int32_t(x + i)), laneOffsets);
+        __m256i pixels = renderPixels<ComponentCount> (parameters, pixelX, viewPositionY);
+
+        uint32_t remaining = count - i;
+        if(remaining >= VoronoiNoiseLaneGroupSize)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*> (destination + i), pixels);
+        }
+        else
+        {
+            alignas(32) uint32_t laneGroup[VoronoiNoiseLaneGroupSize];
+            _mm256_store_si256(reinterpret_cast<__m256i*> (laneGroup), pixels);
+            memcpy(destination + i, laneGroup, remaining*sizeof(uint32_t));
+        }
+    }
+
+    // Avoid the AVX to SSE transition penalty in the caller.
+    _mm256_zeroupper();
+}
+
+void renderVoronoiNoiseRowAVX2(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: renderVoronoiNoiseRow<1> (parameters, x, y, count, destination); break;
+    case 2: renderVoronoiNoiseRow<2> (parameters, x, y, count, destination); break;
+    case 3: renderVoronoiNoiseRow<3> (parameters, x, y, count, destination); break;
+    default: renderVoronoiNoiseRow<4> (parameters, x, y, count, destination); break;
+    }
+}
+
+template<int ComponentCount>
+static void evaluateVoronoiNoiseValueRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    __m256 viewPositionY = _mm256_set1_ps(computeViewPositionY(parameters, y));
+
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for(uint32_t i = 0; i < count; i += VoronoiNoiseLaneGroupSize)
+    {
+        __m256i pixelX = _mm256_add_epi32(_mm256_set1_epi32(int32_t(x + i)), laneOffsets);
+        __m256 values = evaluateNoiseValue<ComponentCount> (parameters, pixelX, viewPositionY);
+
+        uint32_t remaining = count - i;
+        if(remaining >= VoronoiNoiseLaneGroupSize)
+        {
+            _mm256_storeu_ps(destination + i, values);
+        }
+        else
+        {
+            alignas(32) float laneGroup[VoronoiNoiseLaneGroupSize];
+            _mm256_store_ps(laneGroup, values);
+            memcpy(destination + i, laneGroup, remaining*sizeof(float));
+        }
+    }
+
+    // Avoid the AVX to SSE transition penalty in the caller.
+    _mm256_zeroupper();
+}
+
+void evaluateVoronoiNoiseValueRowAVX2(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: evaluateVoronoiNoiseValueRow<1> (parameters, x, y, count, destination); break;
+    case 2: evaluateVoronoiNoiseValueRow<2> (parameters, x, y, count, destination); break;
+    case 3: evaluateVoronoiNoiseValueRow<3> (parameters, x, y, count, destination); break;
+    default: evaluateVoronoiNoiseValueRow<4> (parameters, x, y, count, destination); break;
+    }
+}
@@ -0,0 +1,275 @@
+#include "VoronoiNoiseCPU.hpp"
+#include "VoronoiNoiseCPUKernels.hpp"
+#include <smmintrin.h>
+#include <string.h>
+
+// This translation unit is compiled with SSE4.1 code generation enabled.
+// A lane group of 8 pixels is processed as two 4 wide vectors.
+
+static inline __m128i lowbias32(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 16));
+    x = _mm_mullo_epi32(x, _mm_set1_epi32(0x7feb352d));
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 15));
+    x = _mm_mullo_epi32(x, _mm_set1_epi32(int32_t(0x846ca68bu)));
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 16));
+    return x;
+}
+
+// Only the ComponentCount nearest distances are tracked, and the other ones are
+// zero. The feature points are fetched from the cell table when it has the
+// neighbor cells of every lane, and hashed otherwise.
+template<int ComponentCount>
+static inline void voronoiNoiseComponents4(__m128 x, __m128 y, __m128 result[4],
+    const VoronoiNoiseCellTableOctave *tableOctave = nullptr, const float *tablePoints = nullptr)
+{
+    const __m128 hashRange = _mm_set1_ps(4294967295.0f);
+    __m128 r0 = _mm_set1_ps(1.0e10f);
+    __m128 r1 = r0;
+    __m128 r2 = r0;
+    __m128 r3 = r0;
+
+    __m128 startCellX = _mm_floor_ps(x);
+    __m128 startCellY = _mm_floor_ps(y);
+    __m128 fx = _mm_sub_ps(x, startCellX);
+    __m128 fy = _mm_sub_ps(y, startCellY);
+
+    // The table indices of the cells of the lanes are relative to the cell of
+    // the first lane, so that the points are broadcast when they are all zero.
+    // There is no gather instruction, so the other lanes are loaded one by one.
+    const float *tableCell = nullptr;
+    int32_t tableWidth = 0;
+    int32_t tableIndices[4] = {};
+    bool isSameTableCell = false;
+    if(tableOctave)
+    {
+        __m128 isInTable = _mm_and_ps(
+            _mm_and_ps(_mm_cmpge_ps(startCellX, _mm_set1_ps(float(tableOctave->originX + 1))),
+                _mm_cmplt_ps(startCellX, _mm_set1_ps(float(tableOctave->originX + int32_t(tableOctave->width) - 1)))),
+            _mm_and_ps(_mm_cmpge_ps(startCellY, _mm_set1_ps(float(tableOctave->originY + 1))),
+                _mm_cmplt_ps(startCellY, _mm_set1_ps(float(tableOctave->originY + int32_t(tableOctave->height) - 1)))));
+        if(_mm_movemask_ps(isInTable) == 0xF)
+        {
+            tableWidth = int32_t(tableOctave->width);
+            __m128i cellIndices = _mm_add_epi32(
+                _mm_mullo_epi32(_mm_sub_epi32(_mm_cvttps_epi32(startCellY), _mm_set1_epi32(tableOctave->originY)), _mm_set1_epi32(tableWidth)),
+                _mm_sub_epi32(_mm_cvttps_epi32(startCellX), _mm_set1_epi32(tableOctave->originX)));
+            int32_t firstCellIndex = _mm_cvtsi128_si32(cellIndices);
+            tableCell = tablePoints + (size_t(tableOctave->offset) + size_t(firstCellIndex))*2;
+            __m128i relativeIndices = _mm_slli_epi32(_mm_sub_epi32(cellIndices, _mm_set1_epi32(firstCellIndex)), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*> (tableIndices), relativeIndices);
+            isSameTableCell = _mm_testz_si128(relativeIndices, relativeIndices) != 0;
+        }
+    }
+
+    for(int cy = -1; cy <= 1; ++cy)
+    {
+        __m128 cellDeltaY = _mm_set1_ps(float(cy));
+        __m128i fhy = _mm_setzero_si128();
+        if(!tableCell)
+            fhy = lowbias32(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(startCellY, cellDeltaY))));
+        for(int cx = -1; cx <= 1; ++cx)
+        {
+            __m128 cellDeltaX = _mm_set1_ps(float(cx));
+            __m128 pointX;
+            __m128 pointY;
+            if(tableCell)
+            {
+                auto neighborPoint = tableCell + ptrdiff_t(cy*tableWidth + cx)*2;
+                if(isSameTableCell)
+                {
+                    pointX = _mm_set1_ps(neighborPoint[0]);
+                    pointY = _mm_set1_ps(neighborPoint[1]);
+                }
+                else
+                {
+                    pointX = _mm_setr_ps(neighborPoint[tableIndices[0]], neighborPoint[tableIndices[1]], neighborPoint[tableIndices[2]], neighborPoint[tableIndices[3]]);
+                    pointY = _mm_setr_ps(neighborPoint[tableIndices[0] + 1], neighborPoint[tableIndices[1] + 1], neighborPoint[tableIndices[2] + 1], neighborPoint[tableIndices[3] + 1]);
+                }
+            }
+            else
+            {
+                __m128i fhx = lowbias32(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(startCellX, cellDeltaX))));
+                __m128i hashX = _mm_add_epi32(_mm_mullo_epi32(fhx, _mm_set1_epi32(27901)), _mm_mullo_epi32(fhy, _mm_set1_epi32(8537)));
+                __m128i hashY = _mm_add_epi32(_mm_mullo_epi32(fhx, _mm_set1_epi32(6581)), _mm_mullo_epi32(fhy, _mm_set1_epi32(21881)));
+                pointX = _mm_div_ps(_mm_cvtepi32_ps(lowbias32(hashX)), hashRange);
+                pointY = _mm_div_ps(_mm_cvtepi32_ps(lowbias32(hashY)), hashRange);
+            }
+
+            __m128 deltaX = _mm_sub_ps(fx, _mm_add_ps(pointX, cellDeltaX));
+            __m128 deltaY = _mm_sub_ps(fy, _mm_add_ps(pointY, cellDeltaY));
+            __m128 dist2 = _mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY));
+
+            // Branchless version of the insertion chain. The components
+            // are kept sorted, so each comparison implies the next ones.
+            if(ComponentCount == 1)
+            {
+                r0 = _mm_min_ps(dist2, r0);
+                continue;
+            }
+
+            __m128 less0 = _mm_cmplt_ps(dist2, r0);
+            __m128 less1 = _mm_cmplt_ps(dist2, r1);
+            if(ComponentCount > 3)
+                r3 = _mm_blendv_ps(_mm_blendv_ps(r3, dist2, _mm_cmplt_ps(dist2, r3)), r2, _mm_cmplt_ps(dist2, r2));
+            if(ComponentCount > 2)
+                r2 = _mm_blendv_ps(_mm_blendv_ps(r2, dist2, _mm_cmplt_ps(dist2, r2)), r1, less1);
+            r1 = _mm_blendv_ps(_mm_blendv_ps(r1, dist2, less1), r0, less0);
+            r0 = _mm_blendv_ps(r0, dist2, less0);
+        }
+    }
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    result[0] = _mm_min_ps(_mm_sqrt_ps(r0), one);
+    result[1] = ComponentCount > 1 ? _mm_min_ps(_mm_sqrt_ps(r1), one) : _mm_setzero_ps();
+    result[2] = ComponentCount > 2 ? _mm_min_ps(_mm_sqrt_ps(r2), one) : _mm_setzero_ps();
+    result[3] = ComponentCount > 3 ? _mm_min_ps(_mm_sqrt_ps(r3), one) : _mm_setzero_ps();
+}
+
+static inline __m128i encodeUnorm8(__m128 value)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+// The noise value before the thresholds are applied.
+template<int ComponentCount>
+static inline __m128 evaluateNoiseValue(const VoronoiNoiseKernelParameters &parameters, __m128i pixelX, __m128 viewPositionY)
+{
+    __m128 screenCoordX = _mm_div_ps(_mm_add_ps(_mm_cvtepi32_ps(pixelX), _mm_set1_ps(0.5f)), _mm_set1_ps(parameters.screenWidth));
+    __m128 noiseCoordinateX = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(screenCoordX, _mm_set1_ps(0.5f)), _mm_set1_ps(parameters.screenScale)), _mm_set1_ps(parameters.screenOffsetX));
+    __m128 noiseCoordinateY = viewPositionY;
+    __m128 noiseGain = _mm_set1_ps(1.0f);
+    __m128 totalGain = _mm_setzero_ps();
+    __m128 lacunarity = _mm_set1_ps(parameters.lacunarity);
+
+    __m128 noiseComponents[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+    for(int32_t octave = 0; octave < parameters.octaves; ++octave)
+    {
+        __m128 components[4];
+        auto tableOctave = getVoronoiNoiseCellTableOctave(parameters, octave);
+        voronoiNoiseComponents4<ComponentCount> (noiseCoordinateX, noiseCoordinateY, components, tableOctave, parameters.cellTablePoints);
+        for(int c = 0; c < ComponentCount; ++c)
+            noiseComponents[c] = _mm_add_ps(noiseComponents[c], _mm_mul_ps(components[c], noiseGain));
+        totalGain = _mm_add_ps(totalGain, noiseGain);
+
+        noiseCoordinateX = _mm_mul_ps(noiseCoordinateX, lacunarity);
+        noiseCoordinateY = _mm_mul_ps(noiseCoordinateY, lacunarity);
+        noiseGain = _mm_div_ps(noiseGain, lacunarity);
+    }
+
+    __m128 normalization = _mm_div_ps(_mm_set1_ps(parameters.amplitude), totalGain);
+    __m128 noiseValue = _mm_mul_ps(_mm_mul_ps(noiseComponents[0], normalization), _mm_set1_ps(parameters.factors[0]));
+    for(int c = 1; c < ComponentCount; ++c)
+        noiseValue = _mm_add_ps(noiseValue, _mm_mul_ps(_mm_mul_ps(noiseComponents[c], normalization), _mm_set1_ps(parameters.factors[c])));
+    return noiseValue;
+}
+
+template<int ComponentCount>
+static inline __m128i renderPixels(const VoronoiNoiseKernelParameters &parameters, __m128i pixelX, __m128 viewPositionY)
+{
+    __m128 noiseValue = evaluateNoiseValue<ComponentCount> (parameters, pixelX, viewPositionY);
+    noiseValue = _mm_div_ps(_mm_sub_ps(noiseValue, _mm_set1_ps(parameters.thresholdLow)), _mm_set1_ps(parameters.thresholdRange));
+    noiseValue = _mm_min_ps(_mm_max_ps(noiseValue, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    __m128 inverseNoiseValue = _mm_sub_ps(_mm_set1_ps(1.0f), noiseValue);
+
+    __m128i encoded[4];
+    for(int c = 0; c < 4; ++c)
+    {
+        __m128 color = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(parameters.startColor[c]), inverseNoiseValue), _mm_mul_ps(_mm_set1_ps(parameters.endColor[c]), noiseValue));
+        encoded[c] = encodeUnorm8(color);
+    }
+
+    // B8G8R8A8
+    return _mm_or_si128(
+        _mm_or_si128(encoded[2], _mm_slli_epi32(encoded[1], 8)),
+        _mm_or_si128(_mm_slli_epi32(encoded[0], 16), _mm_slli_epi32(encoded[3], 24)));
+}
+
+static inline float computeViewPositionY(const VoronoiNoiseKernelParameters &parameters, uint32_t y)
+{
+    float screenCoordY = (float(int32_t(y)) + 0.5f) / parameters.screenHeight;
+    if(!parameters.flipVertically)
+        screenCoordY = -screenCoordY;
+    return (screenCoordY - 0.5f)*parameters.screenScale*parameters.screenAspect - parameters.screenOffsetY;
+}
+
+template<int ComponentCount>
+static void renderVoronoiNoiseRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    __m128 viewPositionY = _mm_set1_ps(computeViewPositionY(parameters, y));
+
+    const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+    for(uint32_t i = 0; i < count; i += VoronoiNoiseLaneGroupSize)
+    {
+        __m128i firstPixelX = _mm_add_epi32(_mm_set1_epi32(int32_t(x + i)), laneOffsets);
+        __m128i secondPixelX = _mm_add_epi32(firstPixelX, _mm_set1_epi32(4));
+        __m128i first = renderPixels<ComponentCount> (parameters, firstPixelX, viewPositionY);
+        __m128i second = renderPixels<ComponentCount> (parameters, secondPixelX, viewPositionY);
+
+        uint32_t remaining = count - i;
+        if(remaining >= VoronoiNoiseLaneGroupSize)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*> (destination + i), first);
+            _mm_storeu_si128(reinterpret_cast<__m128i*> (destination + i + 4), second);
+        }
+        else
+        {
+            alignas(16) uint32_t laneGroup[VoronoiNoiseLaneGroupSize];
+            _mm_store_si128(reinterpret_cast<__m128i*> (laneGroup), first);
+            _mm_store_si128(reinterpret_cast<__m128i*> (laneGroup + 4), second);
+            memcpy(destination + i, laneGroup, remaining*sizeof(uint32_t));
+        }
+    }
+}
+
+void renderVoronoiNoiseRowSSE4(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, uint32_t *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: renderVoronoiNoiseRow<1> (parameters, x, y, count, destination); break;
+    case 2: renderVoronoiNoiseRow<2> (parameters, x, y, count, destination); break;
+    case 3: renderVoronoiNoiseRow<3> (parameters, x, y, count, destination); break;
+    default: renderVoronoiNoiseRow<4> (parameters, x, y, count, destination); break;
+    }
+}
+
+template<int ComponentCount>
+static void evaluateVoronoiNoiseValueRow(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    __m128 viewPositionY = _mm_set1_ps(computeViewPositionY(parameters, y));
+
+    const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+    for(uint32_t i = 0; i < count; i += VoronoiNoiseLaneGroupSize)
+    {
+        __m128i firstPixelX = _mm_add_epi32(_mm_set1_epi32(int32_t(x + i)), laneOffsets);
+        __m128i secondPixelX = _mm_add_epi32(firstPixelX, _mm_set1_epi32(4));
+        __m128 first = evaluateNoiseValue<ComponentCount> (parameters, firstPixelX, viewPositionY);
+        __m128 second = evaluateNoiseValue<ComponentCount> (parameters, secondPixelX, viewPositionY);
+
+        uint32_t remaining = count - i;
+        if(remaining >= VoronoiNoiseLaneGroupSize)
+        {
+            _mm_storeu_ps(destination + i, first);
+            _mm_storeu_ps(destination + i + 4, second);
+        }
+        else
+        {
+            alignas(16) float laneGroup[VoronoiNoiseLaneGroupSize];
+            _mm_store_ps(laneGroup, first);
+            _mm_store_ps(laneGroup + 4, second);
+            memcpy(destination + i, laneGroup, remaining*sizeof(float));
+        }
+    }
+}
+
+void evaluateVoronoiNoiseValueRowSSE4(const VoronoiNoiseKernelParameters &parameters, uint32_t x, uint32_t y, uint32_t count, float *destination)
+{
+    switch(parameters.componentCount)
+    {
+    case 1: evaluateVoronoiNoiseValueRow<1> (parameters, x, y, count, destination); break;
+    case 2: evaluateVoronoiNoiseValueRow<2> (parameters, x, y, count, destination); break;
+    case 3: evaluateVoronoiNoiseValueRow<3> (parameters, x, y, count, destination); break;
+    default: evaluateVoronoiNoiseValueRow<4> (parameters, x, y, count, destination); break;
+    }
+}
@@ -0,0 +1,74 @@
+#include "VoronoiNoiseCellTable.hpp"
+#include "VoronoiNoiseCPU.hpp"
+#include <math.h>
+#include <algorithm>
+
+// Beyond this distance from the origin, the rounding of the scaled noise
+// coordinates could exceed the margin of the table.
+static constexpr double MaxCellTableCoordinate = double(1 << 20);
+
+// A cell for the neighbors of the pixels, and another one for the rounding.
+static constexpr int32_t CellTableMargin = 2;
+
+void layoutVoronoiNoiseCellTable(const ScreenAndUIState &state, VoronoiNoiseCellTableHeader &header, uint32_t maxPointCount)
+{
+    header = VoronoiNoiseCellTableHeader{};
+    auto octaves = std::min(int(state.octaves), int(VoronoiNoiseCellTableMaxOctaves));
+    if(octaves <= 0 || state.screenWidth == 0 || state.screenHeight == 0)
+        return;
+
+    // The view of the screen coordinates from 0 to 1, which are negated
+    // vertically when the rows are not flipped, as in computeViewPositionY.
+    double aspect = double(state.screenHeight) / double(state.screenWidth);
+    double screenCoordY0 = state.flipVertically ? 0.0 : -1.0;
+    double viewX[2] = {-0.5*state.screenScale - state.screenOffsetX, 0.5*state.screenScale - state.screenOffsetX};
+    double viewY[2] = {(screenCoordY0 - 0.5)*state.screenScale*aspect - state.screenOffsetY, (screenCoordY0 + 0.5)*state.screenScale*aspect - state.screenOffsetY};
+
+    header.octaveCount = uint32_t(octaves);
+    double scale = 1.0;
+    for(int octave = 0; octave < octaves; ++octave, scale *= state.lacunarity)
+    {
+        auto minX = std::min(viewX[0]*scale, viewX[1]*scale);
+        auto maxX = std::max(viewX[0]*scale, viewX[1]*scale);
+        auto minY = std::min(viewY[0]*scale, viewY[1]*scale);
+        auto maxY = std::max(viewY[0]*scale, viewY[1]*scale);
+        if(!(minX > -MaxCellTableCoordinate && maxX < MaxCellTableCoordinate && minY > -MaxCellTableCoordinate && maxY < MaxCellTableCoordinate))
+            continue;
+
+        auto originX = int32_t(floor(minX)) - CellTableMargin;
+        auto originY = int32_t(floor(minY)) - CellTableMargin;
+        auto width = uint32_t(int32_t(floor(maxX)) + CellTableMargin - originX + 1);
+        auto height = uint32_t(int32_t(floor(maxY)) + CellTableMargin - originY + 1);
+        if(uint64_t(width)*height > uint64_t(maxPointCount - header.pointCount))
+            continue;
+
+        auto &tableOctave = header.octaves[octave];
+        tableOctave.originX = originX;
+        tableOctave.originY = originY;
+        tableOctave.width = width;
+        tableOctave.height = height;
+        tableOctave.offset = header.pointCount;
+        header.pointCount += width*height;
+    }
+}
+
+void fillVoronoiNoiseCellTable(const VoronoiNoiseCellTableHeader &header, float *points)
+{
+    for(uint32_t octave = 0; octave < header.octaveCount; ++octave)
+    {
+        auto &tableOctave = header.octaves[octave];
+        auto destination = points + size_t(tableOctave.offset)*2;
+        for(uint32_t y = 0; y < tableOctave.height; ++y)
+        {
+            for(uint32_t x = 0; x < tableOctave.width; ++x, destination += 2)
+                voronoiRandomNoiseVector2(float(tableOctave.originX + int32_t(x)), float(tableOctave.originY + int32_t(y)), destination);
+        }
+    }
+}
+
+void VoronoiNoiseCellTable::build(const ScreenAndUIState &state, uint32_t maxPointCount)
+{
+    layoutVoronoiNoiseCellTable(state, header, maxPointCount);
+    points.resize(size_t(header.pointCount)*2);
+    fillVoronoiNoiseCellTable(header, points.data());
+}
@@ -0,0 +1,68 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_CELL_TABLE_HPP
+#define SHADER_VIS_VORONOI_NOISE_CELL_TABLE_HPP
+
+#include "ScreenAndUIState.hpp"
+#include <stdint.h>
+#include <vector>
+
+static constexpr uint32_t VoronoiNoiseCellTableMaxOctaves = 16;
+
+// 256K feature points, which are 2 MB.
+static constexpr uint32_t VoronoiNoiseCellTableDefaultMaxPointCount = 1 << 18;
+
+/**
+ * The rectangle of cells of an octave that is in the cell table, with the
+ * offset of its first feature point. The octaves without cells are hashed.
+ * The layout must match the std430 CellTableOctave struct of voronoiNoise.glsl
+ * and voronoiNoiseCellTable.glsl.
+ */
+struct VoronoiNoiseCellTableOctave
+{
+    int32_t originX;
+    int32_t originY;
+    uint32_t width;
+    uint32_t height;
+    uint32_t offset;
+    uint32_t reserved[3];
+};
+
+/**
+ * The start of the cell table, which is followed by the feature points of
+ * the cells of each octave, as xy pairs in row major order.
+ */
+struct VoronoiNoiseCellTableHeader
+{
+    uint32_t octaveCount;
+    uint32_t pointCount;
+    uint32_t reserved[2];
+    VoronoiNoiseCellTableOctave octaves[VoronoiNoiseCellTableMaxOctaves];
+};
+static_assert(sizeof(VoronoiNoiseCellTableOctave) == 32 && sizeof(VoronoiNoiseCellTableHeader) == 16 + 32*VoronoiNoiseCellTableMaxOctaves,
+    "The cell table must match its shader layout");
+
+/**
+ * Lays out the cells that the view of the state touches in each octave, with
+ * a margin for the neighbor cells of the pixels and for the rounding of the
+ * noise coordinates. The octaves are added in order while their cells fit in
+ * maxPointCount, and the ones that do not fit, or that are too far from the
+ * origin for the cells to be exact in single precision, are left empty.
+ */
+void layoutVoronoiNoiseCellTable(const ScreenAndUIState &state, VoronoiNoiseCellTableHeader &header,
+    uint32_t maxPointCount = VoronoiNoiseCellTableDefaultMaxPointCount);
+
+// Hashes the feature points of the cells of the header, as voronoiNoiseCellTable.glsl does on the GPU.
+void fillVoronoiNoiseCellTable(const VoronoiNoiseCellTableHeader &header, float *points);
+
+/**
+ * A cell table for the CPU evaluator. Fetching the feature points from it
+ * gives the same pixels as hashing them.
+ */
+struct VoronoiNoiseCellTable
+{
+    VoronoiNoiseCellTableHeader header = {};
+    std::vector<float> points;
+
+    void build(const ScreenAndUIState &state, uint32_t maxPointCount = VoronoiNoiseCellTableDefaultMaxPointCount);
+};
+
+#endif //SHADER_VIS_VORONOI_NOISE_CELL_TABLE_HPP
@@ -0,0 +1,397 @@
+#include "VoronoiNoiseQuery.hpp"
+#include "VoronoiNoiseQueryKernels.hpp"
+#include <math.h>
+#include <algorithm>
+
+// The points of a cell are only evaluated together when there are enough of
+// them to pay for hashing the features of the cell once more.
+static constexpr size_t MinSharedCellPointCount = 4;
+
+static constexpr size_t CellBucketCount = 1 << 16;
+
+// The sort is skipped when the cells hold fewer points than this on average,
+// because most of them would be evaluated with a lane per point anyway. The
+// density is estimated from a sample of the points.
+static constexpr size_t MinSortedPointsPerCell = 16;
+static constexpr size_t DensitySampleCount = 4096;
+
+// This follows the SSE min semantics, as in VoronoiNoiseCPU.cpp.
+static inline float minFloat(float a, float b)
+{
+    return a < b ? a : b;
+}
+
+template<int Dimensions>
+void computeVoronoiNoiseCellFeatures(const VoronoiNoiseQueryBatch &batch, VoronoiNoiseCellFeature *features)
+{
+    auto index = batch.getPointIndex(0);
+    const float *coordinates[3] = {batch.points->x, batch.points->y, batch.points->z};
+    float startCell[3] = {};
+    for(int d = 0; d < Dimensions; ++d)
+        startCell[d] = floorf(coordinates[d][index]);
+
+    auto feature = features;
+    const int range = Dimensions == 3 ? 1 : 0;
+    for(int cz = -range; cz <= range; ++cz)
+    {
+        for(int cy = -1; cy <= 1; ++cy)
+        {
+            for(int cx = -1; cx <= 1; ++cx, ++feature)
+            {
+                float cellDelta[3] = {float(cx), float(cy), float(cz)};
+                int32_t cellHashes[3] = {};
+                for(int d = 0; d < Dimensions; ++d)
+                    cellHashes[d] = voronoiLowbias32(int32_t(floorf(startCell[d] + cellDelta[d])));
+
+                feature->offset[2] = 0.0f;
+                for(int c = 0; c < Dimensions; ++c)
+                {
+                    uint32_t hash = 0;
+                    for(int d = 0; d < Dimensions; ++d)
+                        hash += uint32_t(cellHashes[d])*uint32_t(VoronoiNoiseCellHashMultipliers[c][d]);
+
+                    auto hashed = voronoiLowbias32(int32_t(hash));
+                    feature->offset[c] = float(hashed) / 4294967295.0f + cellDelta[c];
+                    if(c == 0)
+                        feature->cellId = uint32_t(hashed);
+                }
+            }
+        }
+    }
+}
+
+template void computeVoronoiNoiseCellFeatures<2> (const VoronoiNoiseQueryBatch &batch, VoronoiNoiseCellFeature *features);
+template void computeVoronoiNoiseCellFeatures<3> (const VoronoiNoiseQueryBatch &batch, VoronoiNoiseCellFeature *features);
+
+template<int Dimensions>
+static void evaluatePointScalar(const VoronoiNoiseQueryBatch &batch, size_t index, const VoronoiNoiseCellFeature *features)
+{
+    constexpr int CellCount = Dimensions == 3 ? 27 : 9;
+    const float *coordinates[3] = {batch.points->x, batch.points->y, batch.points->z};
+    float f[3] = {};
+    for(int d = 0; d < Dimensions; ++d)
+        f[d] = coordinates[d][index] - floorf(coordinates[d][index]);
+
+    float r[4] = {1.0e10f, 1.0e10f, 1.0e10f, 1.0e10f};
+    uint32_t nearestCellId = 0;
+    for(int cell = 0; cell < CellCount; ++cell)
+    {
+        auto &feature = features[cell];
+        float deltaX = f[0] - feature.offset[0];
+        float deltaY = f[1] - feature.offset[1];
+        float dist2 = deltaX*deltaX + deltaY*deltaY;
+        if(Dimensions == 3)
+        {
+            float deltaZ = f[2] - feature.offset[2];
+            dist2 += deltaZ*deltaZ;
+        }
+
+        if(dist2 < r[0])
+        {
+            r[3] = r[2];
+            r[2] = r[1];
+            r[1] = r[0];
+            r[0] = dist2;
+            nearestCellId = feature.cellId;
+        }
+        else if(dist2 < r[1])
+        {
+            r[3] = r[2];
+            r[2] = r[1];
+            r[1] = dist2;
+        }
+        else if(dist2 < r[2])
+        {
+            r[3] = r[2];
+            r[2] = dist2;
+        }
+        else if(dist2 < r[3])
+        {
+            r[3] = dist2;
+        }
+    }
+
+    auto &results = *batch.results;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(results.distances[i])
+            results.distances[i][index] = minFloat(sqrtf(r[i]), 1.0f);
+    }
+    if(results.cellIds)
+        results.cellIds[index] = nearestCellId;
+}
+
+template<int Dimensions>
+static void queryPointsScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    VoronoiNoiseCellFeature features[27];
+    for(size_t i = 0; i < batch.count; ++i)
+    {
+        auto index = batch.getPointIndex(i);
+        VoronoiNoiseQueryBatch pointBatch = {batch.points, batch.results, nullptr, index, 1};
+        computeVoronoiNoiseCellFeatures<Dimensions> (pointBatch, features);
+        evaluatePointScalar<Dimensions> (batch, index, features);
+    }
+}
+
+template<int Dimensions>
+static void queryCellScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    VoronoiNoiseCellFeature features[27];
+    computeVoronoiNoiseCellFeatures<Dimensions> (batch, features);
+    for(size_t i = 0; i < batch.count; ++i)
+        evaluatePointScalar<Dimensions> (batch, batch.getPointIndex(i), features);
+}
+
+void queryVoronoiNoisePoints2DScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPointsScalar<2> (batch);
+}
+
+void queryVoronoiNoisePoints3DScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPointsScalar<3> (batch);
+}
+
+void queryVoronoiNoiseCell2DScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCellScalar<2> (batch);
+}
+
+void queryVoronoiNoiseCell3DScalar(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCellScalar<3> (batch);
+}
+
+// The floor is only used for hashing, so it does not need to be exact out of
+// the range of int32_t, and it avoids the floorf call of the base instruction set.
+// Converting NaN or a float out of that range is undefined, so such points are
+// put into the cell zero.
+static inline int32_t floorToInt(float x)
+{
+    if(!(fabsf(x) < 2147483648.0f))
+        return 0;
+
+    auto truncated = int32_t(x);
+    return float(truncated) > x ? truncated - 1 : truncated;
+}
+
+// The buckets wrap the cells around a grid, so that the nearby cells never
+// share a bucket and do not interleave their points.
+static inline uint32_t getCellBucket(const VoronoiNoisePoints &points, size_t index)
+{
+    auto cellX = uint32_t(floorToInt(points.x[index]));
+    auto cellY = uint32_t(floorToInt(points.y[index]));
+    if(!points.z)
+        return ((cellY & 255) << 8) | (cellX & 255);
+
+    auto cellZ = uint32_t(floorToInt(points.z[index]));
+    return ((cellZ & 31) << 11) | ((cellY & 31) << 6) | (cellX & 63);
+}
+
+/**
+ * The bounds of the cell of a point, which are compared with the next sorted
+ * points instead of their floor. A point lies in the cell exactly when its
+ * floor is the one of the cell, and NaN points are never in a cell.
+ */
+struct CellBounds
+{
+    float minimum[3];
+    float maximum[3];
+
+    CellBounds(const VoronoiNoisePoints &points, size_t index)
+    {
+        const float *coordinates[3] = {points.x, points.y, points.z};
+        for(int d = 0; d < 3; ++d)
+        {
+            minimum[d] = coordinates[d] ? floorf(coordinates[d][index]) : 0.0f;
+            maximum[d] = minimum[d] + 1.0f;
+        }
+    }
+
+    bool contains(const VoronoiNoisePoints &points, size_t index) const
+    {
+        if(!(points.x[index] >= minimum[0] && points.x[index] < maximum[0] && points.y[index] >= minimum[1] && points.y[index] < maximum[1]))
+            return false;
+        return !points.z || (points.z[index] >= minimum[2] && points.z[index] < maximum[2]);
+    }
+};
+
+/**
+ * Compares the number of distinct cells of an evenly spaced sample of the
+ * points with the number that is expected when the points are uniformly
+ * spread over the cells with MinSortedPointsPerCell points each. The cells
+ * are packed with 32 or 21 bits per axis, which only aliases very distant cells.
+ */
+static bool areDenseEnoughToSort(const VoronoiNoisePoints &points)
+{
+    auto sampleCount = std::min(points.count, DensitySampleCount);
+    std::vector<uint64_t> sampleCells(sampleCount);
+    for(size_t i = 0; i < sampleCount; ++i)
+    {
+        auto index = i*points.count / sampleCount;
+        auto cellX = uint64_t(uint32_t(floorToInt(points.x[index])));
+        auto cellY = uint64_t(uint32_t(floorToInt(points.y[index])));
+        if(points.z)
+        {
+            auto cellZ = uint64_t(uint32_t(floorToInt(points.z[index])));
+            sampleCells[i] = ((cellZ & 0x1fffff) << 42) | ((cellY & 0x1fffff) << 21) | (cellX & 0x1fffff);
+        }
+        else
+        {
+            sampleCells[i] = (cellY << 32) | cellX;
+        }
+    }
+
+    std::sort(sampleCells.begin(), sampleCells.end());
+    auto distinctCellCount = size_t(std::unique(sampleCells.begin(), sampleCells.end()) - sampleCells.begin());
+
+    auto cellCount = double(points.count) / double(MinSortedPointsPerCell);
+    auto expectedDistinctCellCount = cellCount*(1.0 - exp(-double(sampleCount) / cellCount));
+    return double(distinctCellCount) <= expectedDistinctCellCount;
+}
+
+VoronoiNoiseQuery::VoronoiNoiseQuery(WorkStealingThreadPool &threadPool, size_t batchSize)
+    : threadPool(threadPool), batchSize(std::max(batchSize, size_t(1)))
+{
+}
+
+void VoronoiNoiseQuery::sortByCell(const VoronoiNoisePoints &points, const VoronoiNoiseQueryResults &results)
+{
+    // The buckets are hashed in parallel, and counted in a single pass.
+    pointBuckets.resize(points.count);
+    auto batchCount = (points.count + batchSize - 1) / batchSize;
+    threadPool.parallelFor(batchCount, [&](size_t batchIndex) {
+        auto first = batchIndex*batchSize;
+        auto last = std::min(first + batchSize, points.count);
+        for(size_t i = first; i < last; ++i)
+            pointBuckets[i] = uint16_t(getCellBucket(points, i));
+    });
+
+    bucketOffsets.assign(CellBucketCount + 1, 0);
+    for(auto bucket : pointBuckets)
+        ++bucketOffsets[bucket + 1];
+    for(size_t i = 1; i <= CellBucketCount; ++i)
+        bucketOffsets[i] += bucketOffsets[i - 1];
+
+    // The coordinates are scattered to their sorted positions, so that the
+    // kernels read them sequentially.
+    const float *coordinates[3] = {points.x, points.y, points.z};
+    auto dimensions = points.z ? 3 : 2;
+    for(int d = 0; d < dimensions; ++d)
+        sortedCoordinates[d].resize(points.count);
+    sortedPositions.resize(points.count);
+    for(size_t i = 0; i < points.count; ++i)
+    {
+        auto position = bucketOffsets[pointBuckets[i]]++;
+        sortedPositions[i] = position;
+        for(int d = 0; d < dimensions; ++d)
+            sortedCoordinates[d][position] = coordinates[d][i];
+    }
+
+    sortedPoints.x = sortedCoordinates[0].data();
+    sortedPoints.y = sortedCoordinates[1].data();
+    sortedPoints.z = points.z ? sortedCoordinates[2].data() : nullptr;
+    sortedPoints.count = points.count;
+
+    // The kernels also write the results sequentially, and they are gathered
+    // back in the order of the points at the end.
+    sortedResults = VoronoiNoiseQueryResults{};
+    for(int i = 0; i < 4; ++i)
+    {
+        if(!results.distances[i])
+            continue;
+        sortedDistances[i].resize(points.count);
+        sortedResults.distances[i] = sortedDistances[i].data();
+    }
+    if(results.cellIds)
+    {
+        sortedCellIds.resize(points.count);
+        sortedResults.cellIds = sortedCellIds.data();
+    }
+}
+
+void VoronoiNoiseQuery::evaluate(const VoronoiNoisePoints &points, const VoronoiNoiseQueryResults &results)
+{
+    if(points.count == 0)
+        return;
+
+    auto level = simdLevel;
+    if(!isVoronoiNoiseSIMDLevelSupported(level))
+        level = getBestVoronoiNoiseSIMDLevel();
+
+    auto is3D = points.z != nullptr;
+    auto pointsFunction = is3D ? &queryVoronoiNoisePoints3DScalar : &queryVoronoiNoisePoints2DScalar;
+    auto cellFunction = is3D ? &queryVoronoiNoiseCell3DScalar : &queryVoronoiNoiseCell2DScalar;
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD)
+    if(level == VoronoiNoiseSIMDLevel::AVX2)
+    {
+        pointsFunction = is3D ? &queryVoronoiNoisePoints3DAVX2 : &queryVoronoiNoisePoints2DAVX2;
+        cellFunction = is3D ? &queryVoronoiNoiseCell3DAVX2 : &queryVoronoiNoiseCell2DAVX2;
+    }
+    else if(level == VoronoiNoiseSIMDLevel::SSE4)
+    {
+        pointsFunction = is3D ? &queryVoronoiNoisePoints3DSSE4 : &queryVoronoiNoisePoints2DSSE4;
+        cellFunction = is3D ? &queryVoronoiNoiseCell3DSSE4 : &queryVoronoiNoiseCell2DSSE4;
+    }
+#endif
+
+    auto batchCount = (points.count + batchSize - 1) / batchSize;
+    if(!sortingEnabled || !areDenseEnoughToSort(points))
+    {
+        threadPool.parallelFor(batchCount, [&](size_t batchIndex) {
+            auto first = batchIndex*batchSize;
+            pointsFunction({&points, &results, nullptr, first, std::min(batchSize, points.count - first)});
+        });
+        return;
+    }
+
+    sortByCell(points, results);
+    threadPool.parallelFor(batchCount, [&](size_t batchIndex) {
+        auto first = batchIndex*batchSize;
+        auto last = std::min(first + batchSize, points.count);
+
+        // The runs of points in the same cell share its features, and the
+        // remaining points are gathered for the per lane kernel.
+        std::vector<uint32_t> scatteredIndices;
+        for(auto runStart = first; runStart < last; )
+        {
+            CellBounds cellBounds(sortedPoints, runStart);
+            auto runEnd = runStart + 1;
+            while(runEnd < last && cellBounds.contains(sortedPoints, runEnd))
+                ++runEnd;
+
+            if(runEnd - runStart >= MinSharedCellPointCount)
+            {
+                cellFunction({&sortedPoints, &sortedResults, nullptr, runStart, runEnd - runStart});
+            }
+            else
+            {
+                for(auto i = runStart; i < runEnd; ++i)
+                    scatteredIndices.push_back(uint32_t(i));
+            }
+            runStart = runEnd;
+        }
+
+        if(!scatteredIndices.empty())
+            pointsFunction({&sortedPoints, &sortedResults, scatteredIndices.data(), 0, scatteredIndices.size()});
+    });
+
+    threadPool.parallelFor(batchCount, [&](size_t batchIndex) {
+        auto first = batchIndex*batchSize;
+        auto last = std::min(first + batchSize, points.count);
+        for(int i = 0; i < 4; ++i)
+        {
+            if(!results.distances[i])
+                continue;
+            for(auto j = first; j < last; ++j)
+                results.distances[i][j] = sortedDistances[i][sortedPositions[j]];
+        }
+
+        if(results.cellIds)
+        {
+            for(auto j = first; j < last; ++j)
+                results.cellIds[j] = sortedCellIds[sortedPositions[j]];
+        }
+    });
+}
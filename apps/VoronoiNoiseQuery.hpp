@@ -0,0 +1,89 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_QUERY_HPP
+#define SHADER_VIS_VORONOI_NOISE_QUERY_HPP
+
+#include "VoronoiNoiseCPU.hpp"
+#include "WorkStealingThreadPool.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Scattered sample points in noise space, with a separate array per
+ * coordinate. The points are 2D when z is null. The sorted points are
+ * indexed with 32 bits, so there must be less than 2^32 of them.
+ */
+struct VoronoiNoisePoints
+{
+    const float *x = nullptr;
+    const float *y = nullptr;
+    const float *z = nullptr;
+    size_t count = 0;
+};
+
+/**
+ * The destination arrays of a query, indexed like the points. Any of them
+ * may be null when it is not needed.
+ */
+struct VoronoiNoiseQueryResults
+{
+    // The F1 to F4 distances to the nearest feature points, clamped to 1 as in the shader.
+    float *distances[4] = {};
+
+    // The hash of the cell of the nearest feature point, which identifies the
+    // Voronoi cell that contains the point.
+    uint32_t *cellIds = nullptr;
+};
+
+/**
+ * Batch evaluation of the Voronoi distances at arbitrary points, for the
+ * simulation workloads that are not bound to a screen grid. The 2D points
+ * give the same distances as voronoiNoiseComponents, and the 3D ones search
+ * the 27 neighbor cells of the same kind of hashed feature points.
+ *
+ * The points are processed in batches that are distributed over a work
+ * stealing thread pool. When sorting is enabled and the points are dense
+ * enough, they are first grouped by the cell that contains them, and the
+ * feature points around a cell are hashed once for all of its points, which
+ * are then evaluated together with SIMD. The points that do not share their
+ * cell are evaluated with a SIMD lane per point. The results do not depend on
+ * the sorting, the SIMD level nor the thread count.
+ */
+class VoronoiNoiseQuery
+{
+public:
+    static constexpr size_t DefaultBatchSize = 4096;
+
+    explicit VoronoiNoiseQuery(WorkStealingThreadPool &threadPool, size_t batchSize = DefaultBatchSize);
+
+    void setSIMDLevel(VoronoiNoiseSIMDLevel newLevel)
+    {
+        simdLevel = newLevel;
+    }
+
+    void setSortingEnabled(bool enabled)
+    {
+        sortingEnabled = enabled;
+    }
+
+    void evaluate(const VoronoiNoisePoints &points, const VoronoiNoiseQueryResults &results);
+
+private:
+    // Groups the points by their cell with a counting sort, and prepares the
+    // sorted copies of the coordinates and of the requested results.
+    void sortByCell(const VoronoiNoisePoints &points, const VoronoiNoiseQueryResults &results);
+
+    WorkStealingThreadPool &threadPool;
+    size_t batchSize;
+    VoronoiNoiseSIMDLevel simdLevel = getBestVoronoiNoiseSIMDLevel();
+    bool sortingEnabled = true;
+    std::vector<uint32_t> bucketOffsets;
+    std::vector<uint16_t> pointBuckets;
+    std::vector<uint32_t> sortedPositions;
+    std::vector<float> sortedCoordinates[3];
+    std::vector<float> sortedDistances[4];
+    std::vector<uint32_t> sortedCellIds;
+    VoronoiNoisePoints sortedPoints;
+    VoronoiNoiseQueryResults sortedResults;
+};
+
+#endif //SHADER_VIS_VORONOI_NOISE_QUERY_HPP
@@ -0,0 +1,235 @@
+#include "BenchmarkReport.hpp"
+#include "VoronoiNoiseQuery.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Measures the throughput of the Voronoi point queries, and checks that the
+ * 2D distances are the ones of voronoiNoiseComponents, and that every SIMD
+ * level gives the same results as the scalar path with and without the
+ * sorting by cell. The point sets are dense, with many points per cell, or
+ * sparse, with most cells empty. The best path is then measured with an
+ * increasing number of threads.
+ */
+// Adds the iteration times to the report, and returns the best one in seconds.
+template<typename FT>
+static double measureBestSeconds(BenchmarkReport &report, const std::string &name, double itemsPerIteration, int iterations, const FT &function)
+{
+    report.addSamples(name, sampleBenchmark(0, size_t(iterations), function), itemsPerIteration);
+    return report.getResults().back().minimum * 1e-9;
+}
+
+/**
+ * A point set with its result arrays.
+ */
+struct QueryPointSet
+{
+    const char *name;
+    int dimensions;
+    std::vector<float> coordinates[3];
+    std::vector<float> distances[4];
+    std::vector<uint32_t> cellIds;
+
+    void generate(size_t count, float pointsPerCell)
+    {
+        // The points are uniformly distributed over a cube centered at the
+        // origin, so that the negative cells are also covered.
+        auto cellCount = std::max(double(count) / double(pointsPerCell), 1.0);
+        auto extent = float(pow(cellCount, 1.0 / double(dimensions)));
+        std::mt19937 generator(1234);
+        std::uniform_real_distribution<float> distribution(-0.5f*extent, 0.5f*extent);
+        for(int d = 0; d < dimensions; ++d)
+        {
+            coordinates[d].resize(count);
+            for(auto &coordinate : coordinates[d])
+                coordinate = distribution(generator);
+        }
+    }
+
+    VoronoiNoisePoints getPoints() const
+    {
+        VoronoiNoisePoints points;
+        points.x = coordinates[0].data();
+        points.y = coordinates[1].data();
+        points.z = dimensions == 3 ? coordinates[2].data() : nullptr;
+        points.count = coordinates[0].size();
+        return points;
+    }
+
+    VoronoiNoiseQueryResults getResults()
+    {
+        VoronoiNoiseQueryResults results;
+        for(int i = 0; i < 4; ++i)
+        {
+            distances[i].assign(coordinates[0].size(), -1.0f);
+            results.distances[i] = distances[i].data();
+        }
+        cellIds.assign(coordinates[0].size(), 0);
+        results.cellIds = cellIds.data();
+        return results;
+    }
+
+    bool hasSameResults(const QueryPointSet &other) const
+    {
+        for(int i = 0; i < 4; ++i)
+        {
+            if(memcmp(distances[i].data(), other.distances[i].data(), distances[i].size()*sizeof(float)) != 0)
+                return false;
+        }
+        return cellIds == other.cellIds;
+    }
+};
+
+int main(int argc, const char *argv[])
+{
+    size_t pointCount = 1 << 20;
+    int iterations = 3;
+    size_t maxThreadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::string jsonFileName;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-points" && i + 1 < argc)
+        {
+            pointCount = size_t(std::max(1, atoi(argv[++i])));
+        }
+        else if (arg == "-iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (arg == "-threads" && i + 1 < argc)
+        {
+            maxThreadCount = size_t(std::max(1, atoi(argv[++i])));
+        }
+        else if (arg == "-json" && i + 1 < argc)
+        {
+            jsonFileName = argv[++i];
+        }
+    }
+
+    printf("Voronoi point queries, %d points, %d iterations\n", int(pointCount), iterations);
+
+    struct PointSetDescription
+    {
+        const char *name;
+        int dimensions;
+        float pointsPerCell;
+    };
+    const PointSetDescription descriptions[] = {
+        {"2D dense", 2, 64.0f},
+        {"2D sparse", 2, 1.0f / 16.0f},
+        {"3D dense", 3, 64.0f},
+        {"3D sparse", 3, 1.0f / 16.0f},
+    };
+    const VoronoiNoiseSIMDLevel levels[] = {
+        VoronoiNoiseSIMDLevel::Scalar,
+        VoronoiNoiseSIMDLevel::SSE4,
+        VoronoiNoiseSIMDLevel::AVX2,
+    };
+
+    BenchmarkReport report("VoronoiNoiseQueryBench");
+    report.setContext("points", std::to_string(pointCount));
+
+    int exitCode = 0;
+    WorkStealingThreadPool singleThreadPool(1);
+    for(auto &description : descriptions)
+    {
+        QueryPointSet reference;
+        reference.name = description.name;
+        reference.dimensions = description.dimensions;
+        reference.generate(pointCount, description.pointsPerCell);
+        auto points = reference.getPoints();
+
+        VoronoiNoiseQuery query(singleThreadPool);
+        query.setSIMDLevel(VoronoiNoiseSIMDLevel::Scalar);
+        query.setSortingEnabled(false);
+        query.evaluate(points, reference.getResults());
+
+        // The 2D distances must be the ones of the noise evaluator.
+        if(description.dimensions == 2)
+        {
+            bool matches = true;
+            for(size_t i = 0; i < pointCount && matches; ++i)
+            {
+                float components[4];
+                voronoiNoiseComponents(points.x[i], points.y[i], components);
+                for(int j = 0; j < 4; ++j)
+                    matches = matches && memcmp(&components[j], &reference.distances[j][i], sizeof(float)) == 0;
+            }
+            if(!matches)
+                exitCode = 1;
+            printf("%-10s %s\n", description.name, matches ? "matches voronoiNoiseComponents" : "MISMATCH with voronoiNoiseComponents");
+        }
+
+        for(auto level : levels)
+        {
+            auto levelName = getVoronoiNoiseSIMDLevelName(level);
+            if(!isVoronoiNoiseSIMDLevelSupported(level))
+            {
+                printf("%-10s %-8s not supported\n", description.name, levelName);
+                continue;
+            }
+
+            for(bool sorted : {false, true})
+            {
+                auto pointSet = reference;
+                auto results = pointSet.getResults();
+                query.setSIMDLevel(level);
+                query.setSortingEnabled(sorted);
+                auto name = std::string("query/") + description.name + "/" + levelName + (sorted ? "/sorted" : "/unsorted");
+                double bestSeconds = measureBestSeconds(report, name, double(pointCount), iterations, [&]() {
+                    query.evaluate(points, results);
+                });
+
+                bool matches = pointSet.hasSameResults(reference);
+                if(!matches)
+                    exitCode = 1;
+
+                printf("%-10s %-8s %-8s %10.3f Mpoints/s  %s\n", description.name, levelName, sorted ? "sorted" : "unsorted",
+                    pointCount / bestSeconds * 1e-6, matches ? "matches scalar" : "MISMATCH");
+            }
+        }
+
+        // Thread scaling of the best path.
+        double singleThreadSeconds = 0;
+        for(size_t threadCount = 1; ; threadCount = std::min(threadCount*2, maxThreadCount))
+        {
+            WorkStealingThreadPool threadPool(threadCount);
+            VoronoiNoiseQuery threadedQuery(threadPool);
+            auto pointSet = reference;
+            auto results = pointSet.getResults();
+            auto name = std::string("query/") + description.name + "/threads=" + std::to_string(threadCount);
+            double bestSeconds = measureBestSeconds(report, name, double(pointCount), iterations, [&]() {
+                threadedQuery.evaluate(points, results);
+            });
+            if(threadCount == 1)
+                singleThreadSeconds = bestSeconds;
+
+            bool matches = pointSet.hasSameResults(reference);
+            if(!matches)
+                exitCode = 1;
+
+            double speedup = singleThreadSeconds / bestSeconds;
+            printf("%-10s %2d threads %10.3f Mpoints/s  speedup %5.2fx  efficiency %3d%%  %s\n",
+                description.name, int(threadCount), pointCount / bestSeconds * 1e-6, speedup, int(speedup / threadCount * 100.0 + 0.5),
+                matches ? "matches scalar" : "MISMATCH");
+
+            if(threadCount == maxThreadCount)
+                break;
+        }
+    }
+
+    // The JSON results record whether every path matched its reference.
+    report.setContext("matches", exitCode == 0 ? "true" : "false");
+    if(!jsonFileName.empty() && !report.writeJSON(jsonFileName))
+        return 1;
+    return exitCode;
+}
@@ -0,0 +1,70 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_QUERY_KERNELS_HPP
+#define SHADER_VIS_VORONOI_NOISE_QUERY_KERNELS_HPP
+
+#include "VoronoiNoiseQuery.hpp"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The multipliers of the cell hashes, by feature point coordinate and by
+ * cell axis. The 2D hashes only use the first two of each row, which are the
+ * ones of voronoiRandomNoiseVector2.
+ */
+static constexpr int32_t VoronoiNoiseCellHashMultipliers[3][3] = {
+    {27901, 8537, 16411},
+    {6581, 21881, 11161},
+    {12473, 3739, 25117},
+};
+
+/**
+ * A point set of a kernel call. The points are the ones of the given
+ * indices, or count consecutive points from first when indices is null, and
+ * their results are written at the same indices. Each instruction set level
+ * lives in its own translation unit, because they are compiled with different
+ * code generation flags.
+ */
+struct VoronoiNoiseQueryBatch
+{
+    const VoronoiNoisePoints *points;
+    const VoronoiNoiseQueryResults *results;
+    const uint32_t *indices;
+    size_t first;
+    size_t count;
+
+    size_t getPointIndex(size_t i) const
+    {
+        return indices ? indices[i] : first + i;
+    }
+};
+
+// Every point hashes the feature points of its own neighbor cells.
+void queryVoronoiNoisePoints2DScalar(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoisePoints3DScalar(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoisePoints2DSSE4(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoisePoints3DSSE4(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoisePoints2DAVX2(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoisePoints3DAVX2(const VoronoiNoiseQueryBatch &batch);
+
+// Every point lies in the same cell, so the feature points are hashed once.
+void queryVoronoiNoiseCell2DScalar(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoiseCell3DScalar(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoiseCell2DSSE4(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoiseCell3DSSE4(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoiseCell2DAVX2(const VoronoiNoiseQueryBatch &batch);
+void queryVoronoiNoiseCell3DAVX2(const VoronoiNoiseQueryBatch &batch);
+
+/**
+ * The feature point of a neighbor cell, relative to the cell of the points.
+ */
+struct VoronoiNoiseCellFeature
+{
+    float offset[3];
+    uint32_t cellId;
+};
+
+// The features of the 9 or 27 neighbor cells of the cell that contains the
+// first point of the batch, in the order of the search.
+template<int Dimensions>
+void computeVoronoiNoiseCellFeatures(const VoronoiNoiseQueryBatch &batch, VoronoiNoiseCellFeature *features);
+
+#endif //SHADER_VIS_VORONOI_NOISE_QUERY_KERNELS_HPP
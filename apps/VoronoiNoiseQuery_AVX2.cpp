@@ -0,0 +1,207 @@
+#include "VoronoiNoiseQueryKernels.hpp"
+#include <immintrin.h>
+#include <algorithm>
+
+// This translation unit is compiled with AVX2 code generation enabled.
+// A lane group of 8 points fits exactly in one vector.
+
+static inline __m256i lowbias32(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7feb352d));
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(int32_t(0x846ca68bu)));
+    x = _mm256_xor_si256(x, _mm256_srai_epi32(x, 16));
+    return x;
+}
+
+// Gathers the coordinates of the next lane group, where the missing lanes are zero.
+template<int Dimensions>
+static inline size_t loadPoints8(const VoronoiNoiseQueryBatch &batch, size_t i, __m256 coordinates[3], size_t pointIndices[8])
+{
+    const float *sources[3] = {batch.points->x, batch.points->y, batch.points->z};
+    alignas(32) float lanes[3][8] = {};
+    auto laneCount = std::min(batch.count - i, size_t(8));
+    for(size_t lane = 0; lane < laneCount; ++lane)
+    {
+        auto index = batch.getPointIndex(i + lane);
+        pointIndices[lane] = index;
+        for(int d = 0; d < Dimensions; ++d)
+            lanes[d][lane] = sources[d][index];
+    }
+
+    for(int d = 0; d < Dimensions; ++d)
+        coordinates[d] = _mm256_load_ps(lanes[d]);
+    return laneCount;
+}
+
+static inline void storeResults8(const VoronoiNoiseQueryBatch &batch, size_t laneCount, const size_t pointIndices[8], const __m256 r[4], __m256i nearestCellId)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    alignas(32) float distances[4][8];
+    alignas(32) uint32_t cellIds[8];
+    for(int i = 0; i < 4; ++i)
+        _mm256_store_ps(distances[i], _mm256_min_ps(_mm256_sqrt_ps(r[i]), one));
+    _mm256_store_si256(reinterpret_cast<__m256i*> (cellIds), nearestCellId);
+
+    auto &results = *batch.results;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(!results.distances[i])
+            continue;
+        for(size_t lane = 0; lane < laneCount; ++lane)
+            results.distances[i][pointIndices[lane]] = distances[i][lane];
+    }
+
+    if(results.cellIds)
+    {
+        for(size_t lane = 0; lane < laneCount; ++lane)
+            results.cellIds[pointIndices[lane]] = cellIds[lane];
+    }
+}
+
+// Branchless version of the insertion chain, as in voronoiNoiseComponents8.
+static inline void insertDistance8(__m256 dist2, __m256i cellId, __m256 r[4], __m256i &nearestCellId)
+{
+    __m256 less0 = _mm256_cmp_ps(dist2, r[0], _CMP_LT_OQ);
+    __m256 less1 = _mm256_cmp_ps(dist2, r[1], _CMP_LT_OQ);
+    __m256 less2 = _mm256_cmp_ps(dist2, r[2], _CMP_LT_OQ);
+    r[3] = _mm256_blendv_ps(_mm256_blendv_ps(r[3], dist2, _mm256_cmp_ps(dist2, r[3], _CMP_LT_OQ)), r[2], less2);
+    r[2] = _mm256_blendv_ps(_mm256_blendv_ps(r[2], dist2, less2), r[1], less1);
+    r[1] = _mm256_blendv_ps(_mm256_blendv_ps(r[1], dist2, less1), r[0], less0);
+    r[0] = _mm256_blendv_ps(r[0], dist2, less0);
+    nearestCellId = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(nearestCellId), _mm256_castsi256_ps(cellId), less0));
+}
+
+template<int Dimensions>
+static void queryPoints8(const VoronoiNoiseQueryBatch &batch)
+{
+    const __m256 hashRange = _mm256_set1_ps(4294967295.0f);
+    const int range = Dimensions == 3 ? 1 : 0;
+    for(size_t i = 0; i < batch.count; i += 8)
+    {
+        __m256 coordinates[3];
+        size_t pointIndices[8];
+        auto laneCount = loadPoints8<Dimensions> (batch, i, coordinates, pointIndices);
+
+        __m256 startCell[3];
+        __m256 f[3];
+        for(int d = 0; d < Dimensions; ++d)
+        {
+            startCell[d] = _mm256_floor_ps(coordinates[d]);
+            f[d] = _mm256_sub_ps(coordinates[d], startCell[d]);
+        }
+
+        __m256 r[4];
+        for(int j = 0; j < 4; ++j)
+            r[j] = _mm256_set1_ps(1.0e10f);
+        __m256i nearestCellId = _mm256_setzero_si256();
+
+        for(int cz = -range; cz <= range; ++cz)
+        {
+            __m256 cellDelta[3];
+            __m256i cellHashes[3];
+            cellDelta[2] = _mm256_set1_ps(float(cz));
+            if(Dimensions == 3)
+                cellHashes[2] = lowbias32(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(startCell[2], cellDelta[2]))));
+            for(int cy = -1; cy <= 1; ++cy)
+            {
+                cellDelta[1] = _mm256_set1_ps(float(cy));
+                cellHashes[1] = lowbias32(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(startCell[1], cellDelta[1]))));
+                for(int cx = -1; cx <= 1; ++cx)
+                {
+                    cellDelta[0] = _mm256_set1_ps(float(cx));
+                    cellHashes[0] = lowbias32(_mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(startCell[0], cellDelta[0]))));
+
+                    __m256i cellId = _mm256_setzero_si256();
+                    __m256 dist2 = _mm256_setzero_ps();
+                    for(int c = 0; c < Dimensions; ++c)
+                    {
+                        __m256i hash = _mm256_add_epi32(
+                            _mm256_mullo_epi32(cellHashes[0], _mm256_set1_epi32(VoronoiNoiseCellHashMultipliers[c][0])),
+                            _mm256_mullo_epi32(cellHashes[1], _mm256_set1_epi32(VoronoiNoiseCellHashMultipliers[c][1])));
+                        if(Dimensions == 3)
+                            hash = _mm256_add_epi32(hash, _mm256_mullo_epi32(cellHashes[2], _mm256_set1_epi32(VoronoiNoiseCellHashMultipliers[c][2])));
+
+                        __m256i hashed = lowbias32(hash);
+                        if(c == 0)
+                            cellId = hashed;
+
+                        __m256 point = _mm256_div_ps(_mm256_cvtepi32_ps(hashed), hashRange);
+                        __m256 delta = _mm256_sub_ps(f[c], _mm256_add_ps(point, cellDelta[c]));
+                        __m256 square = _mm256_mul_ps(delta, delta);
+                        dist2 = c == 0 ? square : _mm256_add_ps(dist2, square);
+                    }
+
+                    insertDistance8(dist2, cellId, r, nearestCellId);
+                }
+            }
+        }
+
+        storeResults8(batch, laneCount, pointIndices, r, nearestCellId);
+    }
+
+    _mm256_zeroupper();
+}
+
+template<int Dimensions>
+static void queryCell8(const VoronoiNoiseQueryBatch &batch)
+{
+    constexpr int CellCount = Dimensions == 3 ? 27 : 9;
+    VoronoiNoiseCellFeature features[27];
+    computeVoronoiNoiseCellFeatures<Dimensions> (batch, features);
+
+    for(size_t i = 0; i < batch.count; i += 8)
+    {
+        __m256 coordinates[3];
+        size_t pointIndices[8];
+        auto laneCount = loadPoints8<Dimensions> (batch, i, coordinates, pointIndices);
+
+        __m256 f[3];
+        for(int d = 0; d < Dimensions; ++d)
+            f[d] = _mm256_sub_ps(coordinates[d], _mm256_floor_ps(coordinates[d]));
+
+        __m256 r[4];
+        for(int j = 0; j < 4; ++j)
+            r[j] = _mm256_set1_ps(1.0e10f);
+        __m256i nearestCellId = _mm256_setzero_si256();
+
+        for(int cell = 0; cell < CellCount; ++cell)
+        {
+            auto &feature = features[cell];
+            __m256 dist2 = _mm256_setzero_ps();
+            for(int c = 0; c < Dimensions; ++c)
+            {
+                __m256 delta = _mm256_sub_ps(f[c], _mm256_set1_ps(feature.offset[c]));
+                __m256 square = _mm256_mul_ps(delta, delta);
+                dist2 = c == 0 ? square : _mm256_add_ps(dist2, square);
+            }
+
+            insertDistance8(dist2, _mm256_set1_epi32(int32_t(feature.cellId)), r, nearestCellId);
+        }
+
+        storeResults8(batch, laneCount, pointIndices, r, nearestCellId);
+    }
+
+    _mm256_zeroupper();
+}
+
+void queryVoronoiNoisePoints2DAVX2(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPoints8<2> (batch);
+}
+
+void queryVoronoiNoisePoints3DAVX2(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPoints8<3> (batch);
+}
+
+void queryVoronoiNoiseCell2DAVX2(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCell8<2> (batch);
+}
+
+void queryVoronoiNoiseCell3DAVX2(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCell8<3> (batch);
+}
@@ -0,0 +1,203 @@
+#include "VoronoiNoiseQueryKernels.hpp"
+#include <smmintrin.h>
+#include <algorithm>
+
+// This translation unit is compiled with SSE4.1 code generation enabled.
+// The points are processed in lane groups of 4.
+
+static inline __m128i lowbias32(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 16));
+    x = _mm_mullo_epi32(x, _mm_set1_epi32(0x7feb352d));
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 15));
+    x = _mm_mullo_epi32(x, _mm_set1_epi32(int32_t(0x846ca68bu)));
+    x = _mm_xor_si128(x, _mm_srai_epi32(x, 16));
+    return x;
+}
+
+// Gathers the coordinates of the next lane group, where the missing lanes are zero.
+template<int Dimensions>
+static inline size_t loadPoints4(const VoronoiNoiseQueryBatch &batch, size_t i, __m128 coordinates[3], size_t pointIndices[4])
+{
+    const float *sources[3] = {batch.points->x, batch.points->y, batch.points->z};
+    alignas(16) float lanes[3][4] = {};
+    auto laneCount = std::min(batch.count - i, size_t(4));
+    for(size_t lane = 0; lane < laneCount; ++lane)
+    {
+        auto index = batch.getPointIndex(i + lane);
+        pointIndices[lane] = index;
+        for(int d = 0; d < Dimensions; ++d)
+            lanes[d][lane] = sources[d][index];
+    }
+
+    for(int d = 0; d < Dimensions; ++d)
+        coordinates[d] = _mm_load_ps(lanes[d]);
+    return laneCount;
+}
+
+static inline void storeResults4(const VoronoiNoiseQueryBatch &batch, size_t laneCount, const size_t pointIndices[4], const __m128 r[4], __m128i nearestCellId)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    alignas(16) float distances[4][4];
+    alignas(16) uint32_t cellIds[4];
+    for(int i = 0; i < 4; ++i)
+        _mm_store_ps(distances[i], _mm_min_ps(_mm_sqrt_ps(r[i]), one));
+    _mm_store_si128(reinterpret_cast<__m128i*> (cellIds), nearestCellId);
+
+    auto &results = *batch.results;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(!results.distances[i])
+            continue;
+        for(size_t lane = 0; lane < laneCount; ++lane)
+            results.distances[i][pointIndices[lane]] = distances[i][lane];
+    }
+
+    if(results.cellIds)
+    {
+        for(size_t lane = 0; lane < laneCount; ++lane)
+            results.cellIds[pointIndices[lane]] = cellIds[lane];
+    }
+}
+
+// Branchless version of the insertion chain, as in voronoiNoiseComponents4.
+static inline void insertDistance4(__m128 dist2, __m128i cellId, __m128 r[4], __m128i &nearestCellId)
+{
+    __m128 less0 = _mm_cmplt_ps(dist2, r[0]);
+    __m128 less1 = _mm_cmplt_ps(dist2, r[1]);
+    __m128 less2 = _mm_cmplt_ps(dist2, r[2]);
+    r[3] = _mm_blendv_ps(_mm_blendv_ps(r[3], dist2, _mm_cmplt_ps(dist2, r[3])), r[2], less2);
+    r[2] = _mm_blendv_ps(_mm_blendv_ps(r[2], dist2, less2), r[1], less1);
+    r[1] = _mm_blendv_ps(_mm_blendv_ps(r[1], dist2, less1), r[0], less0);
+    r[0] = _mm_blendv_ps(r[0], dist2, less0);
+    nearestCellId = _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(nearestCellId), _mm_castsi128_ps(cellId), less0));
+}
+
+template<int Dimensions>
+static void queryPoints4(const VoronoiNoiseQueryBatch &batch)
+{
+    const __m128 hashRange = _mm_set1_ps(4294967295.0f);
+    const int range = Dimensions == 3 ? 1 : 0;
+    for(size_t i = 0; i < batch.count; i += 4)
+    {
+        __m128 coordinates[3];
+        size_t pointIndices[4];
+        auto laneCount = loadPoints4<Dimensions> (batch, i, coordinates, pointIndices);
+
+        __m128 startCell[3];
+        __m128 f[3];
+        for(int d = 0; d < Dimensions; ++d)
+        {
+            startCell[d] = _mm_floor_ps(coordinates[d]);
+            f[d] = _mm_sub_ps(coordinates[d], startCell[d]);
+        }
+
+        __m128 r[4];
+        for(int j = 0; j < 4; ++j)
+            r[j] = _mm_set1_ps(1.0e10f);
+        __m128i nearestCellId = _mm_setzero_si128();
+
+        for(int cz = -range; cz <= range; ++cz)
+        {
+            __m128 cellDelta[3];
+            __m128i cellHashes[3];
+            cellDelta[2] = _mm_set1_ps(float(cz));
+            if(Dimensions == 3)
+                cellHashes[2] = lowbias32(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(startCell[2], cellDelta[2]))));
+            for(int cy = -1; cy <= 1; ++cy)
+            {
+                cellDelta[1] = _mm_set1_ps(float(cy));
+                cellHashes[1] = lowbias32(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(startCell[1], cellDelta[1]))));
+                for(int cx = -1; cx <= 1; ++cx)
+                {
+                    cellDelta[0] = _mm_set1_ps(float(cx));
+                    cellHashes[0] = lowbias32(_mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(startCell[0], cellDelta[0]))));
+
+                    __m128i cellId = _mm_setzero_si128();
+                    __m128 dist2 = _mm_setzero_ps();
+                    for(int c = 0; c < Dimensions; ++c)
+                    {
+                        __m128i hash = _mm_add_epi32(
+                            _mm_mullo_epi32(cellHashes[0], _mm_set1_epi32(VoronoiNoiseCellHashMultipliers[c][0])),
+                            _mm_mullo_epi32(cellHashes[1], _mm_set1_epi32(VoronoiNoiseCellHashMultipliers[c][1])));
+                        if(Dimensions == 3)
+                            hash = _mm_add_epi32(hash, _mm_mullo_epi32(cellHashes[2], _mm_set1_epi32(VoronoiNoiseCellHashMultipliers[c][2])));
+
+                        __m128i hashed = lowbias32(hash);
+                        if(c == 0)
+                            cellId = hashed;
+
+                        __m128 point = _mm_div_ps(_mm_cvtepi32_ps(hashed), hashRange);
+                        __m128 delta = _mm_sub_ps(f[c], _mm_add_ps(point, cellDelta[c]));
+                        __m128 square = _mm_mul_ps(delta, delta);
+                        dist2 = c == 0 ? square : _mm_add_ps(dist2, square);
+                    }
+
+                    insertDistance4(dist2, cellId, r, nearestCellId);
+                }
+            }
+        }
+
+        storeResults4(batch, laneCount, pointIndices, r, nearestCellId);
+    }
+}
+
+template<int Dimensions>
+static void queryCell4(const VoronoiNoiseQueryBatch &batch)
+{
+    constexpr int CellCount = Dimensions == 3 ? 27 : 9;
+    VoronoiNoiseCellFeature features[27];
+    computeVoronoiNoiseCellFeatures<Dimensions> (batch, features);
+
+    for(size_t i = 0; i < batch.count; i += 4)
+    {
+        __m128 coordinates[3];
+        size_t pointIndices[4];
+        auto laneCount = loadPoints4<Dimensions> (batch, i, coordinates, pointIndices);
+
+        __m128 f[3];
+        for(int d = 0; d < Dimensions; ++d)
+            f[d] = _mm_sub_ps(coordinates[d], _mm_floor_ps(coordinates[d]));
+
+        __m128 r[4];
+        for(int j = 0; j < 4; ++j)
+            r[j] = _mm_set1_ps(1.0e10f);
+        __m128i nearestCellId = _mm_setzero_si128();
+
+        for(int cell = 0; cell < CellCount; ++cell)
+        {
+            auto &feature = features[cell];
+            __m128 dist2 = _mm_setzero_ps();
+            for(int c = 0; c < Dimensions; ++c)
+            {
+                __m128 delta = _mm_sub_ps(f[c], _mm_set1_ps(feature.offset[c]));
+                __m128 square = _mm_mul_ps(delta, delta);
+                dist2 = c == 0 ? square : _mm_add_ps(dist2, square);
+            }
+
+            insertDistance4(dist2, _mm_set1_epi32(int32_t(feature.cellId)), r, nearestCellId);
+        }
+
+        storeResults4(batch, laneCount, pointIndices, r, nearestCellId);
+    }
+}
+
+void queryVoronoiNoisePoints2DSSE4(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPoints4<2> (batch);
+}
+
+void queryVoronoiNoisePoints3DSSE4(const VoronoiNoiseQueryBatch &batch)
+{
+    queryPoints4<3> (batch);
+}
+
+void queryVoronoiNoiseCell2DSSE4(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCell4<2> (batch);
+}
+
+void queryVoronoiNoiseCell3DSSE4(const VoronoiNoiseQueryBatch &batch)
+{
+    queryCell4<3> (batch);
+}
@@ -0,0 +1,109 @@
+#include "VoronoiNoiseStatistics.hpp"
+#include "VoronoiNoiseCPUKernels.hpp"
+#include <algorithm>
+#include <vector>
+
+void computeVoronoiNoiseValueRange(const ScreenAndUIState &state, float &minimum, float &maximum)
+{
+    float negativeSum = 0.0f;
+    float positiveSum = 0.0f;
+    for(auto factor : {state.voronoiF1, state.voronoiF2, state.voronoiF3, state.voronoiF4})
+    {
+        if(factor < 0.0f)
+            negativeSum += factor;
+        else
+            positiveSum += factor;
+    }
+
+    minimum = std::min(negativeSum*state.amplitude, positiveSum*state.amplitude);
+    maximum = std::max(negativeSum*state.amplitude, positiveSum*state.amplitude);
+}
+
+void computeVoronoiNoiseStatistics(const ScreenAndUIState &state, uint32_t sampleStep, VoronoiNoiseStatistics &statistics, VoronoiNoiseSIMDLevel level)
+{
+    if(!isVoronoiNoiseSIMDLevelSupported(level))
+        level = getBestVoronoiNoiseSIMDLevel();
+
+    auto rowFunction = &evaluateVoronoiNoiseValueRowScalar;
+#if defined(VORONOI_NOISE_CPU_HAS_X86_SIMD)
+    if(level == VoronoiNoiseSIMDLevel::AVX2)
+        rowFunction = &evaluateVoronoiNoiseValueRowAVX2;
+    else if(level == VoronoiNoiseSIMDLevel::SSE4)
+        rowFunction = &evaluateVoronoiNoiseValueRowSSE4;
+#endif
+
+    // A sample at the center of each block is a pixel of a screen that is
+    // step times smaller, with the same aspect.
+    auto step = std::max(sampleStep, 1u);
+    auto gridWidth = std::max(state.screenWidth / step, 1u);
+    auto gridHeight = std::max(state.screenHeight / step, 1u);
+    VoronoiNoiseKernelParameters parameters;
+    prepareVoronoiNoiseKernelParameters(state, parameters);
+    parameters.screenWidth /= float(step);
+    parameters.screenHeight /= float(step);
+
+    statistics = VoronoiNoiseStatistics{};
+    computeVoronoiNoiseValueRange(state, statistics.histogramMinimum, statistics.histogramMaximum);
+    statistics.minimum = 3.4e38f;
+    statistics.maximum = -3.4e38f;
+
+    // The histogram scatter keeps the reduction scalar.
+    std::vector<float> values(gridWidth);
+    double sum = 0.0;
+    for(uint32_t y = 0; y < gridHeight; ++y)
+    {
+        rowFunction(parameters, 0, y, gridWidth, values.data());
+        for(auto value : values)
+        {
+            statistics.minimum = std::min(statistics.minimum, value);
+            statistics.maximum = std::max(statistics.maximum, value);
+            sum += value;
+            ++statistics.histogram[getVoronoiNoiseHistogramBin(value, statistics.histogramMinimum, statistics.histogramMaximum)];
+        }
+    }
+
+    statistics.sampleCount = gridWidth*gridHeight;
+    statistics.mean = float(sum / double(statistics.sampleCount));
+}
+
+float getVoronoiNoiseStatisticsPercentile(const VoronoiNoiseStatistics &statistics, float fraction)
+{
+    if(statistics.sampleCount == 0)
+        return 0.0f;
+
+    auto target = double(std::min(std::max(fraction, 0.0f), 1.0f))*double(statistics.sampleCount);
+    auto binWidth = double(statistics.histogramMaximum - statistics.histogramMinimum) / double(VoronoiNoiseHistogramBinCount);
+    double cumulativeCount = 0.0;
+    double value = statistics.histogramMaximum;
+    for(uint32_t bin = 0; bin < VoronoiNoiseHistogramBinCount; ++bin)
+    {
+        auto count = double(statistics.histogram[bin]);
+        if(count > 0 && cumulativeCount + count >= target)
+        {
+            value = statistics.histogramMinimum + (double(bin) + (target - cumulativeCount) / count)*binWidth;
+            break;
+        }
+        cumulativeCount += count;
+    }
+
+    return std::min(std::max(float(value), statistics.minimum), statistics.maximum);
+}
+
+bool applyVoronoiNoiseAutoRange(const VoronoiNoiseStatistics &statistics, ScreenAndUIState &state, float lowFraction, float highFraction)
+{
+    auto low = getVoronoiNoiseStatisticsPercentile(statistics, lowFraction);
+    auto high = getVoronoiNoiseStatisticsPercentile(statistics, highFraction);
+
+    // A constant noise value has no range to map.
+    if(!(high > low))
+        return false;
+
+    auto startThreshold = state.startThreshold <= state.endThreshold ? low : high;
+    auto endThreshold = state.startThreshold <= state.endThreshold ? high : low;
+    if(startThreshold == state.startThreshold && endThreshold == state.endThreshold)
+        return false;
+
+    state.startThreshold = startThreshold;
+    state.endThreshold = endThreshold;
+    return true;
+}
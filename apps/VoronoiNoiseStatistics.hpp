@@ -0,0 +1,83 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_STATISTICS_HPP
+#define SHADER_VIS_VORONOI_NOISE_STATISTICS_HPP
+
+#include "ScreenAndUIState.hpp"
+#include "VoronoiNoiseCPU.hpp"
+#include <stdint.h>
+
+static constexpr uint32_t VoronoiNoiseHistogramBinCount = 256;
+
+// The statistics of the viewport are sampled on a grid with at most this many
+// samples on each side, at the centers of square blocks of pixels.
+static constexpr uint32_t VoronoiNoiseStatisticsMaxGridSize = 256;
+
+/**
+ * The distribution of the noise value, before the thresholds and the colors
+ * are applied. The layout must match the std430 NoiseStatistics struct of
+ * the statistics shaders, and NoiseSweepStatistics of voronoiNoiseSweep.glsl.
+ */
+struct VoronoiNoiseStatistics
+{
+    float minimum;
+    float maximum;
+    float mean;
+
+    // The histogram covers the values that the Voronoi factors and the
+    // amplitude can produce, so that the histograms of the states with the
+    // same factors can be compared.
+    float histogramMinimum;
+    float histogramMaximum;
+
+    uint32_t sampleCount;
+    uint32_t reserved[2];
+    uint32_t histogram[VoronoiNoiseHistogramBinCount];
+};
+static_assert(sizeof(VoronoiNoiseStatistics) == 32 + VoronoiNoiseHistogramBinCount*4, "VoronoiNoiseStatistics must match its shader layout");
+
+// The size in pixels of the blocks of the viewport that are sampled once.
+inline uint32_t getVoronoiNoiseStatisticsSampleStep(uint32_t screenWidth, uint32_t screenHeight)
+{
+    auto size = screenWidth > screenHeight ? screenWidth : screenHeight;
+    auto step = (size + VoronoiNoiseStatisticsMaxGridSize - 1) / VoronoiNoiseStatisticsMaxGridSize;
+    return step > 1 ? step : 1;
+}
+
+// The range of the noise values, where each distance lies in [0, 1] before
+// the amplitude is applied.
+void computeVoronoiNoiseValueRange(const ScreenAndUIState &state, float &minimum, float &maximum);
+
+inline uint32_t getVoronoiNoiseHistogramBin(float value, float minimum, float maximum)
+{
+    if(!(maximum > minimum))
+        return 0;
+
+    auto bin = (value - minimum) / (maximum - minimum)*float(VoronoiNoiseHistogramBinCount);
+    if(!(bin > 0.0f))
+        return 0;
+    return bin < float(VoronoiNoiseHistogramBinCount - 1) ? uint32_t(bin) : VoronoiNoiseHistogramBinCount - 1;
+}
+
+/**
+ * Computes the statistics of the noise value over the screen described by
+ * state, with a sample at the center of each block of sampleStep pixels,
+ * e.g. the step of getVoronoiNoiseStatisticsSampleStep. The values are
+ * evaluated with the SIMD row kernels, so they are the ones that
+ * renderVoronoiNoiseRegion thresholds.
+ */
+void computeVoronoiNoiseStatistics(const ScreenAndUIState &state, uint32_t sampleStep, VoronoiNoiseStatistics &statistics,
+    VoronoiNoiseSIMDLevel level = getBestVoronoiNoiseSIMDLevel());
+
+// The value below which the given fraction of the samples lie, interpolated
+// within its histogram bin and clamped to the sampled range.
+float getVoronoiNoiseStatisticsPercentile(const VoronoiNoiseStatistics &statistics, float fraction);
+
+/**
+ * Sets the thresholds to the given percentiles of the noise value, so that
+ * the colors span the values that are on the screen. An inverted mapping,
+ * with the start threshold above the end one, stays inverted. Returns whether
+ * the thresholds changed.
+ */
+bool applyVoronoiNoiseAutoRange(const VoronoiNoiseStatistics &statistics, ScreenAndUIState &state,
+    float lowFraction = 0.01f, float highFraction = 0.99f);
+
+#endif //SHADER_VIS_VORONOI_NOISE_STATISTICS_HPP
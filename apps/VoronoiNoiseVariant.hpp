@@ -0,0 +1,83 @@
+#ifndef SHADER_VIS_VORONOI_NOISE_VARIANT_HPP
+#define SHADER_VIS_VORONOI_NOISE_VARIANT_HPP
+
+#include "ScreenAndUIState.hpp"
+#include <stdint.h>
+#include <string>
+
+/**
+ * A specialization of the noise evaluation for the parameters of a frame. A
+ * fixed octave count turns the octave loop of the shader into a loop with a
+ * constant trip count, which the compilers unroll. Only the nearest distances
+ * that have a nonzero Voronoi factor are tracked: with the default factors,
+ * only F1 is kept, which replaces the insertion chain by a minimum and skips
+ * the square roots of the other distances. The specialized evaluation gives
+ * the same result as the generic one, since the untracked distances are only
+ * ever multiplied by a zero factor. The cell table variant fetches the
+ * feature points from the table of the frame instead of hashing them.
+ */
+struct VoronoiNoiseVariant
+{
+    static constexpr uint32_t MaxUnrolledOctaves = 8;
+
+    // The octave count that is fixed at compile time, or zero when it is read from the uniforms.
+    uint32_t octaves = 0;
+
+    // The number of the nearest distances that are tracked, from F1 only to F1 to F4.
+    uint32_t componentCount = 4;
+
+    // Whether the feature points are fetched from the cell table.
+    bool cellTable = false;
+
+    bool isGeneric() const
+    {
+        return octaves == 0 && componentCount == 4 && !cellTable;
+    }
+
+    uint32_t getKey() const
+    {
+        return (cellTable ? 128 : 0) + octaves*8 + componentCount;
+    }
+
+    // The preprocessor definitions that select the variant in voronoiNoise.glsl.
+    std::string getShaderDefinitions() const
+    {
+        std::string definitions = "#define VORONOI_COMPONENT_COUNT " + std::to_string(componentCount) + "\n";
+        if(octaves > 0)
+            definitions += "#define VORONOI_OCTAVES " + std::to_string(octaves) + "\n";
+        if(cellTable)
+            definitions += "#define VORONOI_CELL_TABLE\n";
+        return definitions;
+    }
+
+    std::string getName() const
+    {
+        return "octaves=" + (octaves > 0 ? std::to_string(octaves) : std::string("dynamic")) + "/components=" + std::to_string(componentCount) +
+            (cellTable ? "/cell-table" : "");
+    }
+};
+
+// The number of nearest distances that are needed by the Voronoi factors of the state.
+inline uint32_t getVoronoiNoiseComponentCount(const ScreenAndUIState &state)
+{
+    if(state.voronoiF4 != 0)
+        return 4;
+    if(state.voronoiF3 != 0)
+        return 3;
+    if(state.voronoiF2 != 0)
+        return 2;
+    return 1;
+}
+
+inline VoronoiNoiseVariant selectVoronoiNoiseVariant(const ScreenAndUIState &state, bool cellTable = false)
+{
+    VoronoiNoiseVariant variant;
+    variant.cellTable = cellTable;
+    auto octaves = int(state.octaves);
+    if(octaves >= 1 && octaves <= int(VoronoiNoiseVariant::MaxUnrolledOctaves))
+        variant.octaves = uint32_t(octaves);
+    variant.componentCount = getVoronoiNoiseComponentCount(state);
+    return variant;
+}
+
+#endif //SHADER_VIS_VORONOI_NOISE_VARIANT_HPP
@@ -0,0 +1,131 @@
+#include "WorkStealingThreadPool.hpp"
+#include <algorithm>
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(size_t i = 0; i < threadCount; ++i)
+        queues.push_back(std::unique_ptr<WorkQueue> (new WorkQueue()));
+
+    // The participant zero is the thread that calls parallelFor.
+    for(size_t i = 1; i < threadCount; ++i)
+        workerThreads.push_back(std::thread([this, i]() { workerThreadMain(i); }));
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(controlMutex);
+        isShuttingDown = true;
+    }
+    workAvailableCondition.notify_all();
+
+    for(auto &thread : workerThreads)
+        thread.join();
+}
+
+void WorkStealingThreadPool::parallelFor(size_t count, const IndexFunction &function)
+{
+    if(count == 0)
+        return;
+
+    // Nothing to distribute.
+    if(workerThreads.empty() || count == 1)
+    {
+        for(size_t i = 0; i < count; ++i)
+            function(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> parallelForLock(parallelForMutex);
+
+    // Give each participant a contiguous range, so that neighbouring indices
+    // are usually processed by the same thread.
+    auto participantCount = queues.size();
+    for(size_t p = 0; p < participantCount; ++p)
+    {
+        auto &queue = *queues[p];
+        std::unique_lock<std::mutex> queueLock(queue.mutex);
+        auto rangeStart = p*count / participantCount;
+        auto rangeEnd = (p + 1)*count / participantCount;
+        for(auto i = rangeStart; i < rangeEnd; ++i)
+            queue.indices.push_back(i);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(controlMutex);
+        currentFunction = &function;
+        activeWorkers = workerThreads.size();
+        ++currentGeneration;
+    }
+    workAvailableCondition.notify_all();
+
+    runParticipant(0);
+
+    // Wait for the workers to leave the loop, because they reference the function.
+    std::unique_lock<std::mutex> lock(controlMutex);
+    workFinishedCondition.wait(lock, [this]() { return activeWorkers == 0; });
+    currentFunction = nullptr;
+}
+
+void WorkStealingThreadPool::workerThreadMain(size_t participantIndex)
+{
+    size_t seenGeneration = 0;
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(controlMutex);
+            workAvailableCondition.wait(lock, [&]() { return isShuttingDown || currentGeneration != seenGeneration; });
+            if(isShuttingDown)
+                return;
+            seenGeneration = currentGeneration;
+        }
+
+        runParticipant(participantIndex);
+
+        std::unique_lock<std::mutex> lock(controlMutex);
+        if(--activeWorkers == 0)
+            workFinishedCondition.notify_all();
+    }
+}
+
+void WorkStealingThreadPool::runParticipant(size_t participantIndex)
+{
+    const auto &function = *currentFunction;
+    size_t index;
+    while(popOwnWork(participantIndex, index) || stealWork(participantIndex, index))
+        function(index);
+}
+
+bool WorkStealingThreadPool::popOwnWork(size_t participantIndex, size_t &index)
+{
+    auto &queue = *queues[participantIndex];
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    if(queue.indices.empty())
+        return false;
+
+    index = queue.indices.front();
+    queue.indices.pop_front();
+    return true;
+}
+
+bool WorkStealingThreadPool::stealWork(size_t participantIndex, size_t &index)
+{
+    // Steal from the end that is farthest away from the owner.
+    auto participantCount = queues.size();
+    for(size_t i = 1; i < participantCount; ++i)
+    {
+        auto &victim = *queues[(participantIndex + i) % participantCount];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if(victim.indices.empty())
+            continue;
+
+        index = victim.indices.back();
+        victim.indices.pop_back();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef SHADER_VIS_WORK_STEALING_THREAD_POOL_HPP
+#define SHADER_VIS_WORK_STEALING_THREAD_POOL_HPP
+
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A thread pool for data parallel loops with uneven work items. The indices
+ * of a loop are split in contiguous ranges, one per participant, and a
+ * participant that runs out of work steals from the others. The calling
+ * thread also participates in the loop.
+ */
+class WorkStealingThreadPool
+{
+public:
+    typedef std::function<void (size_t index)> IndexFunction;
+
+    // A thread count of zero uses the number of hardware threads.
+    explicit WorkStealingThreadPool(size_t threadCount = 0);
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+    // The number of participants, including the calling thread.
+    size_t getThreadCount() const
+    {
+        return queues.size();
+    }
+
+    // Calls function for every index in [0, count), and waits for them to finish.
+    void parallelFor(size_t count, const IndexFunction &function);
+
+private:
+    struct alignas(64) WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<size_t> indices;
+    };
+
+    void workerThreadMain(size_t participantIndex);
+    void runParticipant(size_t participantIndex);
+    bool popOwnWork(size_t participantIndex, size_t &index);
+    bool stealWork(size_t participantIndex, size_t &index);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workerThreads;
+
+    std::mutex controlMutex;
+    std::mutex parallelForMutex;
+    std::condition_variable workAvailableCondition;
+    std::condition_variable workFinishedCondition;
+    const IndexFunction *currentFunction = nullptr;
+    size_t currentGeneration = 0;
+    size_t activeWorkers = 0;
+    bool isShuttingDown = false;
+};
+
+#endif //SHADER_VIS_WORK_STEALING_THREAD_POOL_HPP
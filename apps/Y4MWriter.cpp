@@ -0,0 +1,103 @@
+#include "Y4MWriter.hpp"
+
+Y4MWriter::~Y4MWriter()
+{
+    close();
+}
+
+bool Y4MWriter::open(const std::string &newFileName, uint32_t newWidth, uint32_t newHeight, uint32_t framesPerSecond)
+{
+    close();
+    fileName = newFileName;
+    width = newWidth;
+    height = newHeight;
+
+    file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open file %s for writing.\n", fileName.c_str());
+        return false;
+    }
+
+    fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, framesPerSecond);
+    auto chromaSize = size_t((width + 1) / 2)*((height + 1) / 2);
+    planes.resize(size_t(width)*height + 2*chromaSize);
+    return true;
+}
+
+static inline uint8_t clampToByte(int value)
+{
+    return uint8_t(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+bool Y4MWriter::writeFrame(const uint32_t *pixels, size_t pitch)
+{
+    if(!file)
+        return false;
+
+    // The coefficients are scaled by 2^16.
+    auto chromaWidth = (width + 1) / 2;
+    auto chromaHeight = (height + 1) / 2;
+    auto lumaPlane = planes.data();
+    auto cbPlane = lumaPlane + size_t(width)*height;
+    auto crPlane = cbPlane + size_t(chromaWidth)*chromaHeight;
+    for(uint32_t y = 0; y < height; ++y)
+    {
+        auto sourceRow = pixels + y*pitch;
+        auto lumaRow = lumaPlane + size_t(y)*width;
+        for(uint32_t x = 0; x < width; ++x)
+        {
+            auto pixel = sourceRow[x];
+            int red = (pixel >> 16) & 0xff;
+            int green = (pixel >> 8) & 0xff;
+            int blue = pixel & 0xff;
+            lumaRow[x] = uint8_t((19595*red + 38470*green + 7471*blue + 32768) >> 16);
+        }
+    }
+
+    for(uint32_t chromaY = 0; chromaY < chromaHeight; ++chromaY)
+    {
+        auto topRow = pixels + size_t(chromaY*2)*pitch;
+        auto bottomRow = chromaY*2 + 1 < height ? topRow + pitch : topRow;
+        for(uint32_t chromaX = 0; chromaX < chromaWidth; ++chromaX)
+        {
+            auto left = chromaX*2;
+            auto right = left + 1 < width ? left + 1 : left;
+            uint32_t block[4] = {topRow[left], topRow[right], bottomRow[left], bottomRow[right]};
+            int red = 0;
+            int green = 0;
+            int blue = 0;
+            for(auto pixel : block)
+            {
+                red += (pixel >> 16) & 0xff;
+                green += (pixel >> 8) & 0xff;
+                blue += pixel & 0xff;
+            }
+
+            // The sums are four times the average.
+            auto chromaIndex = size_t(chromaY)*chromaWidth + chromaX;
+            cbPlane[chromaIndex] = clampToByte(((-11059*red - 21709*green + 32768*blue + 2*65536) >> 18) + 128);
+            crPlane[chromaIndex] = clampToByte(((32768*red - 27439*green - 5329*blue + 2*65536) >> 18) + 128);
+        }
+    }
+
+    if(fputs("FRAME\n", file) < 0 || fwrite(planes.data(), planes.size(), 1, file) != 1)
+    {
+        fprintf(stderr, "Failed to write a frame of %s.\n", fileName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool Y4MWriter::close()
+{
+    if(!file)
+        return true;
+
+    bool succeeded = fclose(file) == 0;
+    file = nullptr;
+    if(!succeeded)
+        fprintf(stderr, "Failed to write file %s.\n", fileName.c_str());
+    return succeeded;
+}
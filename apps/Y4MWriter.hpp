@@ -0,0 +1,36 @@
+#ifndef SHADER_VIS_Y4M_WRITER_HPP
+#define SHADER_VIS_Y4M_WRITER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/**
+ * Streaming writer of YUV4MPEG2 videos, the uncompressed format that is read
+ * by ffmpeg, x264 and most players. The B8G8R8A8 frames are converted to full
+ * range BT.601 YCbCr with 4:2:0 chroma subsampling, where the chroma of each
+ * 2x2 block of pixels is the average of the block.
+ */
+class Y4MWriter
+{
+public:
+    ~Y4MWriter();
+
+    bool open(const std::string &fileName, uint32_t width, uint32_t height, uint32_t framesPerSecond);
+
+    // The pitch is expressed in pixels.
+    bool writeFrame(const uint32_t *pixels, size_t pitch);
+
+    bool close();
+
+private:
+    FILE *file = nullptr;
+    std::string fileName;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> planes;
+};
+
+#endif //SHADER_VIS_Y4M_WRITER_HPP
@@ -16,23 +16,21 @@ layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
     vec4 endColor;
 } ScreenAndUIState;
 
-struct UIElementQuad
+// Positions and sizes in quarter pixels, RGBA8 color, and the font rectangle
+// in 16-bit normalized texture coordinates. A zero font width marks a plain
+// rectangle.
+struct PackedUIElementQuad
 {
-    vec2 position;
-    vec2 size;
-    vec4 color;
-    
-    bool isGlyph;
-    uint reserved;
-    uvec2 reserved2;
-
-    vec2 fontPosition;
-    vec2 fontSize;
+    uint position;
+    uint size;
+    uint color;
+    uint fontPosition;
+    uint fontSize;
 };
 
 layout(std430, set = 1, binding = 1) buffer UIDataBufferBlock
 {
-    UIElementQuad UIDataBuffer[];
+    PackedUIElementQuad UIDataBuffer[];
 };
 
 layout(location = 0) out vec4 outColor;
@@ -49,22 +47,26 @@ const vec2 quadVertices[4] = vec2[4](
 
 void main()
 {
-    // Fetch the instance data.
-    UIElementQuad quad = UIDataBuffer[gl_InstanceIndex];
+    // Fetch and decode the instance data.
+    PackedUIElementQuad quad = UIDataBuffer[gl_InstanceIndex];
+    vec2 quadPosition = vec2(bitfieldExtract(int(quad.position), 0, 16), bitfieldExtract(int(quad.position), 16, 16))*0.25;
+    vec2 quadSize = vec2(quad.size & 0xFFFFu, quad.size >> 16)*0.25;
+    vec2 fontPosition = unpackUnorm2x16(quad.fontPosition);
+    vec2 fontSize = unpackUnorm2x16(quad.fontSize);
 
     // Pass the instance color
-    outColor = quad.color;
+    outColor = unpackUnorm4x8(quad.color);
 
     // Fetch the quad vertex
     vec2 quadCoord = quadVertices[gl_VertexIndex];
     outQuadCoord = quadCoord;
 
     // Position in screen   
-    vec2 position = quad.position + quad.size*quadCoord;
+    vec2 position = quadPosition + quadSize*quadCoord;
 
     // Glyph for text rendering
-    outIsGlyph = quad.isGlyph ? 1 : 0;
-    outGlyphCoord = quad.fontPosition + quad.fontSize*quadCoord;
+    outIsGlyph = (quad.fontSize & 0xFFFFu) != 0u ? 1 : 0;
+    outGlyphCoord = fontPosition + fontSize*quadCoord;
 
     gl_Position = vec4(position / vec2(ScreenAndUIState.screenSize)*2.0 - 1.0, 0.0, 1.0);
     if(ScreenAndUIState.flipVertically)
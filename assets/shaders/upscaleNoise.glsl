@@ -0,0 +1,35 @@
+#version 450
+
+layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
+{
+    uvec2 screenSize;
+
+    bool flipVertically;
+    float screenScale;
+
+    vec2 screenOffset;
+
+    float startThreshold;
+    float endThreshold;
+
+    float amplitude;
+    float octaves;
+    float lacunarity;
+    float resolutionScale;
+} ScreenAndUIState;
+
+layout (set=0, binding = 0) uniform sampler textureSampler;
+layout (set=1, binding = 5) uniform texture2D scaledNoiseTexture;
+
+layout(location=0) in vec2 screenCoord;
+
+layout(location=0) out vec4 fragColor;
+
+void main()
+{
+    // The noise was drawn into the top left part of a color buffer with the
+    // size of the screen, at the resolution scale of the frame.
+    vec2 bufferSize = vec2(textureSize(sampler2D(scaledNoiseTexture, textureSampler), 0));
+    vec2 texcoord = gl_FragCoord.xy*ScreenAndUIState.resolutionScale / bufferSize;
+    fragColor = texture(sampler2D(scaledNoiseTexture, textureSampler), texcoord);
+}
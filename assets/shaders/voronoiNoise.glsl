@@ -1,5 +1,14 @@
 #version 450
 
+// The application compiles specialized variants of this shader by defining
+// these before the source. VORONOI_COMPONENT_COUNT is the number of the
+// nearest distances that are tracked, and VORONOI_OCTAVES fixes the octave
+// count instead of reading it from the uniforms. VORONOI_CELL_TABLE fetches the
+// feature points from the cell table that voronoiNoiseCellTable.glsl fills.
+#ifndef VORONOI_COMPONENT_COUNT
+#define VORONOI_COMPONENT_COUNT 4
+#endif
+
 layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
 {
     uvec2 screenSize;
@@ -15,7 +24,7 @@ layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
     float amplitude;
     float octaves;
     float lacunarity;
-    float reserved;
+    float resolutionScale;
 
     vec4 voronoiFactors;
     vec4 startColor;
@@ -51,7 +60,58 @@ vec2 randomNoiseVector2(vec2 v)
     ) / 4294967295.0;
 }
 
-vec4 voronoiNoiseComponents(vec2 v)
+#ifdef VORONOI_CELL_TABLE
+#define CELL_TABLE_MAX_OCTAVES 16
+
+// The rectangle of cells of an octave in the table, as in VoronoiNoiseCellTable.hpp.
+struct CellTableOctave
+{
+    ivec2 origin;
+    uvec2 size;
+    uint offset;
+    uint reserved0;
+    uint reserved1;
+    uint reserved2;
+};
+
+layout(std430, set = 1, binding = 10) readonly buffer CellTableHeaderBlock
+{
+    uint octaveCount;
+    uint pointCount;
+    uvec2 reserved;
+    CellTableOctave octaves[CELL_TABLE_MAX_OCTAVES];
+} CellTableHeader;
+
+layout(std430, set = 1, binding = 11) readonly buffer CellTablePointsBlock
+{
+    vec2 points[];
+} CellTablePoints;
+
+// The table gives the same points as the hash, which is used for the cells
+// outside of it, and for the octaves that it does not have.
+vec2 cellFeaturePoint(int octave, vec2 cell)
+{
+    if(octave < int(CellTableHeader.octaveCount))
+    {
+        CellTableOctave tableOctave = CellTableHeader.octaves[octave];
+        vec2 tableCell = cell - vec2(tableOctave.origin);
+        if(all(greaterThanEqual(tableCell, vec2(0.0))) && all(lessThan(tableCell, vec2(tableOctave.size))))
+        {
+            uvec2 index = uvec2(tableCell);
+            return CellTablePoints.points[tableOctave.offset + index.y*tableOctave.size.x + index.x];
+        }
+    }
+
+    return randomNoiseVector2(cell);
+}
+#else
+vec2 cellFeaturePoint(int octave, vec2 cell)
+{
+    return randomNoiseVector2(cell);
+}
+#endif
+
+vec4 voronoiNoiseComponents(vec2 v, int octave)
 {
     vec4 result = vec4(1.0e10);
     vec2 startCell = floor(v);
@@ -62,23 +122,40 @@ vec4 voronoiNoiseComponents(vec2 v)
         {
             vec2 cellDelta = vec2(x, y);
             vec2 cell = startCell + cellDelta;
-            vec2 point = randomNoiseVector2(cell);
+            vec2 point = cellFeaturePoint(octave, cell);
 
             vec2 delta = f - (point + cellDelta);
             float dist2 = dot(delta, delta);
+#if VORONOI_COMPONENT_COUNT == 1
+            result.x = min(result.x, dist2);
+#else
             if(dist2 < result.x)
                 result = vec4(dist2, result.xyz);
             else if(dist2 < result.y)
                 result = vec4(result.x, dist2, result.yz);
+#if VORONOI_COMPONENT_COUNT > 2
             else if(dist2 < result.z)
                 result = vec4(result.xy, dist2, result.z);
+#endif
+#if VORONOI_COMPONENT_COUNT > 3
             else if(dist2 < result.w)
                 result = vec4(result.xyz, dist2);
+#endif
+#endif
         }
 
     }
 
+    // The distances that are not tracked are zero, so they do not contribute to the noise value.
+#if VORONOI_COMPONENT_COUNT == 1
+    return vec4(min(sqrt(result.x), 1.0), 0.0, 0.0, 0.0);
+#elif VORONOI_COMPONENT_COUNT == 2
+    return vec4(min(sqrt(result.xy), vec2(1.0)), 0.0, 0.0);
+#elif VORONOI_COMPONENT_COUNT == 3
+    return vec4(min(sqrt(result.xyz), vec3(1.0)), 0.0);
+#else
     return min(sqrt(result), vec4(1.0));
+#endif
 }
 
 void main()
@@ -91,10 +168,14 @@ void main()
     float totalGain = 0.0;
 
     vec4 noiseComponents = vec4(0.0);
+#ifdef VORONOI_OCTAVES
+    const int octaves = VORONOI_OCTAVES;
+#else
     int octaves = int(ScreenAndUIState.octaves);
+#endif
     for(int i = 0; i < octaves; ++i)
     {
-        noiseComponents += voronoiNoiseComponents(noiseCoordinate)*noiseGain;
+        noiseComponents += voronoiNoiseComponents(noiseCoordinate, i)*noiseGain;
         totalGain += noiseGain;
 
         noiseCoordinate *= ScreenAndUIState.lacunarity;
@@ -0,0 +1,49 @@
+#version 450
+
+layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
+{
+    uvec2 screenSize;
+
+    bool flipVertically;
+    float screenScale;
+
+    vec2 screenOffset;
+
+    float startThreshold;
+    float endThreshold;
+
+    float amplitude;
+    float octaves;
+    float lacunarity;
+    float resolutionScale;
+
+    vec4 voronoiFactors;
+    vec4 startColor;
+    vec4 endColor;
+} ScreenAndUIState;
+
+
+layout(rgba16f, set = 1, binding = 3) uniform readonly image2D noiseTileAtlas;
+
+layout(location=0) in vec2 screenCoord;
+
+layout(location=0) out vec4 fragColor;
+
+void main()
+{
+    float screenAspect = float(ScreenAndUIState.screenSize.y) / float(ScreenAndUIState.screenSize.x);
+    vec2 viewPosition = (screenCoord - 0.5)*ScreenAndUIState.screenScale*vec2(1.0, screenAspect) - ScreenAndUIState.screenOffset;
+
+    // The noise components were baked by voronoiNoiseBake.glsl for the texel that contains this pixel.
+    float pixelSize = ScreenAndUIState.screenScale / float(ScreenAndUIState.screenSize.x);
+    ivec2 texel = ivec2(floor(viewPosition / pixelSize));
+    vec4 noiseComponents = imageLoad(noiseTileAtlas, texel & (imageSize(noiseTileAtlas) - 1))*ScreenAndUIState.amplitude;
+
+    float noiseValue = dot(noiseComponents, ScreenAndUIState.voronoiFactors);
+    if (ScreenAndUIState.startThreshold <= ScreenAndUIState.endThreshold)
+        noiseValue = clamp((noiseValue - ScreenAndUIState.startThreshold) / (ScreenAndUIState.endThreshold - ScreenAndUIState.startThreshold), 0.0, 1.0);
+    else
+        noiseValue = clamp((noiseValue - ScreenAndUIState.endThreshold) / (ScreenAndUIState.startThreshold - ScreenAndUIState.endThreshold), 0.0, 1.0);
+
+    fragColor = mix(ScreenAndUIState.startColor, ScreenAndUIState.endColor, noiseValue);
+}
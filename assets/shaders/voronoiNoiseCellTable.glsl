@@ -0,0 +1,77 @@
+#version 450
+
+// Fills the cell table of voronoiNoise.glsl, with one invocation per cell.
+// The header is laid out on the CPU by layoutVoronoiNoiseCellTable, and its
+// octaves are packed one after the other, so the octave of a cell is found
+// from the offsets.
+#define WORKGROUP_SIZE 64
+#define CELL_TABLE_MAX_OCTAVES 16
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+struct CellTableOctave
+{
+    ivec2 origin;
+    uvec2 size;
+    uint offset;
+    uint reserved0;
+    uint reserved1;
+    uint reserved2;
+};
+
+layout(std430, set = 1, binding = 10) readonly buffer CellTableHeaderBlock
+{
+    uint octaveCount;
+    uint pointCount;
+    uvec2 reserved;
+    CellTableOctave octaves[CELL_TABLE_MAX_OCTAVES];
+} CellTableHeader;
+
+layout(std430, set = 1, binding = 11) writeonly buffer CellTablePointsBlock
+{
+    vec2 points[];
+} CellTablePoints;
+
+/**
+ * Hash function from: https://nullprogram.com/blog/2018/07/31/ and https://github.com/skeeto/hash-prospector .
+ * Released by the original author on the public domain.
+ */
+int lowbias32(int x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+vec2 randomNoiseVector2(vec2 v)
+{
+    ivec2 f = ivec2(floor(v));
+    ivec2 fh = ivec2(lowbias32(f.x), lowbias32(f.y));
+    return vec2(
+        lowbias32(fh.x * 27901 + fh.y * 8537),
+        lowbias32(fh.x * 6581 + fh.y * 21881)
+    ) / 4294967295.0;
+}
+
+void main()
+{
+    uint pointIndex = gl_GlobalInvocationID.x;
+    if(pointIndex >= CellTableHeader.pointCount)
+        return;
+
+    // The octaves without cells have a zero size, so they are never selected.
+    for(uint octave = 0; octave < CellTableHeader.octaveCount; ++octave)
+    {
+        CellTableOctave tableOctave = CellTableHeader.octaves[octave];
+        uint localIndex = pointIndex - tableOctave.offset;
+        if(pointIndex < tableOctave.offset || localIndex >= tableOctave.size.x*tableOctave.size.y)
+            continue;
+
+        ivec2 cell = tableOctave.origin + ivec2(localIndex % tableOctave.size.x, localIndex / tableOctave.size.x);
+        CellTablePoints.points[pointIndex] = randomNoiseVector2(vec2(cell));
+        return;
+    }
+}
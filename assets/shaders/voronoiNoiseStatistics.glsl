@@ -0,0 +1,220 @@
+#version 450
+
+// The first pass of the viewport statistics. Each workgroup reduces the
+// noise values of its block of the sample grid in the shared memory, and
+// writes its partial statistics, so no global atomics or buffer clears are
+// needed. voronoiNoiseStatisticsResolve.glsl reduces the partial ones.
+#define WORKGROUP_SIDE 16
+#define WORKGROUP_SIZE (WORKGROUP_SIDE*WORKGROUP_SIDE)
+#define HISTOGRAM_BIN_COUNT 256
+#define MAX_GRID_SIZE 256
+
+layout(local_size_x = WORKGROUP_SIDE, local_size_y = WORKGROUP_SIDE) in;
+
+layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
+{
+    uvec2 screenSize;
+
+    bool flipVertically;
+    float screenScale;
+
+    vec2 screenOffset;
+
+    float startThreshold;
+    float endThreshold;
+
+    float amplitude;
+    float octaves;
+    float lacunarity;
+    float resolutionScale;
+
+    vec4 voronoiFactors;
+    vec4 startColor;
+    vec4 endColor;
+} ScreenAndUIState;
+
+struct NoiseStatistics
+{
+    float minimum;
+    float maximum;
+    float mean;
+    float histogramMinimum;
+    float histogramMaximum;
+    uint sampleCount;
+    uint reserved0;
+    uint reserved1;
+    uint histogram[HISTOGRAM_BIN_COUNT];
+};
+
+// The mean of the partial statistics holds the sum of the values instead.
+layout(std430, set = 1, binding = 8) writeonly buffer NoiseStatisticsPartialBlock
+{
+    NoiseStatistics partialStatistics[];
+};
+
+shared float sharedMinimum[WORKGROUP_SIZE];
+shared float sharedMaximum[WORKGROUP_SIZE];
+shared float sharedSum[WORKGROUP_SIZE];
+shared uint sharedHistogram[HISTOGRAM_BIN_COUNT];
+
+/**
+ * Hash function from: https://nullprogram.com/blog/2018/07/31/ and https://github.com/skeeto/hash-prospector .
+ * Released by the original author on the public domain.
+ */
+int lowbias32(int x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+vec2 randomNoiseVector2(vec2 v)
+{
+    ivec2 f = ivec2(floor(v));
+    ivec2 fh = ivec2(lowbias32(f.x), lowbias32(f.y));
+    return vec2(
+        lowbias32(fh.x * 27901 + fh.y * 8537),
+        lowbias32(fh.x * 6581 + fh.y * 21881)
+    ) / 4294967295.0;
+}
+
+vec4 voronoiNoiseComponents(vec2 v)
+{
+    vec4 result = vec4(1.0e10);
+    vec2 startCell = floor(v);
+    vec2 f = v - startCell;
+    for(int y = -1; y <= 1; ++y)
+    {
+        for(int x = -1; x <= 1; ++x)
+        {
+            vec2 cellDelta = vec2(x, y);
+            vec2 cell = startCell + cellDelta;
+            vec2 point = randomNoiseVector2(cell);
+
+            vec2 delta = f - (point + cellDelta);
+            float dist2 = dot(delta, delta);
+            if(dist2 < result.x)
+                result = vec4(dist2, result.xyz);
+            else if(dist2 < result.y)
+                result = vec4(result.x, dist2, result.yz);
+            else if(dist2 < result.z)
+                result = vec4(result.xy, dist2, result.z);
+            else if(dist2 < result.w)
+                result = vec4(result.xyz, dist2);
+        }
+
+    }
+
+    return min(sqrt(result), vec4(1.0));
+}
+
+// Matches getVoronoiNoiseHistogramBin.
+uint getHistogramBin(float value, float minimum, float maximum)
+{
+    if(!(maximum > minimum))
+        return 0;
+
+    float bin = (value - minimum) / (maximum - minimum)*float(HISTOGRAM_BIN_COUNT);
+    if(!(bin > 0.0))
+        return 0;
+    return bin < float(HISTOGRAM_BIN_COUNT - 1) ? uint(bin) : HISTOGRAM_BIN_COUNT - 1;
+}
+
+// Matches getVoronoiNoiseStatisticsSampleStep.
+uint getSampleStep()
+{
+    uint size = max(ScreenAndUIState.screenSize.x, ScreenAndUIState.screenSize.y);
+    return max((size + MAX_GRID_SIZE - 1) / MAX_GRID_SIZE, 1u);
+}
+
+uvec2 getGridSize()
+{
+    return max(ScreenAndUIState.screenSize / getSampleStep(), uvec2(1));
+}
+
+void main()
+{
+    uint localIndex = gl_LocalInvocationIndex;
+    sharedHistogram[localIndex] = 0;
+    barrier();
+
+    // Each distance lies in [0, 1] before the amplitude is applied.
+    vec4 factors = ScreenAndUIState.voronoiFactors;
+    float negativeSum = dot(min(factors, vec4(0.0)), vec4(1.0))*ScreenAndUIState.amplitude;
+    float positiveSum = dot(max(factors, vec4(0.0)), vec4(1.0))*ScreenAndUIState.amplitude;
+    float histogramMinimum = min(negativeSum, positiveSum);
+    float histogramMaximum = max(negativeSum, positiveSum);
+
+    // A sample at the center of each block is a pixel of a screen that is
+    // step times smaller, with the same aspect.
+    uvec2 gridSize = getGridSize();
+    vec2 sampleScreenSize = vec2(ScreenAndUIState.screenSize) / float(getSampleStep());
+    float screenAspect = float(ScreenAndUIState.screenSize.y) / float(ScreenAndUIState.screenSize.x);
+
+    float minimum = 3.4e38;
+    float maximum = -3.4e38;
+    float sum = 0.0;
+    uvec2 samplePosition = gl_GlobalInvocationID.xy;
+    if(all(lessThan(samplePosition, gridSize)))
+    {
+        // The same screen coordinates as the CPU evaluator.
+        vec2 screenCoord = (vec2(samplePosition) + 0.5) / sampleScreenSize;
+        if(!ScreenAndUIState.flipVertically)
+            screenCoord.y = -screenCoord.y;
+        vec2 noiseCoordinate = (screenCoord - 0.5)*ScreenAndUIState.screenScale*vec2(1.0, screenAspect) - ScreenAndUIState.screenOffset;
+
+        float noiseGain = 1.0;
+        float totalGain = 0.0;
+        vec4 noiseComponents = vec4(0.0);
+        int octaves = int(ScreenAndUIState.octaves);
+        for(int i = 0; i < octaves; ++i)
+        {
+            noiseComponents += voronoiNoiseComponents(noiseCoordinate)*noiseGain;
+            totalGain += noiseGain;
+
+            noiseCoordinate *= ScreenAndUIState.lacunarity;
+            noiseGain /= ScreenAndUIState.lacunarity;
+        }
+
+        noiseComponents *= ScreenAndUIState.amplitude / totalGain;
+        float noiseValue = dot(noiseComponents, factors);
+
+        minimum = noiseValue;
+        maximum = noiseValue;
+        sum = noiseValue;
+        atomicAdd(sharedHistogram[getHistogramBin(noiseValue, histogramMinimum, histogramMaximum)], 1u);
+    }
+
+    sharedMinimum[localIndex] = minimum;
+    sharedMaximum[localIndex] = maximum;
+    sharedSum[localIndex] = sum;
+    barrier();
+
+    for(uint stride = WORKGROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if(localIndex < stride)
+        {
+            sharedMinimum[localIndex] = min(sharedMinimum[localIndex], sharedMinimum[localIndex + stride]);
+            sharedMaximum[localIndex] = max(sharedMaximum[localIndex], sharedMaximum[localIndex + stride]);
+            sharedSum[localIndex] += sharedSum[localIndex + stride];
+        }
+        barrier();
+    }
+
+    uint workgroupIndex = gl_WorkGroupID.y*gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    partialStatistics[workgroupIndex].histogram[localIndex] = sharedHistogram[localIndex];
+    if(localIndex == 0)
+    {
+        uvec2 blockStart = gl_WorkGroupID.xy*WORKGROUP_SIDE;
+        uvec2 blockSize = min(gridSize - blockStart, uvec2(WORKGROUP_SIDE));
+        partialStatistics[workgroupIndex].minimum = sharedMinimum[0];
+        partialStatistics[workgroupIndex].maximum = sharedMaximum[0];
+        partialStatistics[workgroupIndex].mean = sharedSum[0];
+        partialStatistics[workgroupIndex].histogramMinimum = histogramMinimum;
+        partialStatistics[workgroupIndex].histogramMaximum = histogramMaximum;
+        partialStatistics[workgroupIndex].sampleCount = blockSize.x*blockSize.y;
+    }
+}
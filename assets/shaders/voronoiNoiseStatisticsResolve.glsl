@@ -0,0 +1,124 @@
+#version 450
+
+// The second pass of the viewport statistics, with a single workgroup. Each
+// invocation sums a histogram bin over the partial statistics, and takes the
+// range and the sum of a partial one, which are then reduced in the shared
+// memory. The result is read back by the application a few frames later.
+#define WORKGROUP_SIZE 256
+#define WORKGROUP_SIDE 16
+#define HISTOGRAM_BIN_COUNT 256
+#define MAX_GRID_SIZE 256
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+layout(std140, set = 1, binding = 0) uniform ScreenAndUIStateBlock
+{
+    uvec2 screenSize;
+
+    bool flipVertically;
+    float screenScale;
+
+    vec2 screenOffset;
+
+    float startThreshold;
+    float endThreshold;
+
+    float amplitude;
+    float octaves;
+    float lacunarity;
+    float resolutionScale;
+
+    vec4 voronoiFactors;
+    vec4 startColor;
+    vec4 endColor;
+} ScreenAndUIState;
+
+struct NoiseStatistics
+{
+    float minimum;
+    float maximum;
+    float mean;
+    float histogramMinimum;
+    float histogramMaximum;
+    uint sampleCount;
+    uint reserved0;
+    uint reserved1;
+    uint histogram[HISTOGRAM_BIN_COUNT];
+};
+
+// The mean of the partial statistics holds the sum of the values instead.
+layout(std430, set = 1, binding = 8) readonly buffer NoiseStatisticsPartialBlock
+{
+    NoiseStatistics partialStatistics[];
+};
+
+layout(std430, set = 1, binding = 9) writeonly buffer NoiseStatisticsBlock
+{
+    NoiseStatistics statistics;
+};
+
+shared float sharedMinimum[WORKGROUP_SIZE];
+shared float sharedMaximum[WORKGROUP_SIZE];
+shared float sharedSum[WORKGROUP_SIZE];
+shared uint sharedSampleCount[WORKGROUP_SIZE];
+
+// Matches getVoronoiNoiseStatisticsSampleStep.
+uint getSampleStep()
+{
+    uint size = max(ScreenAndUIState.screenSize.x, ScreenAndUIState.screenSize.y);
+    return max((size + MAX_GRID_SIZE - 1) / MAX_GRID_SIZE, 1u);
+}
+
+uvec2 getGridSize()
+{
+    return max(ScreenAndUIState.screenSize / getSampleStep(), uvec2(1));
+}
+
+void main()
+{
+    // The same workgroup count as the dispatch of the first pass, which is
+    // at most WORKGROUP_SIZE.
+    uvec2 partialGridSize = (getGridSize() + WORKGROUP_SIDE - 1) / WORKGROUP_SIDE;
+    uint partialCount = partialGridSize.x*partialGridSize.y;
+    uint localIndex = gl_LocalInvocationIndex;
+
+    uint binCount = 0;
+    for(uint i = 0; i < partialCount; ++i)
+        binCount += partialStatistics[i].histogram[localIndex];
+    statistics.histogram[localIndex] = binCount;
+
+    sharedMinimum[localIndex] = 3.4e38;
+    sharedMaximum[localIndex] = -3.4e38;
+    sharedSum[localIndex] = 0.0;
+    sharedSampleCount[localIndex] = 0;
+    if(localIndex < partialCount)
+    {
+        sharedMinimum[localIndex] = partialStatistics[localIndex].minimum;
+        sharedMaximum[localIndex] = partialStatistics[localIndex].maximum;
+        sharedSum[localIndex] = partialStatistics[localIndex].mean;
+        sharedSampleCount[localIndex] = partialStatistics[localIndex].sampleCount;
+    }
+    barrier();
+
+    for(uint stride = WORKGROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if(localIndex < stride)
+        {
+            sharedMinimum[localIndex] = min(sharedMinimum[localIndex], sharedMinimum[localIndex + stride]);
+            sharedMaximum[localIndex] = max(sharedMaximum[localIndex], sharedMaximum[localIndex + stride]);
+            sharedSum[localIndex] += sharedSum[localIndex + stride];
+            sharedSampleCount[localIndex] += sharedSampleCount[localIndex + stride];
+        }
+        barrier();
+    }
+
+    if(localIndex == 0)
+    {
+        statistics.minimum = sharedMinimum[0];
+        statistics.maximum = sharedMaximum[0];
+        statistics.mean = sharedSum[0] / float(max(sharedSampleCount[0], 1u));
+        statistics.histogramMinimum = partialStatistics[0].histogramMinimum;
+        statistics.histogramMaximum = partialStatistics[0].histogramMaximum;
+        statistics.sampleCount = sharedSampleCount[0];
+    }
+}
@@ -0,0 +1,228 @@
+#version 450
+
+// A workgroup evaluates every sample of a configuration, so its statistics
+// are reduced in the shared memory without any global atomics.
+#define WORKGROUP_SIZE 256
+#define HISTOGRAM_BIN_COUNT 256
+
+layout(local_size_x = WORKGROUP_SIZE) in;
+
+// The layout of ScreenAndUIState.
+struct NoiseSweepConfiguration
+{
+    uvec2 screenSize;
+
+    uint flipVertically;
+    float screenScale;
+
+    vec2 screenOffset;
+
+    float startThreshold;
+    float endThreshold;
+
+    float amplitude;
+    float octaves;
+    float lacunarity;
+    float resolutionScale;
+
+    vec4 voronoiFactors;
+    vec4 startColor;
+    vec4 endColor;
+};
+
+layout(std430, set = 1, binding = 6) readonly buffer NoiseSweepConfigurationBlock
+{
+    uint configurationCount;
+    uint sampleWidth;
+    uint sampleHeight;
+    uint atlasColumns;
+    NoiseSweepConfiguration configurations[];
+};
+
+struct NoiseSweepStatistics
+{
+    float minimum;
+    float maximum;
+    float mean;
+    float histogramMinimum;
+    float histogramMaximum;
+    uint sampleCount;
+    uint reserved0;
+    uint reserved1;
+    uint histogram[HISTOGRAM_BIN_COUNT];
+};
+
+layout(std430, set = 1, binding = 7) writeonly buffer NoiseSweepStatisticsBlock
+{
+    NoiseSweepStatistics statistics[];
+};
+
+// The channels are stored swizzled, so that the texels hold B8G8R8A8 pixels.
+layout(rgba8, set = 1, binding = 3) uniform writeonly image2D sweepAtlas;
+
+shared float sharedMinimum[WORKGROUP_SIZE];
+shared float sharedMaximum[WORKGROUP_SIZE];
+shared float sharedSum[WORKGROUP_SIZE];
+shared uint sharedHistogram[HISTOGRAM_BIN_COUNT];
+
+/**
+ * Hash function from: https://nullprogram.com/blog/2018/07/31/ and https://github.com/skeeto/hash-prospector .
+ * Released by the original author on the public domain.
+ */
+int lowbias32(int x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+vec2 randomNoiseVector2(vec2 v)
+{
+    ivec2 f = ivec2(floor(v));
+    ivec2 fh = ivec2(lowbias32(f.x), lowbias32(f.y));
+    return vec2(
+        lowbias32(fh.x * 27901 + fh.y * 8537),
+        lowbias32(fh.x * 6581 + fh.y * 21881)
+    ) / 4294967295.0;
+}
+
+vec4 voronoiNoiseComponents(vec2 v)
+{
+    vec4 result = vec4(1.0e10);
+    vec2 startCell = floor(v);
+    vec2 f = v - startCell;
+    for(int y = -1; y <= 1; ++y)
+    {
+        for(int x = -1; x <= 1; ++x)
+        {
+            vec2 cellDelta = vec2(x, y);
+            vec2 cell = startCell + cellDelta;
+            vec2 point = randomNoiseVector2(cell);
+
+            vec2 delta = f - (point + cellDelta);
+            float dist2 = dot(delta, delta);
+            if(dist2 < result.x)
+                result = vec4(dist2, result.xyz);
+            else if(dist2 < result.y)
+                result = vec4(result.x, dist2, result.yz);
+            else if(dist2 < result.z)
+                result = vec4(result.xy, dist2, result.z);
+            else if(dist2 < result.w)
+                result = vec4(result.xyz, dist2);
+        }
+
+    }
+
+    return min(sqrt(result), vec4(1.0));
+}
+
+// Matches getVoronoiNoiseHistogramBin.
+uint getHistogramBin(float value, float minimum, float maximum)
+{
+    if(!(maximum > minimum))
+        return 0;
+
+    float bin = (value - minimum) / (maximum - minimum)*float(HISTOGRAM_BIN_COUNT);
+    if(!(bin > 0.0))
+        return 0;
+    return bin < float(HISTOGRAM_BIN_COUNT - 1) ? uint(bin) : HISTOGRAM_BIN_COUNT - 1;
+}
+
+void main()
+{
+    // The configurations beyond the dispatch width continue in the next rows of workgroups.
+    uint configurationIndex = gl_WorkGroupID.y*gl_NumWorkGroups.x + gl_WorkGroupID.x;
+    if(configurationIndex >= configurationCount)
+        return;
+
+    NoiseSweepConfiguration configuration = configurations[configurationIndex];
+    uint localIndex = gl_LocalInvocationIndex;
+    sharedHistogram[localIndex] = 0;
+    barrier();
+
+    // Each distance lies in [0, 1] before the amplitude is applied.
+    vec4 factors = configuration.voronoiFactors;
+    float negativeSum = dot(min(factors, vec4(0.0)), vec4(1.0))*configuration.amplitude;
+    float positiveSum = dot(max(factors, vec4(0.0)), vec4(1.0))*configuration.amplitude;
+    float histogramMinimum = min(negativeSum, positiveSum);
+    float histogramMaximum = max(negativeSum, positiveSum);
+
+    float screenAspect = float(sampleHeight) / float(sampleWidth);
+    ivec2 tileOrigin = ivec2(configurationIndex % max(atlasColumns, 1u), configurationIndex / max(atlasColumns, 1u))*ivec2(sampleWidth, sampleHeight);
+    int octaves = int(configuration.octaves);
+
+    float minimum = 3.4e38;
+    float maximum = -3.4e38;
+    float sum = 0.0;
+    uint sampleCount = sampleWidth*sampleHeight;
+    for(uint sampleIndex = localIndex; sampleIndex < sampleCount; sampleIndex += WORKGROUP_SIZE)
+    {
+        // The rows go from top to bottom, as in voronoiNoise.glsl without the vertical flip.
+        uvec2 samplePosition = uvec2(sampleIndex % sampleWidth, sampleIndex / sampleWidth);
+        vec2 screenCoord = (vec2(samplePosition) + 0.5) / vec2(sampleWidth, sampleHeight);
+        screenCoord.y = -screenCoord.y;
+        vec2 noiseCoordinate = (screenCoord - 0.5)*configuration.screenScale*vec2(1.0, screenAspect) - configuration.screenOffset;
+
+        float noiseGain = 1.0;
+        float totalGain = 0.0;
+        vec4 noiseComponents = vec4(0.0);
+        for(int i = 0; i < octaves; ++i)
+        {
+            noiseComponents += voronoiNoiseComponents(noiseCoordinate)*noiseGain;
+            totalGain += noiseGain;
+
+            noiseCoordinate *= configuration.lacunarity;
+            noiseGain /= configuration.lacunarity;
+        }
+
+        noiseComponents *= configuration.amplitude / totalGain;
+        float noiseValue = dot(noiseComponents, factors);
+
+        minimum = min(minimum, noiseValue);
+        maximum = max(maximum, noiseValue);
+        sum += noiseValue;
+        atomicAdd(sharedHistogram[getHistogramBin(noiseValue, histogramMinimum, histogramMaximum)], 1u);
+
+        if(atlasColumns > 0)
+        {
+            float alpha;
+            if (configuration.startThreshold <= configuration.endThreshold)
+                alpha = clamp((noiseValue - configuration.startThreshold) / (configuration.endThreshold - configuration.startThreshold), 0.0, 1.0);
+            else
+                alpha = clamp((noiseValue - configuration.endThreshold) / (configuration.startThreshold - configuration.endThreshold), 0.0, 1.0);
+
+            vec4 color = mix(configuration.startColor, configuration.endColor, alpha);
+            imageStore(sweepAtlas, tileOrigin + ivec2(samplePosition), color.bgra);
+        }
+    }
+
+    sharedMinimum[localIndex] = minimum;
+    sharedMaximum[localIndex] = maximum;
+    sharedSum[localIndex] = sum;
+    barrier();
+
+    for(uint stride = WORKGROUP_SIZE / 2; stride > 0; stride /= 2)
+    {
+        if(localIndex < stride)
+        {
+            sharedMinimum[localIndex] = min(sharedMinimum[localIndex], sharedMinimum[localIndex + stride]);
+            sharedMaximum[localIndex] = max(sharedMaximum[localIndex], sharedMaximum[localIndex + stride]);
+            sharedSum[localIndex] += sharedSum[localIndex + stride];
+        }
+        barrier();
+    }
+
+    statistics[configurationIndex].histogram[localIndex] = sharedHistogram[localIndex];
+    if(localIndex == 0)
+    {
+        statistics[configurationIndex].minimum = sharedMinimum[0];
+        statistics[configurationIndex].maximum = sharedMaximum[0];
+        statistics[configurationIndex].mean = sharedSum[0] / float(sampleCount);
+        statistics[configurationIndex].histogramMinimum = histogramMinimum;
+        statistics[configurationIndex].histogramMaximum = histogramMaximum;
+        statistics[configurationIndex].sampleCount = sampleCount;
+    }
+}